@@ -0,0 +1,79 @@
+// NonBlockingOperations example code for the PT7C4339-RTC library
+// This example demonstrates how to read the date and time and set alarm 1
+// without blocking the main loop: an operation is started, then poll() moves
+// it forward by one short I2C step per loop iteration, so a fast control loop
+// keeps its deadline.
+// More info on the GitHub page: https://github.com/depben/PT7C4339-RTC
+
+#include <Arduino.h>
+#include "PT7C4339-RTC.h"
+
+static const uint8_t SDA_PIN = SDA; // Set to the SDA pin of the microcontroller
+static const uint8_t SCL_PIN = SCL; // Set to the SCL pin of the microcontroller
+
+// Construct PT7C4339 object called rtc
+PT7C4339 rtc( &Wire, SDA_PIN, SCL_PIN );
+
+void setup()
+{
+
+    Serial.begin( 115200 );
+    delay( 200 );
+
+    // Initialize the RTC
+    rtc.begin();
+
+    // Start setting alarm 1 to 12:00:00 every day, it is written by poll() in the loop
+    PT7C4339_Alarm1Config alarm = { PT7C4339_A1_HOURS_MINUTES_SECONDS_MATCH, { 12, 0, 0 }, { 0, 0, 1, PT7C4339_WEEKDAY_UNKNOWN } };
+    if( !rtc.startSetAlarm1( alarm ) ) Serial.println( "Invalid alarm configuration!" );
+
+}
+
+void loop()
+{
+
+    // The control task of the application, it must run every 2 ms
+    static uint32_t lastControl = 0;
+    if( micros() - lastControl >= 2000 )
+    {
+
+        lastControl = micros();
+        // ... control task ...
+
+    }
+
+    // Advance the RTC operation in progress by at most one short I2C step
+    PT7C4339_asyncStatus status = rtc.poll();
+
+    if( status == PT7C4339_ASYNC_DONE || status == PT7C4339_ASYNC_IDLE )
+    {
+
+        if( status == PT7C4339_ASYNC_DONE && rtc.getAsyncOperation() == PT7C4339_ASYNC_READ_DATE_TIME )
+        {
+
+            PT7C4339_DateTime now = rtc.getAsyncDateTime();
+            Serial.printf( "%04d/%02d/%02d %02d:%02d:%02d\n", now.date.year, now.date.month, now.date.day,
+                           now.time.hour, now.time.minute, now.time.second );
+
+        }
+
+        // Start the next read once a second
+        static uint32_t lastRead = 0;
+        if( millis() - lastRead >= 1000 )
+        {
+
+            lastRead = millis();
+            rtc.startReadDateTime();
+
+        }
+
+    }
+    else if( status != PT7C4339_ASYNC_BUSY )
+    {
+
+        Serial.printf( "RTC operation %d failed with status %d\n", rtc.getAsyncOperation(), status );
+        rtc.startReadDateTime(); // Try again
+
+    }
+
+}
@@ -2,6 +2,7 @@
 // This example demonstrates how to configure the RTC on power up,
 // configure the trickle charger, and use the square wave output to 
 // trigger an interupt once every second.
+// The configuration is saved after the first setup, and restored with a single burst on every later stop flag.
 // More info on the GitHub page: https://github.com/depben/PT7C4339-RTC
 
 #include <Arduino.h>
@@ -15,6 +16,10 @@ static const uint8_t RTC_INT = 21; // Set to the pin on the microcontroller that
 uint16_t dateTimePrintedCount = 0; // Variable to count the number of times the date and time were printed since the last reset
 volatile bool interruptTriggered = false; // Variable that the ISR uses to signal the main loop
 
+// Saved configuration of the RTC, 11 bytes of plain data that could also be kept in EEPROM or flash (e.g. EEPROM.put( 0, savedConfig ))
+PT7C4339_Config savedConfig;
+bool configSaved = false;
+
 // Construct PT7C4339 object called rtc
 PT7C4339 rtc( &Wire, SDA_PIN, SCL_PIN );
 
@@ -66,47 +71,75 @@ void loop()
         Serial.printf( "\nRTC Stop Flag found set - Stored time may be inaccurate!\n" );
         Serial.println( "Clearing Stop Flag and restoring configuration..." );
 
-        bool reset = rtc.reset(); // calling reset() after Stop Flag was set is recommended, but not needed.
-        bool clear = rtc.clearRtcStopFlag(); // Clear Stop Flag
-        bool begin = rtc.begin(); // Reinitialize the RTC
+        bool configured;
 
-        if( !( reset && clear && begin ) ) Serial.println( "Failed to reset the RTC!" );
-        else
+        if( configSaved )
         {
 
-            Serial.println( "Successfully reset the RTC." );
-            Serial.println( "Configuring RTC..." );
+            // Restore the saved configuration: one read, and one write of only the registers that changed
+            bool apply = rtc.applyConfig( savedConfig ); // Also restarts the oscillator
+            bool clear = rtc.clearRtcStopFlag(); // Clear Stop Flag
+
+            configured = apply && clear;
+            if( !configured ) Serial.println( "Failed to restore the RTC configuration!" );
 
-            bool batteryInt = rtc.enableIntFromBattery( false ); // Disable interrupt/square vawe from battery
-            bool sqw = rtc.setIntOrSqwFlag( false ); // Set to square wave mode
-            bool sqwFreq = rtc.setSqwFrequency( PT7C4339_SQW_1HZ ); // Set square wave frequency to 1Hz
-            bool trickle = rtc.setTrickleChargerConfig( PT7C4339_TRICKLE_ENABLE, PT7C4339_DIODE_DISABLE, PT7C4339_RESISTOR_2K ); // Enable trickle charger with 2K Ohm resistor and no diode
-            // More info on the trickle charger can be found on pages  of the datasheet: https://www.diodes.com/datasheet/download/PT7C4339_4339C.pdf
+        }
+        else
+        {
 
-            if( !( batteryInt && sqw && sqwFreq && trickle ) ) Serial.println( "Failed to configure the RTC!" );
+            bool reset = rtc.reset(); // calling reset() after Stop Flag was set is recommended, but not needed.
+            bool clear = rtc.clearRtcStopFlag(); // Clear Stop Flag
+            bool begin = rtc.begin(); // Reinitialize the RTC
+
+            configured = reset && clear && begin;
+            if( !configured ) Serial.println( "Failed to reset the RTC!" );
             else
             {
-            
-                Serial.println( "RTC configured successfully." );
-                Serial.println( "Setting time and date..." );
 
-                bool date = rtc.setDate( { 2025, 5, 23, PT7C4339_WEEKDAY_UNKNOWN } );
-                bool time = rtc.setTime( { 23, 59, 45 } );
+                Serial.println( "Successfully reset the RTC." );
+                Serial.println( "Configuring RTC..." );
+
+                bool batteryInt = rtc.enableIntFromBattery( false ); // Disable interrupt/square vawe from battery
+                bool sqw = rtc.setIntOrSqwFlag( false ); // Set to square wave mode
+                bool sqwFreq = rtc.setSqwFrequency( PT7C4339_SQW_1HZ ); // Set square wave frequency to 1Hz
+                bool trickle = rtc.setTrickleChargerConfig( PT7C4339_TRICKLE_ENABLE, PT7C4339_DIODE_DISABLE, PT7C4339_RESISTOR_2K ); // Enable trickle charger with 2K Ohm resistor and no diode
+                // More info on the trickle charger can be found on pages  of the datasheet: https://www.diodes.com/datasheet/download/PT7C4339_4339C.pdf
 
-                if( !( date && time ) ) Serial.println( "Failed to set the time and date!" );
+                configured = batteryInt && sqw && sqwFreq && trickle;
+                if( !configured ) Serial.println( "Failed to configure the RTC!" );
                 else
                 {
-                
-                    Serial.println( "Time and date set successfully." );
 
-                    Serial.printf( "Date and time set to: ");
-                    printDateTime();
-                    Serial.println( "" );
+                    savedConfig = rtc.saveConfig(); // Save the configuration for the next stop flag
+                    configSaved = true;
 
                 }
 
             }
-        
+
+        }
+
+        if( configured )
+        {
+
+            Serial.println( "RTC configured successfully." );
+            Serial.println( "Setting time and date..." );
+
+            bool date = rtc.setDate( { 2025, 5, 23, PT7C4339_WEEKDAY_UNKNOWN } );
+            bool time = rtc.setTime( { 23, 59, 45 } );
+
+            if( !( date && time ) ) Serial.println( "Failed to set the time and date!" );
+            else
+            {
+
+                Serial.println( "Time and date set successfully." );
+
+                Serial.printf( "Date and time set to: ");
+                printDateTime();
+                Serial.println( "" );
+
+            }
+
         }
 
     }
@@ -0,0 +1,73 @@
+// SoftClockTimestamps example code for the PT7C4339-RTC library
+// This example demonstrates how to run the software clock of the library,
+// which counts the 1Hz square wave edges of the RTC and interpolates between
+// them with micros(), to get timestamps with microsecond resolution without
+// any I2C traffic.
+// More info on the GitHub page: https://github.com/depben/PT7C4339-RTC
+
+#include <Arduino.h>
+#include "PT7C4339-RTC.h"
+
+static const uint8_t SDA_PIN = SDA; // Set to the SDA pin of the microcontroller
+static const uint8_t SCL_PIN = SCL; // Set to the SCL pin of the microcontroller
+static const uint8_t RTC_INT = 21; // Set to the pin on the microcontroller that is connected to the INT/SQW pin of the PT7C4339 IC
+
+// Construct PT7C4339 object called rtc
+PT7C4339 rtc( &Wire, SDA_PIN, SCL_PIN );
+
+// ISR for the esp32 platform
+void IRAM_ATTR isrOnFallingEdge()
+{
+
+    rtc.handleSqwEdge(); // Count the edge and latch micros()
+
+}
+
+// ISR for the arduino platform - if running on arduino hardware, uncomment this and comment out the one for esp32
+/*
+void isrOnFallingEdge()
+{
+
+    rtc.handleSqwEdge(); // Count the edge and latch micros()
+
+}
+*/
+
+void setup()
+{
+
+    Serial.begin( 115200 );
+    delay( 200 );
+
+    // Initialize the RTC
+    rtc.begin();
+
+    pinMode( RTC_INT, INPUT_PULLUP ); // Set square vave input pin to input with pullup resistor
+
+    attachInterrupt( RTC_INT, isrOnFallingEdge, FALLING ); // for the esp32 platform
+    // attachInterrupt( digitalPinToInterrupt( RTC_INT ), isrOnFallingEdge, FALLING ); // for the arduino platform - if running on arduino hardware, uncomment this and comment out the one for esp32
+
+    // Switch INT/SQW to a 1Hz square wave and start the software clock, reading the RTC again every 10 minutes
+    if( !rtc.beginSoftClock( 600 ) ) Serial.println( "Failed to start the software clock!" );
+
+}
+
+void loop()
+{
+
+    // Reads the RTC once after the first edge, then on the resync cadence - no I2C traffic otherwise
+    rtc.serviceSoftClock();
+
+    static uint32_t last = 0;
+    if( rtc.isSoftClockSynced() && millis() - last >= 250 )
+    {
+
+        last = millis();
+
+        PT7C4339_Timestamp now = rtc.now(); // No I2C traffic
+        Serial.printf( "%04d/%02d/%02d %02d:%02d:%02d.%06lu\n", now.dateTime.date.year, now.dateTime.date.month, now.dateTime.date.day,
+                       now.dateTime.time.hour, now.dateTime.time.minute, now.dateTime.time.second, ( unsigned long )now.microsecond );
+
+    }
+
+}
@@ -0,0 +1,471 @@
+/**
+ * @file PT7C4339-Benchmark.cpp
+ * @brief Host-side benchmark of the bus cost and CPU time of every public method of the PT7C4339-RTC library.
+ *
+ * Every public method is run against the PT7C4339 simulator at 100kHz, 400kHz and 1MHz bus clocks,
+ * once with the default configuration and once with the register cache enabled. For each run, the I2C transactions,
+ * bytes on the wire and modelled wire time per call are taken from the simulated bus, and the host CPU time
+ * per call is measured around the call itself. The results are written as JSON, to stdout or to a file.
+ *
+ * Build and run from the root of the repository:
+ *
+ *   g++ -std=gnu++11 -O2 -Iextras/simulator -Isrc extras/benchmark/PT7C4339-Benchmark.cpp src/PT7C4339-RTC.cpp src/PT7C4339-WireBus.cpp \
+ *       extras/simulator/Arduino.cpp extras/simulator/Wire.cpp extras/simulator/PT7C4339-Simulator.cpp \
+ *       extras/simulator/PT7C4339-SimMux.cpp -o pt7c4339-benchmark
+ *   ./pt7c4339-benchmark [-n iterations] [-o results.json]
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "PT7C4339-RTC.h"
+#include "PT7C4339-AlarmScheduler.h"
+#include "PT7C4339-CronSchedule.h"
+#include "PT7C4339-DriftEstimator.h"
+#include "PT7C4339-EventCapture.h"
+#include "PT7C4339-Simulator.h"
+#include "PT7C4339-SimMux.h"
+
+#define BENCHMARK_DEFAULT_ITERATIONS 100 ///< Number of calls measured per method, clock and configuration by default
+#define BENCHMARK_FLEET_SIZE         8 ///< Number of RTCs behind the multiplexer of the fleet cases, one per channel
+
+/**
+ * @brief One benchmarked call, with an optional unmeasured preparation step run before every call.
+ */
+typedef struct
+{
+  const char *name; ///< Name of the benchmark, the public method or scenario measured
+  void ( *prepare )(); ///< Puts the RTC object into the state the call needs, not measured, may be nullptr
+  void ( *run )(); ///< The measured call
+} BenchmarkCase;
+
+/**
+ * @brief One configuration of the RTC object the cases are run with.
+ */
+typedef struct
+{
+  const char *name; ///< Name of the configuration in the results
+  bool registerCache; ///< Register cache enabled
+} BenchmarkConfig;
+
+static PT7C4339Simulator *sim;
+static PT7C4339 *rtc;
+
+static PT7C4339SimMux *simMux;
+static PT7C4339_Mux fleetMux( &Wire );
+static PT7C4339 *fleet[BENCHMARK_FLEET_SIZE];
+static PT7C4339_DateTime fleetDateTimes[BENCHMARK_FLEET_SIZE];
+
+static const PT7C4339_Time sampleTime = { 12, 34, 56 };
+static const PT7C4339_Date sampleDate = { 2024, 2, 29, PT7C4339_WEEKDAY_UNKNOWN };
+static const PT7C4339_DateTime sampleDateTime = { sampleDate, sampleTime };
+static const PT7C4339_Alarm1Config sampleAlarm1 = { PT7C4339_A1_HOURS_MINUTES_SECONDS_MATCH, sampleTime, sampleDate };
+static const PT7C4339_Alarm2Config sampleAlarm2 = { PT7C4339_A2_HOURS_MINUTES_MATCH, sampleTime, sampleDate };
+static const uint8_t sampleAlarm2Registers[3] = { 0x34, 0x12, 0x80 };
+
+static PT7C4339_Config sampleConfig;
+static PT7C4339_ResumeState resumeState;
+
+static PT7C4339_AlarmScheduler<16> scheduler( nullptr );
+static PT7C4339_DriftEstimator<> drift( nullptr );
+static PT7C4339_EventCapture<64> events( nullptr );
+static PT7C4339_Event resolvedEvents[64];
+static PT7C4339_CronSchedule workHours;
+static PT7C4339_CronAlarm<> cron( nullptr );
+
+/**
+ * @brief Scheduled alarm callback that does nothing.
+ */
+static void ignoreScheduledAlarm( uint8_t )
+{
+}
+
+/**
+ * @brief Fills the scheduler with 16 alarms, due every 10 seconds from 10 seconds after the simulated time.
+ */
+static void fillScheduler()
+{
+  scheduler = PT7C4339_AlarmScheduler<16>( rtc );
+
+  uint32_t start = PT7C4339_dateTimeToEpoch( sampleDateTime );
+  for( uint8_t i = 0; i < 16; i++ ) scheduler.add( PT7C4339_epochToDateTime( start + 10 + 10UL * i ), i % 2 ? 600 : 0, ignoreScheduledAlarm );
+}
+
+/**
+ * @brief Puts the simulated time back to the sample date and time (a Thursday) and parses a schedule of every quarter hour in working hours.
+ */
+static void prepareCron()
+{
+  sim->setDateTime( 2024, 2, 29, 12, 34, 56 );
+  sim->setRegister( PT7C4339_REG_DAYS_OF_WEEK, PT7C4339_THURSDAY );
+
+  workHours = PT7C4339_cronParse( "*/15 8-17 * * 1-5" );
+  cron = PT7C4339_CronAlarm<>( rtc );
+}
+
+/**
+ * @brief Arms the cron alarm and services one fire, so the next re-arm changes only the minutes.
+ */
+static void armCron()
+{
+  prepareCron();
+  cron.begin( workHours );
+  cron.service();
+}
+
+/**
+ * @brief Puts the simulated time back to the sample date and time, with a drift model 1.6 seconds behind it, so step() moves the RTC by one second.
+ */
+static void prepareDrift()
+{
+  sim->setDateTime( 2024, 2, 29, 12, 34, 56 );
+
+  drift = PT7C4339_DriftEstimator<>( rtc );
+  drift.setModel( { 20000, PT7C4339_dateTimeToEpoch( sampleDateTime ), 1600 } );
+}
+
+/**
+ * @brief Captures 64 events, 50us apart.
+ */
+static void captureEvents()
+{
+  events = PT7C4339_EventCapture<64>( rtc );
+
+  for( uint8_t i = 0; i < 64; i++ )
+  {
+    events.capture( i );
+    delayMicroseconds( 50 );
+  }
+}
+
+/**
+ * @brief Makes the device hold SDA low until the bus recovery clocks SCL 5 times, and allows one retry.
+ */
+static void holdBus()
+{
+  rtc->setRetryBudget( 1 );
+  sim->holdSda( true );
+  sim->releaseSdaAfterClocks( 5, SCL );
+}
+
+/**
+ * @brief Configures both alarms, the square wave and the trickle charger, saves the configuration, then resets the device to its defaults.
+ */
+static void prepareConfig()
+{
+  rtc->setAlarm1( sampleAlarm1 );
+  rtc->setAlarm2( sampleAlarm2 );
+  rtc->setSqwFrequency( PT7C4339_SQW_8_192KHZ );
+  rtc->setTrickleChargerConfig( PT7C4339_TRICKLE_ENABLE, PT7C4339_DIODE_DISABLE, PT7C4339_RESISTOR_2K );
+
+  sampleConfig = rtc->saveConfig();
+  rtc->reset();
+}
+
+/**
+ * @brief Polls the non-blocking operation in progress to its end, with 100us of other work between two steps.
+ */
+static void finishAsync()
+{
+  while( rtc->poll() == PT7C4339_ASYNC_BUSY ) delayMicroseconds( 100 );
+}
+
+/**
+ * @brief Alarm callback that does nothing, so service() clears the flags.
+ */
+static void ignoreAlarm()
+{
+}
+
+/**
+ * @brief Sets both alarm flags on the device and registers callbacks for them.
+ */
+static void raiseAlarms()
+{
+  rtc->onAlarm1( ignoreAlarm );
+  rtc->onAlarm2( ignoreAlarm );
+  sim->setRegister( PT7C4339_REG_STATUS, 0x03 );
+  rtc->notifyInterrupt();
+}
+
+static const BenchmarkCase cases[] =
+{
+  { "begin", nullptr, []{ rtc->begin(); } },
+  { "reset", nullptr, []{ rtc->reset(); } },
+  { "getResumeState", nullptr, []{ resumeState = rtc->getResumeState(); } },
+  { "resume", []{ resumeState = rtc->getResumeState(); }, []{ rtc->resume( resumeState ); } },
+
+  { "isRegisterCacheEnabled", nullptr, []{ rtc->isRegisterCacheEnabled(); } },
+  { "enableRegisterCache", nullptr, []{ rtc->enableRegisterCache( rtc->isRegisterCacheEnabled() ); } },
+  { "refreshRegisterCache", nullptr, []{ rtc->refreshRegisterCache(); } },
+
+  { "getVerifyPolicy", nullptr, []{ rtc->getVerifyPolicy(); } },
+  { "setVerifyPolicy", nullptr, []{ rtc->setVerifyPolicy( rtc->getVerifyPolicy() ); } },
+  { "verifyPendingWrites",
+    []{ rtc->setVerifyPolicy( PT7C4339_VERIFY_DEFERRED ); rtc->setA1Time( sampleTime ); rtc->setA2Time( sampleTime ); rtc->setVerifyPolicy( PT7C4339_VERIFY_ALWAYS ); },
+    []{ rtc->verifyPendingWrites(); } },
+
+  { "beginUpdate", []{ rtc->cancelUpdate(); }, []{ rtc->beginUpdate(); } },
+  { "commit",
+    []{ rtc->beginUpdate(); rtc->setA1Time( sampleTime ); rtc->setA1Rate( PT7C4339_A1_HOURS_MINUTES_SECONDS_MATCH ); rtc->enableA1Int( true ); },
+    []{ rtc->commit(); } },
+  { "cancelUpdate", []{ rtc->beginUpdate(); rtc->setA1Time( sampleTime ); }, []{ rtc->cancelUpdate(); } },
+  { "alarm1Reconfiguration",
+    nullptr,
+    []{ rtc->setA1Time( sampleTime ); rtc->setA1Rate( PT7C4339_A1_HOURS_MINUTES_SECONDS_MATCH ); rtc->clearA1Flag(); rtc->enableA1Int( true ); } },
+  { "alarm1ReconfigurationInUpdate",
+    nullptr,
+    []{ rtc->beginUpdate(); rtc->setA1Time( sampleTime ); rtc->setA1Rate( PT7C4339_A1_HOURS_MINUTES_SECONDS_MATCH ); rtc->clearA1Flag(); rtc->enableA1Int( true ); rtc->commit(); } },
+  { "saveConfig", nullptr, []{ rtc->saveConfig(); } },
+  { "applyConfig", prepareConfig, []{ rtc->applyConfig( sampleConfig ); } },
+
+  { "getDateTime", nullptr, []{ rtc->getDateTime(); } },
+  { "setDateTime", nullptr, []{ rtc->setDateTime( sampleDateTime ); } },
+  { "getEpoch", nullptr, []{ rtc->getEpoch(); } },
+  { "setEpoch", nullptr, []{ rtc->setEpoch( 1709209496UL ); } },
+  { "getTime", nullptr, []{ rtc->getTime(); } },
+  { "setTime", nullptr, []{ rtc->setTime( sampleTime ); } },
+  { "getDate", nullptr, []{ rtc->getDate(); } },
+  { "setDate", nullptr, []{ rtc->setDate( sampleDate ); } },
+  { "getSecond", nullptr, []{ rtc->getSecond(); } },
+  { "setSecond", nullptr, []{ rtc->setSecond( 56 ); } },
+  { "getMinute", nullptr, []{ rtc->getMinute(); } },
+  { "setMinute", nullptr, []{ rtc->setMinute( 34 ); } },
+  { "getHour", nullptr, []{ rtc->getHour(); } },
+  { "setHour", nullptr, []{ rtc->setHour( 12 ); } },
+  { "getYear", nullptr, []{ rtc->getYear(); } },
+  { "setYear", nullptr, []{ rtc->setYear( 2024 ); } },
+  { "getMonth", nullptr, []{ rtc->getMonth(); } },
+  { "setMonth", nullptr, []{ rtc->setMonth( 2 ); } },
+  { "getDay", nullptr, []{ rtc->getDay(); } },
+  { "setDay", nullptr, []{ rtc->setDay( 29 ); } },
+  { "getWeekDay", nullptr, []{ rtc->getWeekDay(); } },
+  { "setCorrectWeekDay", nullptr, []{ rtc->setCorrectWeekDay(); } },
+  { "calculateWeekDay", nullptr, []{ rtc->calculateWeekDay( 2024, 2, 29 ); } },
+
+  { "beginSoftClock", nullptr, []{ rtc->beginSoftClock(); } },
+  { "endSoftClock", nullptr, []{ rtc->endSoftClock(); } },
+  { "handleSqwEdge", nullptr, []{ rtc->handleSqwEdge(); } },
+  { "serviceSoftClock", []{ rtc->beginSoftClock(); rtc->handleSqwEdge(); delay( 100 ); }, []{ rtc->serviceSoftClock(); } },
+  { "isSoftClockSynced", nullptr, []{ rtc->isSoftClockSynced(); } },
+  { "now", []{ rtc->beginSoftClock(); rtc->handleSqwEdge(); delay( 100 ); rtc->serviceSoftClock(); rtc->handleSqwEdge(); }, []{ rtc->now(); } },
+
+  { "startReadDateTime", finishAsync, []{ rtc->startReadDateTime(); } },
+  { "readDateTimeAsync", nullptr, []{ rtc->startReadDateTime(); finishAsync(); } },
+  { "setAlarm1Async", nullptr, []{ rtc->startSetAlarm1( sampleAlarm1 ); finishAsync(); } },
+  { "resetAsync", nullptr, []{ rtc->startReset(); finishAsync(); } },
+
+  { "isOscillatorEnabled", nullptr, []{ rtc->isOscillatorEnabled(); } },
+  { "enableOscillator", nullptr, []{ rtc->enableOscillator( true ); } },
+  { "getRtcStopFlag", nullptr, []{ rtc->getRtcStopFlag(); } },
+  { "clearRtcStopFlag", nullptr, []{ rtc->clearRtcStopFlag(); } },
+  { "isIntFromBatteryEnabled", nullptr, []{ rtc->isIntFromBatteryEnabled(); } },
+  { "enableIntFromBattery", nullptr, []{ rtc->enableIntFromBattery( false ); } },
+  { "getIntOrSqwFlag", nullptr, []{ rtc->getIntOrSqwFlag(); } },
+  { "setIntOrSqwFlag", nullptr, []{ rtc->setIntOrSqwFlag( true ); } },
+  { "getSqwFrequency", nullptr, []{ rtc->getSqwFrequency(); } },
+  { "setSqwFrequency", nullptr, []{ rtc->setSqwFrequency( PT7C4339_SQW_1HZ ); } },
+  { "getTrickleChargerEnabled", nullptr, []{ rtc->getTrickleChargerEnabled(); } },
+  { "getTrickleChargerDiode", nullptr, []{ rtc->getTrickleChargerDiode(); } },
+  { "getTrickleChargerResistor", nullptr, []{ rtc->getTrickleChargerResistor(); } },
+  { "setTrickleChargerConfig", nullptr, []{ rtc->setTrickleChargerConfig( PT7C4339_TRICKLE_ENABLE, PT7C4339_DIODE_ENABLE, PT7C4339_RESISTOR_2K ); } },
+
+  { "getAlarm1", nullptr, []{ rtc->getAlarm1(); } },
+  { "setAlarm1", nullptr, []{ rtc->setAlarm1( sampleAlarm1 ); } },
+  { "isA1IntEnabled", nullptr, []{ rtc->isA1IntEnabled(); } },
+  { "enableA1Int", nullptr, []{ rtc->enableA1Int( true ); } },
+  { "getA1Flag", nullptr, []{ rtc->getA1Flag(); } },
+  { "clearA1Flag", nullptr, []{ rtc->clearA1Flag(); } },
+  { "getA1Rate", nullptr, []{ rtc->getA1Rate(); } },
+  { "setA1Rate", nullptr, []{ rtc->setA1Rate( PT7C4339_A1_HOURS_MINUTES_SECONDS_MATCH ); } },
+  { "getA1Time", nullptr, []{ rtc->getA1Time(); } },
+  { "setA1Time", nullptr, []{ rtc->setA1Time( sampleTime ); } },
+  { "getA1DayDate", nullptr, []{ rtc->getA1DayDate(); } },
+  { "setA1DayDate", nullptr, []{ rtc->setA1DayDate( sampleDate ); } },
+
+  { "getAlarm2", nullptr, []{ rtc->getAlarm2(); } },
+  { "setAlarm2", nullptr, []{ rtc->setAlarm2( sampleAlarm2 ); } },
+  { "isA2IntEnabled", nullptr, []{ rtc->isA2IntEnabled(); } },
+  { "enableA2Int", nullptr, []{ rtc->enableA2Int( true ); } },
+  { "getA2Flag", nullptr, []{ rtc->getA2Flag(); } },
+  { "clearA2Flag", nullptr, []{ rtc->clearA2Flag(); } },
+  { "getA2Rate", nullptr, []{ rtc->getA2Rate(); } },
+  { "setA2Rate", nullptr, []{ rtc->setA2Rate( PT7C4339_A2_HOURS_MINUTES_MATCH ); } },
+  { "getA2Time", nullptr, []{ rtc->getA2Time(); } },
+  { "setA2Time", nullptr, []{ rtc->setA2Time( sampleTime ); } },
+  { "getA2DayDate", nullptr, []{ rtc->getA2DayDate(); } },
+  { "setA2DayDate", nullptr, []{ rtc->setA2DayDate( sampleDate ); } },
+  { "setAlarmRegisters", nullptr, []{ rtc->setAlarmRegisters( PT7C4339_REG_A2_MINUTES, sampleAlarm2Registers, 3 ); } },
+
+  { "onAlarm1", nullptr, []{ rtc->onAlarm1( ignoreAlarm ); } },
+  { "onAlarm2", nullptr, []{ rtc->onAlarm2( ignoreAlarm ); } },
+  { "notifyInterrupt", nullptr, []{ rtc->notifyInterrupt(); } },
+  { "service", raiseAlarms, []{ rtc->service(); } },
+  { "schedulerArm", fillScheduler, []{ scheduler.service(); } },
+  { "schedulerReArm",
+    []{ sim->setDateTime( 2024, 2, 29, 12, 34, 56 ); fillScheduler(); scheduler.service(); sim->advanceSeconds( 10 ); },
+    []{ scheduler.service(); } },
+  { "cronBegin", prepareCron, []{ cron.begin( workHours ); } },
+  { "cronService", armCron, []{ cron.service(); } },
+  { "driftGetEpoch", prepareDrift, []{ drift.getEpoch(); } },
+  { "driftStep", prepareDrift, []{ drift.step(); } },
+  { "eventResolve", captureEvents, []{ events.resolve( resolvedEvents, 64 ); } },
+  { "readDateTimes", nullptr, []{ PT7C4339::readDateTimes( fleet, BENCHMARK_FLEET_SIZE, fleetDateTimes ); } },
+  { "getDateTimeMuxSelected", []{ fleet[0]->getDateTime(); }, []{ fleet[0]->getDateTime(); } },
+  { "getDateTimeBusRecovery", holdBus, []{ rtc->getDateTime(); } },
+  { "alarmFlagsPolled", raiseAlarms, []{ if( rtc->getA1Flag() ) rtc->clearA1Flag(); if( rtc->getA2Flag() ) rtc->clearA2Flag(); } },
+};
+
+static const BenchmarkConfig configs[] =
+{
+  { "default", false },
+  { "registerCache", true },
+};
+
+static const uint32_t clocks[] = { 100000, 400000, 1000000 };
+
+/**
+ * @brief Returns the CPU time used by the process, in nanoseconds.
+ */
+static uint64_t cpuTimeNs()
+{
+  struct timespec ts;
+  clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &ts );
+
+  return static_cast<uint64_t>( ts.tv_sec ) * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * @brief Measures one case at one bus clock in one configuration, and prints its JSON result object.
+ *
+ * The simulated devices are put back into the same state before every case, so the results do not depend on the order of the cases.
+ */
+static bool runCase( FILE *out, const BenchmarkCase &benchmark, const BenchmarkConfig &config, uint32_t clock, uint32_t iterations )
+{
+  sim->powerOn();
+  sim->setDateTime( 2024, 2, 29, 12, 34, 56 );
+  sim->setRegister( PT7C4339_REG_STATUS, 0x00 );
+  simMux->setControl( 0x00 );
+  fleetMux.invalidate();
+
+  PT7C4339 device( &Wire, 0, 0, clock );
+  rtc = &device;
+
+  Wire.end();
+  if( rtc->begin() == 0 ) return false;
+  Wire.setClock( clock );
+  if( config.registerCache && !rtc->enableRegisterCache( true ) ) return false;
+
+  uint32_t transactions = 0;
+  uint32_t bytes = 0;
+  uint64_t wireTimeNs = 0;
+  uint64_t cpuNs = 0;
+
+  for( uint32_t i = 0; i < iterations; i++ )
+  {
+    if( benchmark.prepare != nullptr ) benchmark.prepare();
+
+    PT7C4339SimBusStats before = Wire.getStats();
+    uint64_t start = cpuTimeNs();
+
+    benchmark.run();
+
+    cpuNs += cpuTimeNs() - start;
+    PT7C4339SimBusStats after = Wire.getStats();
+
+    transactions += after.transactions - before.transactions;
+    bytes += after.bytes - before.bytes;
+    wireTimeNs += after.wireTimeNs - before.wireTimeNs;
+  }
+
+  fprintf( out, "    { \"method\": \"%s\", \"config\": \"%s\", \"clockHz\": %u, \"transactions\": %.2f, \"bytes\": %.2f, \"wireTimeUs\": %.2f, \"cpuTimeNs\": %.0f }",
+           benchmark.name, config.name, static_cast<unsigned>( clock ),
+           static_cast<double>( transactions ) / iterations,
+           static_cast<double>( bytes ) / iterations,
+           static_cast<double>( wireTimeNs ) / iterations / 1000.0,
+           static_cast<double>( cpuNs ) / iterations );
+
+  rtc = nullptr;
+  return true;
+}
+
+int main( int argc, char **argv )
+{
+  uint32_t iterations = BENCHMARK_DEFAULT_ITERATIONS;
+  const char *outputPath = nullptr;
+
+  for( int i = 1; i < argc; i++ )
+  {
+    if( strcmp( argv[i], "-n" ) == 0 && i + 1 < argc ) iterations = strtoul( argv[++i], nullptr, 10 );
+    else if( strcmp( argv[i], "-o" ) == 0 && i + 1 < argc ) outputPath = argv[++i];
+    else
+    {
+      fprintf( stderr, "usage: %s [-n iterations] [-o results.json]\n", argv[0] );
+      return 2;
+    }
+  }
+
+  if( iterations == 0 ) iterations = 1;
+
+  FILE *out = stdout;
+  if( outputPath != nullptr )
+  {
+    out = fopen( outputPath, "w" );
+    if( out == nullptr )
+    {
+      perror( outputPath );
+      return 1;
+    }
+  }
+
+  PT7C4339Simulator device;
+  sim = &device;
+
+  PT7C4339SimMux mux;
+  PT7C4339Simulator fleetDevices[BENCHMARK_FLEET_SIZE];
+  PT7C4339 fleetRtcs[BENCHMARK_FLEET_SIZE];
+  simMux = &mux;
+
+  for( uint8_t i = 0; i < BENCHMARK_FLEET_SIZE; i++ )
+  {
+    mux.connect( i, &fleetDevices[i] );
+    fleetRtcs[i].setMux( &fleetMux, i );
+    fleet[i] = &fleetRtcs[i];
+  }
+
+  fprintf( out, "{\n  \"library\": \"PT7C4339-RTC\",\n  \"iterations\": %u,\n  \"results\":\n  [\n", static_cast<unsigned>( iterations ) );
+
+  bool ok = true;
+  bool first = true;
+  for( const BenchmarkConfig &config : configs )
+  {
+    for( uint32_t clock : clocks )
+    {
+      for( const BenchmarkCase &benchmark : cases )
+      {
+        if( !first ) fprintf( out, ",\n" );
+        first = false;
+
+        if( !runCase( out, benchmark, config, clock, iterations ) )
+        {
+          fprintf( out, "    { \"method\": \"%s\", \"config\": \"%s\", \"clockHz\": %u, \"error\": \"setup failed\" }",
+                   benchmark.name, config.name, static_cast<unsigned>( clock ) );
+          fprintf( stderr, "%s: setup failed (%s, %u Hz)\n", benchmark.name, config.name, static_cast<unsigned>( clock ) );
+          ok = false;
+        }
+      }
+    }
+  }
+
+  fprintf( out, "\n  ]\n}\n" );
+
+  if( out != stdout ) fclose( out );
+
+  return ok ? 0 : 1;
+}
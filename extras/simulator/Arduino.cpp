@@ -0,0 +1,253 @@
+/**
+ * @file Arduino.cpp
+ * @brief Virtual clock, pin and interrupt implementation of the host-side Arduino stand-in.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#include "Arduino.h"
+
+static uint64_t simNow = 0;
+static PT7C4339SimClockListener *simListeners = nullptr;
+
+struct SimPin
+{
+  uint8_t mode;
+  uint8_t mcuLevel;
+  uint8_t deviceLevel;
+  uint8_t lastLevel;
+  void ( *isr )();
+  int isrMode;
+  bool pending;
+};
+
+static SimPin simPins[PT7C4339_SIM_PIN_COUNT];
+static bool simPinsInitialized = false;
+static PT7C4339SimPins::WriteHook simWriteHook = nullptr;
+static void *simWriteHookContext = nullptr;
+static uint8_t simInterruptsDisabled = 0;
+
+static void initPins()
+{
+  if( simPinsInitialized ) return;
+
+  for( uint8_t i = 0; i < PT7C4339_SIM_PIN_COUNT; i++ )
+  {
+    simPins[i].mode = INPUT;
+    simPins[i].mcuLevel = HIGH;
+    simPins[i].deviceLevel = HIGH;
+    simPins[i].lastLevel = HIGH;
+    simPins[i].isr = nullptr;
+    simPins[i].isrMode = 0;
+    simPins[i].pending = false;
+  }
+
+  simPinsInitialized = true;
+}
+
+static uint8_t computeLevel( uint8_t pin )
+{
+  const SimPin &p = simPins[pin];
+  uint8_t mcu = ( p.mode == OUTPUT ) ? p.mcuLevel : HIGH;
+
+  return ( mcu && p.deviceLevel ) ? HIGH : LOW;
+}
+
+static void updatePin( uint8_t pin )
+{
+  SimPin &p = simPins[pin];
+  uint8_t newLevel = computeLevel( pin );
+
+  if( newLevel == p.lastLevel ) return;
+  p.lastLevel = newLevel;
+
+  if( p.isr == nullptr ) return;
+
+  bool fire = ( p.isrMode == CHANGE ) || ( p.isrMode == FALLING && newLevel == LOW ) || ( p.isrMode == RISING && newLevel == HIGH );
+  if( !fire ) return;
+
+  if( simInterruptsDisabled ) p.pending = true;
+  else p.isr();
+}
+
+uint64_t PT7C4339SimClock::now()
+{
+  return simNow;
+}
+
+void PT7C4339SimClock::setNow( uint64_t now )
+{
+  simNow = now;
+}
+
+/**
+ * @brief Moves the virtual clock forward and lets every listener catch up.
+ *
+ * @param microseconds Amount of virtual time to add.
+ */
+void PT7C4339SimClock::advance( uint64_t microseconds )
+{
+  uint64_t target = simNow + microseconds;
+
+  for( PT7C4339SimClockListener *l = simListeners; l != nullptr; l = l->nextListener )
+  {
+    l->simAdvanceTo( target );
+  }
+
+  simNow = target;
+}
+
+void PT7C4339SimClock::reset()
+{
+  simNow = 0;
+}
+
+void PT7C4339SimClock::addListener( PT7C4339SimClockListener *listener )
+{
+  listener->nextListener = simListeners;
+  simListeners = listener;
+}
+
+void PT7C4339SimClock::removeListener( PT7C4339SimClockListener *listener )
+{
+  PT7C4339SimClockListener **link = &simListeners;
+
+  while( *link != nullptr )
+  {
+    if( *link == listener )
+    {
+      *link = listener->nextListener;
+      listener->nextListener = nullptr;
+      return;
+    }
+    link = &( *link )->nextListener;
+  }
+}
+
+/**
+ * @brief Lets a simulated device drive a pin (open-drain: LOW pulls, HIGH releases).
+ */
+void PT7C4339SimPins::deviceDrive( uint8_t pin, uint8_t level )
+{
+  initPins();
+  if( pin >= PT7C4339_SIM_PIN_COUNT ) return;
+
+  simPins[pin].deviceLevel = level ? HIGH : LOW;
+  updatePin( pin );
+}
+
+uint8_t PT7C4339SimPins::level( uint8_t pin )
+{
+  initPins();
+  if( pin >= PT7C4339_SIM_PIN_COUNT ) return HIGH;
+
+  return computeLevel( pin );
+}
+
+/**
+ * @brief Registers a hook called on every digitalWrite(), used by devices that watch MCU-driven lines.
+ */
+void PT7C4339SimPins::setWriteHook( WriteHook hook, void *context )
+{
+  simWriteHook = hook;
+  simWriteHookContext = context;
+}
+
+void PT7C4339SimPins::reset()
+{
+  simPinsInitialized = false;
+  simWriteHook = nullptr;
+  simWriteHookContext = nullptr;
+  simInterruptsDisabled = 0;
+  initPins();
+}
+
+uint32_t millis()
+{
+  return static_cast<uint32_t>( simNow / 1000 );
+}
+
+uint32_t micros()
+{
+  return static_cast<uint32_t>( simNow );
+}
+
+void delay( uint32_t ms )
+{
+  PT7C4339SimClock::advance( static_cast<uint64_t>( ms ) * 1000 );
+}
+
+void delayMicroseconds( uint32_t us )
+{
+  PT7C4339SimClock::advance( us );
+}
+
+void yield()
+{
+}
+
+void pinMode( uint8_t pin, uint8_t mode )
+{
+  initPins();
+  if( pin >= PT7C4339_SIM_PIN_COUNT ) return;
+
+  simPins[pin].mode = mode;
+  updatePin( pin );
+}
+
+void digitalWrite( uint8_t pin, uint8_t value )
+{
+  initPins();
+  if( pin >= PT7C4339_SIM_PIN_COUNT ) return;
+
+  simPins[pin].mcuLevel = value ? HIGH : LOW;
+  updatePin( pin );
+
+  if( simWriteHook != nullptr ) simWriteHook( pin, simPins[pin].mcuLevel, simWriteHookContext );
+}
+
+int digitalRead( uint8_t pin )
+{
+  return PT7C4339SimPins::level( pin );
+}
+
+void attachInterrupt( uint8_t pin, void ( *isr )(), int mode )
+{
+  initPins();
+  if( pin >= PT7C4339_SIM_PIN_COUNT ) return;
+
+  simPins[pin].isr = isr;
+  simPins[pin].isrMode = mode;
+  simPins[pin].lastLevel = computeLevel( pin );
+}
+
+void detachInterrupt( uint8_t pin )
+{
+  initPins();
+  if( pin >= PT7C4339_SIM_PIN_COUNT ) return;
+
+  simPins[pin].isr = nullptr;
+}
+
+void noInterrupts()
+{
+  simInterruptsDisabled++;
+}
+
+void interrupts()
+{
+  if( simInterruptsDisabled > 0 ) simInterruptsDisabled--;
+  if( simInterruptsDisabled > 0 ) return;
+
+  initPins();
+  for( uint8_t i = 0; i < PT7C4339_SIM_PIN_COUNT; i++ )
+  {
+    if( simPins[i].pending && simPins[i].isr != nullptr )
+    {
+      simPins[i].pending = false;
+      simPins[i].isr();
+    }
+  }
+}
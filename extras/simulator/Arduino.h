@@ -0,0 +1,112 @@
+/**
+ * @file Arduino.h
+ * @brief Minimal host-side stand-in for the Arduino core used by the PT7C4339 simulator.
+ *
+ * Provides the handful of Arduino core functions the PT7C4339-RTC library and its examples use
+ * (timing, pins and interrupts), backed by a virtual clock instead of hardware timers.
+ * Time only moves when delay() is called, when I2C traffic is clocked on the simulated bus,
+ * or when PT7C4339SimClock::advance() is called, so runs are fully deterministic.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#ifndef _PT7C4339_SIM_ARDUINO_H_
+#define _PT7C4339_SIM_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define HIGH          0x1
+#define LOW           0x0
+
+#define INPUT         0x0
+#define OUTPUT        0x1
+#define INPUT_PULLUP  0x2
+
+#define CHANGE        1
+#define FALLING       2
+#define RISING        3
+
+static const uint8_t SDA = 21; ///< Default SDA pin of the simulated board
+static const uint8_t SCL = 22; ///< Default SCL pin of the simulated board
+
+#define IRAM_ATTR
+#define PROGMEM
+#define pgm_read_byte( addr ) ( *( const uint8_t * )( addr ) )
+#define digitalPinToInterrupt( pin ) ( pin )
+
+#define PT7C4339_SIM_PIN_COUNT 64 ///< Number of pins of the simulated board
+
+/**
+ * @brief Listener interface notified whenever the virtual clock moves forward.
+ */
+class PT7C4339SimClockListener
+{
+  public:
+    virtual ~PT7C4339SimClockListener() {}
+
+    /**
+     * @brief Brings the listener up to the given virtual time.
+     *
+     * Implementations may call PT7C4339SimClock::setNow() with intermediate timestamps
+     * while processing events, so that code running from simulated interrupts observes
+     * the time at which the event happened.
+     *
+     * @param target Virtual time in microseconds to advance to.
+     */
+    virtual void simAdvanceTo( uint64_t target ) = 0;
+
+    PT7C4339SimClockListener *nextListener = nullptr; ///< Intrusive list link, managed by PT7C4339SimClock
+};
+
+/**
+ * @brief Virtual microsecond clock behind millis(), micros() and delay().
+ */
+class PT7C4339SimClock
+{
+  public:
+    static uint64_t now();
+    static void setNow( uint64_t now );
+    static void advance( uint64_t microseconds );
+    static void reset();
+
+    static void addListener( PT7C4339SimClockListener *listener );
+    static void removeListener( PT7C4339SimClockListener *listener );
+};
+
+/**
+ * @brief Simulated GPIO bank, shared by the MCU side and the simulated devices.
+ *
+ * Lines are modelled as open-drain with pull-ups: a pin reads LOW if either the MCU drives it low
+ * as an output or a device pulls it low.
+ */
+class PT7C4339SimPins
+{
+  public:
+    typedef void ( *WriteHook )( uint8_t pin, uint8_t level, void *context );
+
+    static void deviceDrive( uint8_t pin, uint8_t level );
+    static uint8_t level( uint8_t pin );
+    static void setWriteHook( WriteHook hook, void *context );
+    static void reset();
+};
+
+uint32_t millis();
+uint32_t micros();
+void delay( uint32_t ms );
+void delayMicroseconds( uint32_t us );
+void yield();
+
+void pinMode( uint8_t pin, uint8_t mode );
+void digitalWrite( uint8_t pin, uint8_t value );
+int digitalRead( uint8_t pin );
+
+void attachInterrupt( uint8_t pin, void ( *isr )(), int mode );
+void detachInterrupt( uint8_t pin );
+void noInterrupts();
+void interrupts();
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file PT7C4339-SimI2cDev.cpp
+ * @brief Implementation of the Linux /dev/i2c-N driver stand-in.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#include "PT7C4339-SimI2cDev.h"
+
+#include <errno.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+TwoWire *PT7C4339SimI2cDev::_i2cWire = &Wire;
+uint32_t PT7C4339SimI2cDev::_callCount = 0;
+
+/**
+ * @brief Handles an ioctl request like the i2c-dev driver, I2C_RDWR and I2C_TIMEOUT are supported.
+ *
+ * Write messages are sent with endTransmission(), without a stop if a message follows, read messages with requestFrom().
+ * The bus is initialized on the first call, like an adapter that is always up. I2C_TIMEOUT sets the timeout of the bus
+ * from its value in units of 10ms.
+ *
+ * @return The number of messages transferred (0 for I2C_TIMEOUT), or -1 with errno set to EINVAL (unsupported request),
+ *         ETIMEDOUT (stuck bus) or EREMOTEIO (NACK).
+ */
+int PT7C4339SimI2cDev::ioctl( int fd, unsigned long request, void *arg )
+{
+  ( void )fd;
+  _callCount++;
+
+  if( request == I2C_TIMEOUT )
+  {
+    _i2cWire->setWireTimeout( static_cast<uint32_t>( reinterpret_cast<uintptr_t>( arg ) ) * 10000, true );
+    return 0;
+  }
+
+  if( request != I2C_RDWR || arg == nullptr )
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  if( !_i2cWire->isInitialized() ) _i2cWire->begin();
+  _i2cWire->clearWireTimeoutFlag();
+
+  struct i2c_rdwr_ioctl_data *data = static_cast<struct i2c_rdwr_ioctl_data *>( arg );
+
+  for( uint32_t i = 0; i < data->nmsgs; i++ )
+  {
+    struct i2c_msg *msg = &data->msgs[i];
+
+    if( msg->flags & I2C_M_RD )
+    {
+      if( _i2cWire->requestFrom( static_cast<uint8_t>( msg->addr ), static_cast<uint8_t>( msg->len ) ) != msg->len )
+      {
+        errno = _i2cWire->getWireTimeoutFlag() ? ETIMEDOUT : EREMOTEIO;
+        return -1;
+      }
+
+      for( uint16_t j = 0; j < msg->len; j++ )
+      {
+        msg->buf[j] = _i2cWire->read();
+      }
+    }
+    else
+    {
+      _i2cWire->beginTransmission( static_cast<uint8_t>( msg->addr ) );
+      _i2cWire->write( msg->buf, msg->len );
+
+      if( _i2cWire->endTransmission( i + 1 == data->nmsgs ) != 0 )
+      {
+        errno = _i2cWire->getWireTimeoutFlag() ? ETIMEDOUT : EREMOTEIO;
+        return -1;
+      }
+    }
+  }
+
+  return static_cast<int>( data->nmsgs );
+}
+
+/**
+ * @brief Selects the simulated bus the requests are carried out on, Wire by default.
+ */
+void PT7C4339SimI2cDev::setBus( TwoWire *i2cWire )
+{
+  _i2cWire = i2cWire;
+}
+
+/**
+ * @brief Returns the number of ioctl() calls, each standing for one system call.
+ */
+uint32_t PT7C4339SimI2cDev::getCallCount()
+{
+  return _callCount;
+}
+
+void PT7C4339SimI2cDev::resetCallCount()
+{
+  _callCount = 0;
+}
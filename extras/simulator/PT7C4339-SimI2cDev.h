@@ -0,0 +1,34 @@
+/**
+ * @file PT7C4339-SimI2cDev.h
+ * @brief Stand-in for the Linux /dev/i2c-N driver, for host-side tests of the PT7C4339_LinuxBus policy.
+ *
+ * PT7C4339SimI2cDev::ioctl() is passed to PT7C4339_LinuxBus in place of the ioctl() system call, with any file
+ * (e.g. a temporary regular file) as the device node. It carries out the messages of every I2C_RDWR request on the
+ * simulated TwoWire bus, so they reach the PT7C4339Simulator and PT7C4339SimMux models attached to it, and counts the calls.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#ifndef _PT7C4339_SIM_I2C_DEV_H_
+#define _PT7C4339_SIM_I2C_DEV_H_
+
+#include <Arduino.h>
+#include <Wire.h>
+
+class PT7C4339SimI2cDev ///< Stand-in for the Linux /dev/i2c-N driver on top of the simulated bus
+{
+  public:
+    static int ioctl( int fd, unsigned long request, void *arg );
+
+    static void setBus( TwoWire *i2cWire );
+    static uint32_t getCallCount();
+    static void resetCallCount();
+
+  private:
+    static TwoWire *_i2cWire;
+    static uint32_t _callCount;
+};
+
+#endif
@@ -0,0 +1,176 @@
+/**
+ * @file PT7C4339-SimMux.cpp
+ * @brief Implementation of the TCA9548A multiplexer model.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#include "PT7C4339-SimMux.h"
+
+/**
+ * @brief Creates the model with every channel disabled and connects it to the given simulated bus.
+ *
+ * @param i2cWire The simulated bus to attach to.
+ * @param address The 7bit I2C address the model answers on (0x70-0x77).
+ */
+PT7C4339SimMux::PT7C4339SimMux( TwoWire *i2cWire, uint8_t address )
+{
+  _i2cWire = i2cWire;
+  _address = address;
+  _control = 0x00;
+  _controlWrites = 0;
+  _target = nullptr;
+
+  for( uint8_t i = 0; i < PT7C4339_SIM_MUX_CHANNELS; i++ )
+  {
+    _channels[i] = nullptr;
+  }
+
+  _i2cWire->attachDevice( this );
+}
+
+PT7C4339SimMux::~PT7C4339SimMux()
+{
+  _i2cWire->detachDevice( this );
+}
+
+/**
+ * @brief Moves a device from the upstream bus to a downstream channel.
+ *
+ * The device is detached from the bus of the multiplexer, and only answers while its channel is enabled.
+ * Several devices can share a channel. A device must be disconnected before it is destroyed.
+ */
+void PT7C4339SimMux::connect( uint8_t channel, PT7C4339SimDevice *device )
+{
+  if( channel >= PT7C4339_SIM_MUX_CHANNELS ) return;
+
+  _i2cWire->detachDevice( device );
+
+  device->nextDevice = _channels[channel];
+  _channels[channel] = device;
+}
+
+/**
+ * @brief Removes a device from its downstream channel, it is not attached to any bus afterwards.
+ */
+void PT7C4339SimMux::disconnect( PT7C4339SimDevice *device )
+{
+  for( uint8_t i = 0; i < PT7C4339_SIM_MUX_CHANNELS; i++ )
+  {
+    PT7C4339SimDevice **link = &_channels[i];
+
+    while( *link != nullptr )
+    {
+      if( *link == device )
+      {
+        *link = device->nextDevice;
+        device->nextDevice = nullptr;
+        return;
+      }
+      link = &( *link )->nextDevice;
+    }
+  }
+}
+
+/**
+ * @brief Returns the control register, bit n enables channel n.
+ */
+uint8_t PT7C4339SimMux::getControl()
+{
+  return _control;
+}
+
+/**
+ * @brief Sets the control register without bus traffic, like a reset pulse (0x00) or a pre-selected channel.
+ */
+void PT7C4339SimMux::setControl( uint8_t control )
+{
+  _control = control;
+}
+
+/**
+ * @brief Returns the number of control register writes received over the bus.
+ */
+uint32_t PT7C4339SimMux::getControlWrites()
+{
+  return _controlWrites;
+}
+
+/**
+ * @brief Answers on the own address, or on the address of a device of an enabled channel.
+ *
+ * If several devices of the enabled channels share the address, the one on the lowest channel is addressed,
+ * where the real chip would have them all drive the bus at once.
+ */
+bool PT7C4339SimMux::i2cMatches( uint8_t address ) const
+{
+  _target = nullptr;
+  if( address == _address ) return true;
+
+  for( uint8_t i = 0; i < PT7C4339_SIM_MUX_CHANNELS; i++ )
+  {
+    if( !( _control & ( 1 << i ) ) ) continue;
+
+    for( PT7C4339SimDevice *d = _channels[i]; d != nullptr; d = d->nextDevice )
+    {
+      if( d->i2cMatches( address ) )
+      {
+        _target = d;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Forwards a write to the addressed downstream device, or writes the control register with the last byte.
+ */
+bool PT7C4339SimMux::i2cWrite( const uint8_t *data, size_t length )
+{
+  if( _target != nullptr ) return _target->i2cWrite( data, length );
+
+  if( length > 0 )
+  {
+    _control = data[length - 1];
+    _controlWrites++;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Forwards a read to the addressed downstream device, or returns the control register.
+ */
+size_t PT7C4339SimMux::i2cRead( uint8_t *data, size_t length )
+{
+  if( _target != nullptr ) return _target->i2cRead( data, length );
+
+  for( size_t i = 0; i < length; i++ )
+  {
+    data[i] = _control;
+  }
+
+  return length;
+}
+
+/**
+ * @brief A device holding SDA low on an enabled channel holds the upstream bus too.
+ */
+bool PT7C4339SimMux::i2cHoldsSda() const
+{
+  for( uint8_t i = 0; i < PT7C4339_SIM_MUX_CHANNELS; i++ )
+  {
+    if( !( _control & ( 1 << i ) ) ) continue;
+
+    for( PT7C4339SimDevice *d = _channels[i]; d != nullptr; d = d->nextDevice )
+    {
+      if( d->i2cHoldsSda() ) return true;
+    }
+  }
+
+  return false;
+}
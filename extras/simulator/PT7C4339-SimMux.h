@@ -0,0 +1,51 @@
+/**
+ * @file PT7C4339-SimMux.h
+ * @brief Model of a TCA9548A I2C multiplexer for host-side builds of the PT7C4339-RTC library.
+ *
+ * The model attaches to the simulated TwoWire bus at its own address and forwards every other
+ * transaction to the devices connected to its enabled channels, like the switches of the real chip.
+ * It lets several PT7C4339Simulator instances answer at the same 0x68 address on one bus.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#ifndef _PT7C4339_SIM_MUX_H_
+#define _PT7C4339_SIM_MUX_H_
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define PT7C4339_SIM_MUX_CHANNELS 8 ///< Number of downstream channels of the TCA9548A
+
+class PT7C4339SimMux : public PT7C4339SimDevice ///< Model of a TCA9548A I2C multiplexer
+{
+  public:
+    PT7C4339SimMux( TwoWire *i2cWire = &Wire, uint8_t address = 0x70 );
+    ~PT7C4339SimMux();
+
+    void connect( uint8_t channel, PT7C4339SimDevice *device );
+    void disconnect( PT7C4339SimDevice *device );
+
+    uint8_t getControl();
+    void setControl( uint8_t control );
+    uint32_t getControlWrites();
+
+    /* PT7C4339SimDevice */
+    bool i2cMatches( uint8_t address ) const override;
+    bool i2cWrite( const uint8_t *data, size_t length ) override;
+    size_t i2cRead( uint8_t *data, size_t length ) override;
+    bool i2cHoldsSda() const override;
+
+  private:
+    TwoWire *_i2cWire;
+    uint8_t _address;
+    uint8_t _control;
+    uint32_t _controlWrites;
+
+    PT7C4339SimDevice *_channels[PT7C4339_SIM_MUX_CHANNELS];
+    mutable PT7C4339SimDevice *_target; ///< Downstream device addressed by the current transaction, nullptr for the multiplexer itself
+};
+
+#endif
@@ -0,0 +1,477 @@
+/**
+ * @file PT7C4339-Simulator.cpp
+ * @brief Implementation of the register-level PT7C4339 model.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#include "PT7C4339-Simulator.h"
+
+/**
+ * @brief Power-on register image, 2000-01-01 00:00:00, oscillator running, OSF set, 32.768kHz square wave.
+ */
+static const uint8_t powerOnImage[PT7C4339_SIM_REGISTER_COUNT] =
+{
+  0x00, 0x00, 0x00, 0x01, 0x01, 0x81, 0x00,
+  0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00,
+  0x18, 0x80, 0x00
+};
+
+/**
+ * @brief Creates the model and connects it to the given simulated bus.
+ *
+ * @param i2cWire The simulated bus to attach to.
+ * @param address The 7bit I2C address the model answers on.
+ */
+PT7C4339Simulator::PT7C4339Simulator( TwoWire *i2cWire, uint8_t address )
+{
+  _i2cWire = i2cWire;
+  _address = address;
+  _intPin = PT7C4339_SIM_NO_PIN;
+  _sclPin = PT7C4339_SIM_NO_PIN;
+  _sdaPin = PT7C4339_SIM_NO_PIN;
+  _failCount = 0;
+  _sdaHeld = false;
+  _releaseClocks = 0;
+  _tickCount = 0;
+  _driftPpb = 0;
+  _tickRemainderNs = 0;
+
+  powerOn();
+
+  _i2cWire->attachDevice( this );
+  PT7C4339SimClock::addListener( this );
+}
+
+PT7C4339Simulator::~PT7C4339Simulator()
+{
+  _i2cWire->detachDevice( this );
+  PT7C4339SimClock::removeListener( this );
+
+  if( _sclPin != PT7C4339_SIM_NO_PIN ) PT7C4339SimPins::setWriteHook( nullptr, nullptr );
+}
+
+/**
+ * @brief Puts every register into its first power-on state and restarts the oscillator.
+ */
+void PT7C4339Simulator::powerOn()
+{
+  memcpy( _regs, powerOnImage, sizeof( _regs ) );
+  _pointer = 0;
+  _running = false;
+  _sqwPhaseHigh = true;
+  _outputLevel = true;
+
+  updateOscillator();
+  updateOutput();
+}
+
+/**
+ * @brief Reads a register directly, without going through the bus.
+ */
+uint8_t PT7C4339Simulator::getRegister( uint8_t reg )
+{
+  simAdvanceTo( PT7C4339SimClock::now() );
+
+  return _regs[reg % PT7C4339_SIM_REGISTER_COUNT];
+}
+
+/**
+ * @brief Writes a register directly, without going through the bus and without the write side effects of the chip.
+ */
+void PT7C4339Simulator::setRegister( uint8_t reg, uint8_t value )
+{
+  simAdvanceTo( PT7C4339SimClock::now() );
+
+  _regs[reg % PT7C4339_SIM_REGISTER_COUNT] = value;
+
+  updateOscillator();
+  updateOutput();
+}
+
+/**
+ * @brief Loads the timekeeping registers directly. The weekday is left untouched, like on the chip.
+ */
+void PT7C4339Simulator::setDateTime( uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second )
+{
+  simAdvanceTo( PT7C4339SimClock::now() );
+
+  uint8_t y = year % 100;
+
+  _regs[0x00] = ( ( second / 10 ) << 4 ) | ( second % 10 );
+  _regs[0x01] = ( ( minute / 10 ) << 4 ) | ( minute % 10 );
+  _regs[0x02] = ( ( hour / 10 ) << 4 ) | ( hour % 10 );
+  _regs[0x04] = ( ( day / 10 ) << 4 ) | ( day % 10 );
+  _regs[0x05] = ( ( year >= 2000 ) << 7 ) | ( ( month / 10 ) << 4 ) | ( month % 10 );
+  _regs[0x06] = ( ( y / 10 ) << 4 ) | ( y % 10 );
+
+  if( _running ) _nextTickAt = PT7C4339SimClock::now() + tickPeriod();
+}
+
+/**
+ * @brief Sets the frequency error of the crystal, so the timekeeping registers drift from the virtual clock.
+ *
+ * @param ppb The drift in parts per billion, positive to make the model run fast. 0 (default) keeps it exact.
+ */
+void PT7C4339Simulator::setDriftPpb( int32_t ppb )
+{
+  _driftPpb = ppb;
+}
+
+/**
+ * @brief Runs the virtual clock forward by whole seconds.
+ */
+void PT7C4339Simulator::advanceSeconds( uint32_t seconds )
+{
+  PT7C4339SimClock::advance( static_cast<uint64_t>( seconds ) * 1000000 );
+}
+
+/**
+ * @brief Connects the open-drain INT/SQW output of the model to a pin of the simulated board.
+ */
+void PT7C4339Simulator::connectIntPin( uint8_t pin )
+{
+  _intPin = pin;
+  updateOutput();
+  PT7C4339SimPins::deviceDrive( _intPin, _outputLevel ? HIGH : LOW );
+}
+
+/**
+ * @brief Returns the level of the INT/SQW output (true = released/high).
+ */
+bool PT7C4339Simulator::getIntSqwLevel()
+{
+  simAdvanceTo( PT7C4339SimClock::now() );
+
+  return _outputLevel;
+}
+
+/**
+ * @brief NACKs the next given number of transactions addressed to the model.
+ */
+void PT7C4339Simulator::failNextTransactions( uint8_t count )
+{
+  _failCount = count;
+}
+
+/**
+ * @brief Makes the model hold SDA low (or release it), which makes every transaction on the bus time out.
+ */
+void PT7C4339Simulator::holdSda( bool hold )
+{
+  _sdaHeld = hold;
+  _releaseClocks = 0;
+  if( _sdaPin != PT7C4339_SIM_NO_PIN ) PT7C4339SimPins::deviceDrive( _sdaPin, hold ? LOW : HIGH );
+}
+
+/**
+ * @brief Makes a held SDA line get released after the MCU clocks SCL the given number of times through digitalWrite().
+ *
+ * The SDA pin is pulled low while the line is held, so the MCU can see it with digitalRead() during the recovery.
+ *
+ * @param clocks Number of SCL falling edges needed to release SDA.
+ * @param sclPin The pin number the MCU uses as SCL while recovering the bus.
+ * @param sdaPin The pin number the MCU uses as SDA while recovering the bus, SDA of the board by default.
+ */
+void PT7C4339Simulator::releaseSdaAfterClocks( uint8_t clocks, uint8_t sclPin, uint8_t sdaPin )
+{
+  _releaseClocks = clocks;
+  _sclPin = sclPin;
+  _sdaPin = sdaPin;
+  PT7C4339SimPins::deviceDrive( _sdaPin, _sdaHeld ? LOW : HIGH );
+  PT7C4339SimPins::setWriteHook( pinWriteHook, this );
+}
+
+/**
+ * @brief Returns the number of one second timekeeping ticks since the model was created.
+ */
+uint32_t PT7C4339Simulator::getTickCount()
+{
+  return _tickCount;
+}
+
+bool PT7C4339Simulator::i2cMatches( uint8_t address ) const
+{
+  return address == _address;
+}
+
+/**
+ * @brief Handles a write: the first byte sets the register pointer, the following bytes are written with auto-increment.
+ */
+bool PT7C4339Simulator::i2cWrite( const uint8_t *data, size_t length )
+{
+  if( _failCount > 0 )
+  {
+    _failCount--;
+    return false;
+  }
+
+  if( length == 0 ) return true;
+
+  _pointer = data[0] % PT7C4339_SIM_REGISTER_COUNT;
+
+  for( size_t i = 1; i < length; i++ )
+  {
+    uint8_t reg = _pointer;
+    uint8_t value = data[i];
+
+    if( reg == 0x0F )
+    {
+      // OSF, A2F and A1F can only be cleared by software
+      value = ( value & 0x7C ) | ( _regs[reg] & value & 0x83 );
+    }
+
+    _regs[reg] = value;
+
+    // Writing the seconds register resets the countdown chain
+    if( reg == 0x00 && _running ) _nextTickAt = PT7C4339SimClock::now() + tickPeriod();
+
+    _pointer = ( _pointer + 1 ) % PT7C4339_SIM_REGISTER_COUNT;
+  }
+
+  updateOscillator();
+  updateOutput();
+
+  return true;
+}
+
+/**
+ * @brief Handles a read: returns registers starting at the register pointer, with auto-increment.
+ */
+size_t PT7C4339Simulator::i2cRead( uint8_t *data, size_t length )
+{
+  if( _failCount > 0 )
+  {
+    _failCount--;
+    return 0;
+  }
+
+  for( size_t i = 0; i < length; i++ )
+  {
+    data[i] = _regs[_pointer];
+    _pointer = ( _pointer + 1 ) % PT7C4339_SIM_REGISTER_COUNT;
+  }
+
+  return length;
+}
+
+bool PT7C4339Simulator::i2cHoldsSda() const
+{
+  return _sdaHeld;
+}
+
+/**
+ * @brief Processes every timekeeping tick and square wave edge up to the given virtual time.
+ */
+void PT7C4339Simulator::simAdvanceTo( uint64_t target )
+{
+  if( !_running ) return;
+
+  bool sqw1Hz = !( _regs[0x0E] & 0x04 ) && ( ( _regs[0x0E] >> 3 ) & 0x03 ) == 0;
+
+  while( true )
+  {
+    uint64_t risingEdgeAt = _nextTickAt - 500000;
+
+    if( sqw1Hz && !_sqwPhaseHigh && risingEdgeAt <= target && risingEdgeAt >= PT7C4339SimClock::now() )
+    {
+      PT7C4339SimClock::setNow( risingEdgeAt );
+      _sqwPhaseHigh = true;
+      updateOutput();
+      continue;
+    }
+
+    if( _nextTickAt > target ) break;
+
+    PT7C4339SimClock::setNow( _nextTickAt );
+    _nextTickAt += tickPeriod();
+    tick();
+
+    sqw1Hz = !( _regs[0x0E] & 0x04 ) && ( ( _regs[0x0E] >> 3 ) & 0x03 ) == 0;
+  }
+}
+
+/**
+ * @brief Advances the timekeeping registers by one second and evaluates the alarms.
+ */
+void PT7C4339Simulator::tick()
+{
+  _tickCount++;
+
+  _regs[0x00] = incrementBcd( _regs[0x00] & 0x7F );
+
+  if( _regs[0x00] == 0x60 )
+  {
+    _regs[0x00] = 0x00;
+    _regs[0x01] = incrementBcd( _regs[0x01] & 0x7F );
+
+    if( _regs[0x01] == 0x60 )
+    {
+      _regs[0x01] = 0x00;
+      _regs[0x02] = incrementBcd( _regs[0x02] & 0x3F );
+
+      if( _regs[0x02] == 0x24 )
+      {
+        _regs[0x02] = 0x00;
+        _regs[0x03] = ( _regs[0x03] & 0x07 ) % 7 + 1;
+
+        uint8_t monthLength = daysInMonth();
+        _regs[0x04] = incrementBcd( _regs[0x04] & 0x3F );
+
+        uint8_t day = ( ( _regs[0x04] >> 4 ) * 10 ) + ( _regs[0x04] & 0x0F );
+        if( day > monthLength )
+        {
+          _regs[0x04] = 0x01;
+
+          uint8_t century = _regs[0x05] & 0x80;
+          uint8_t month = incrementBcd( _regs[0x05] & 0x1F );
+
+          if( month == 0x13 )
+          {
+            month = 0x01;
+            _regs[0x06] = incrementBcd( _regs[0x06] );
+
+            if( _regs[0x06] == 0xA0 )
+            {
+              _regs[0x06] = 0x00;
+              century ^= 0x80;
+            }
+          }
+
+          _regs[0x05] = century | month;
+        }
+      }
+    }
+  }
+
+  matchAlarms();
+
+  _sqwPhaseHigh = false;
+  updateOutput();
+}
+
+/**
+ * @brief Sets A1F/A2F if the current time matches the alarm registers under their mask bits.
+ */
+void PT7C4339Simulator::matchAlarms()
+{
+  uint8_t seconds = _regs[0x00] & 0x7F;
+  uint8_t minutes = _regs[0x01] & 0x7F;
+  uint8_t hours = _regs[0x02] & 0x3F;
+  uint8_t weekDay = _regs[0x03] & 0x07;
+  uint8_t date = _regs[0x04] & 0x3F;
+
+  uint8_t a1DayDate = _regs[0x0A];
+  bool a1Match = ( ( _regs[0x07] & 0x80 ) || ( _regs[0x07] & 0x7F ) == seconds )
+    && ( ( _regs[0x08] & 0x80 ) || ( _regs[0x08] & 0x7F ) == minutes )
+    && ( ( _regs[0x09] & 0x80 ) || ( _regs[0x09] & 0x3F ) == hours )
+    && ( ( a1DayDate & 0x80 ) || ( ( a1DayDate & 0x40 ) ? ( a1DayDate & 0x07 ) == weekDay : ( a1DayDate & 0x3F ) == date ) );
+
+  if( a1Match ) _regs[0x0F] |= 0x01;
+
+  if( seconds == 0x00 )
+  {
+    uint8_t a2DayDate = _regs[0x0D];
+    bool a2Match = ( ( _regs[0x0B] & 0x80 ) || ( _regs[0x0B] & 0x7F ) == minutes )
+      && ( ( _regs[0x0C] & 0x80 ) || ( _regs[0x0C] & 0x3F ) == hours )
+      && ( ( a2DayDate & 0x80 ) || ( ( a2DayDate & 0x40 ) ? ( a2DayDate & 0x07 ) == weekDay : ( a2DayDate & 0x3F ) == date ) );
+
+    if( a2Match ) _regs[0x0F] |= 0x02;
+  }
+}
+
+/**
+ * @brief Starts or stops the oscillator according to the /EOSC bit. Stopping it sets OSF.
+ */
+void PT7C4339Simulator::updateOscillator()
+{
+  bool enabled = !( _regs[0x0E] & 0x80 );
+
+  if( enabled && !_running )
+  {
+    _running = true;
+    _nextTickAt = PT7C4339SimClock::now() + tickPeriod();
+    _sqwPhaseHigh = true;
+  }
+  else if( !enabled && _running )
+  {
+    _running = false;
+    _regs[0x0F] |= 0x80;
+  }
+}
+
+/**
+ * @brief Recomputes the INT/SQW output level and drives the connected pin.
+ *
+ * In interrupt mode (INTCN = 1) the output is pulled low while an enabled alarm flag is set.
+ * In square wave mode only the 1Hz output is modelled edge by edge, with the falling edge
+ * coinciding with the seconds update. Higher frequencies are reported as a high level.
+ */
+void PT7C4339Simulator::updateOutput()
+{
+  bool level;
+  uint8_t control = _regs[0x0E];
+
+  if( control & 0x04 )
+  {
+    bool a1 = ( control & 0x01 ) && ( _regs[0x0F] & 0x01 );
+    bool a2 = ( control & 0x02 ) && ( _regs[0x0F] & 0x02 );
+    level = !( a1 || a2 );
+  }
+  else if( _running && ( ( control >> 3 ) & 0x03 ) == 0 ) level = _sqwPhaseHigh;
+  else level = true;
+
+  if( level == _outputLevel ) return;
+  _outputLevel = level;
+
+  if( _intPin != PT7C4339_SIM_NO_PIN ) PT7C4339SimPins::deviceDrive( _intPin, _outputLevel ? HIGH : LOW );
+}
+
+/**
+ * @brief Returns the microseconds until the next seconds update, with the drift applied and its sub-microsecond part carried over.
+ */
+uint64_t PT7C4339Simulator::tickPeriod()
+{
+  int64_t periodNs = 1000000000LL - _driftPpb + _tickRemainderNs;
+  _tickRemainderNs = static_cast<int32_t>( periodNs % 1000 );
+
+  return static_cast<uint64_t>( periodNs / 1000 );
+}
+
+uint8_t PT7C4339Simulator::incrementBcd( uint8_t bcd )
+{
+  bcd++;
+  if( ( bcd & 0x0F ) > 9 ) bcd = ( bcd & 0xF0 ) + 0x10;
+
+  return bcd;
+}
+
+uint8_t PT7C4339Simulator::daysInMonth()
+{
+  uint8_t month = ( ( ( _regs[0x05] & 0x1F ) >> 4 ) * 10 ) + ( _regs[0x05] & 0x0F );
+  uint8_t year = ( ( _regs[0x06] >> 4 ) * 10 ) + ( _regs[0x06] & 0x0F );
+
+  static const uint8_t lengths[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+  if( month < 1 || month > 12 ) return 31;
+  if( month == 2 && year % 4 == 0 ) return 29;
+
+  return lengths[month - 1];
+}
+
+void PT7C4339Simulator::pinWriteHook( uint8_t pin, uint8_t level, void *context )
+{
+  PT7C4339Simulator *sim = static_cast<PT7C4339Simulator *>( context );
+
+  if( !sim->_sdaHeld || pin != sim->_sclPin || level != LOW || sim->_releaseClocks == 0 ) return;
+
+  sim->_releaseClocks--;
+  if( sim->_releaseClocks == 0 )
+  {
+    sim->_sdaHeld = false;
+    PT7C4339SimPins::deviceDrive( sim->_sdaPin, HIGH );
+  }
+}
@@ -0,0 +1,94 @@
+/**
+ * @file PT7C4339-Simulator.h
+ * @brief Register-level model of the PT7C4339 RTC for host-side builds of the PT7C4339-RTC library.
+ *
+ * The model attaches to the simulated TwoWire bus and reproduces the behaviour of the chip as seen
+ * over I2C: the auto-incrementing register pointer, BCD timekeeping with leap years and century
+ * rollover, alarm 1/2 mask matching, the OSF/A1F/A2F status flags and the INT/SQW output.
+ * Time advances with the virtual clock of the Arduino stand-in, so years of device time can be run
+ * in seconds of host time.
+ *
+ * @note Like the real chip, the model treats every year divisible by 4 as a leap year.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#ifndef _PT7C4339_SIMULATOR_H_
+#define _PT7C4339_SIMULATOR_H_
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define PT7C4339_SIM_REGISTER_COUNT 0x11 ///< Number of registers of the PT7C4339 (0x00-0x10)
+#define PT7C4339_SIM_NO_PIN         0xFF ///< Pin number used when the INT/SQW output is not connected
+
+class PT7C4339Simulator : public PT7C4339SimDevice, public PT7C4339SimClockListener ///< Register-level model of the PT7C4339 RTC
+{
+  public:
+    PT7C4339Simulator( TwoWire *i2cWire = &Wire, uint8_t address = 0x68 );
+    ~PT7C4339Simulator();
+
+    void powerOn();
+
+    uint8_t getRegister( uint8_t reg );
+    void setRegister( uint8_t reg, uint8_t value );
+
+    void setDateTime( uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second );
+    void advanceSeconds( uint32_t seconds );
+    void setDriftPpb( int32_t ppb );
+
+    void connectIntPin( uint8_t pin );
+    bool getIntSqwLevel();
+
+    void failNextTransactions( uint8_t count );
+    void holdSda( bool hold );
+    void releaseSdaAfterClocks( uint8_t clocks, uint8_t sclPin, uint8_t sdaPin = SDA );
+
+    uint32_t getTickCount();
+
+    /* PT7C4339SimDevice */
+    bool i2cMatches( uint8_t address ) const override;
+    bool i2cWrite( const uint8_t *data, size_t length ) override;
+    size_t i2cRead( uint8_t *data, size_t length ) override;
+    bool i2cHoldsSda() const override;
+
+    /* PT7C4339SimClockListener */
+    void simAdvanceTo( uint64_t target ) override;
+
+  private:
+    TwoWire *_i2cWire;
+    uint8_t _address;
+    uint8_t _regs[PT7C4339_SIM_REGISTER_COUNT];
+    uint8_t _pointer;
+
+    bool _running;
+    uint64_t _nextTickAt;
+    uint32_t _tickCount;
+    int32_t _driftPpb;
+    int32_t _tickRemainderNs;
+
+    uint8_t _intPin;
+    bool _outputLevel;
+    bool _sqwPhaseHigh;
+
+    uint8_t _failCount;
+    bool _sdaHeld;
+    uint8_t _releaseClocks;
+    uint8_t _sclPin;
+    uint8_t _sdaPin;
+
+    void tick();
+    void matchAlarms();
+    void updateOscillator();
+    void updateOutput();
+    uint64_t tickPeriod();
+
+    uint8_t incrementBcd( uint8_t bcd );
+    uint8_t daysInMonth();
+
+    static void pinWriteHook( uint8_t pin, uint8_t level, void *context );
+};
+
+#endif
@@ -0,0 +1,301 @@
+/**
+ * @file Wire.cpp
+ * @brief Implementation of the host-side TwoWire stand-in.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#include "Wire.h"
+
+TwoWire Wire;
+
+TwoWire::TwoWire()
+{
+  _initialized = false;
+  _frequency = 100000;
+  _timeout = 25000;
+  _timeoutFlag = false;
+  _txAddress = 0;
+  _txLength = 0;
+  _txOverflow = false;
+  _rxLength = 0;
+  _rxIndex = 0;
+  _devices = nullptr;
+  _pendingNs = 0;
+  resetStats();
+}
+
+void TwoWire::begin()
+{
+  _initialized = true;
+}
+
+void TwoWire::begin( int sda, int scl )
+{
+  ( void )sda;
+  ( void )scl;
+  _initialized = true;
+}
+
+void TwoWire::end()
+{
+  _initialized = false;
+}
+
+void TwoWire::setClock( uint32_t frequency )
+{
+  if( frequency > 0 ) _frequency = frequency;
+}
+
+void TwoWire::setWireTimeout( uint32_t timeout, bool resetWithTimeout )
+{
+  ( void )resetWithTimeout;
+  _timeout = timeout;
+}
+
+/**
+ * @brief Returns true if a transaction timed out since the flag was last cleared.
+ */
+bool TwoWire::getWireTimeoutFlag()
+{
+  return _timeoutFlag;
+}
+
+void TwoWire::clearWireTimeoutFlag()
+{
+  _timeoutFlag = false;
+}
+
+void TwoWire::beginTransmission( uint8_t address )
+{
+  _txAddress = address;
+  _txLength = 0;
+  _txOverflow = false;
+}
+
+void TwoWire::beginTransmission( int address )
+{
+  beginTransmission( static_cast<uint8_t>( address ) );
+}
+
+size_t TwoWire::write( uint8_t data )
+{
+  if( _txLength >= BUFFER_LENGTH )
+  {
+    _txOverflow = true;
+    return 0;
+  }
+
+  _txBuffer[_txLength++] = data;
+  return 1;
+}
+
+size_t TwoWire::write( const uint8_t *data, size_t quantity )
+{
+  size_t written = 0;
+
+  for( size_t i = 0; i < quantity; i++ ) written += write( data[i] );
+
+  return written;
+}
+
+/**
+ * @brief Sends the buffered bytes to the addressed device.
+ *
+ * @return uint8_t Same codes as the Arduino cores: 0 success, 1 buffer overflow,
+ *         2 address NACK, 3 data NACK, 4 other error (bus not initialized), 5 timeout.
+ */
+uint8_t TwoWire::endTransmission( uint8_t sendStop )
+{
+  ( void )sendStop;
+
+  if( !_initialized ) return 4;
+  if( _txOverflow ) return 1;
+
+  _stats.transactions++;
+
+  if( busStuck() )
+  {
+    _stats.timeouts++;
+    _timeoutFlag = true;
+    PT7C4339SimClock::advance( _timeout > 0 ? _timeout : 1000000 );
+    return 5;
+  }
+
+  PT7C4339SimDevice *device = findDevice( _txAddress );
+
+  if( device == nullptr )
+  {
+    _stats.nacks++;
+    _stats.bytes += 1;
+    clockOut( 2 + 9 );
+    return 2;
+  }
+
+  _stats.bytes += 1 + _txLength;
+  clockOut( 2 + 9 * ( 1 + _txLength ) );
+
+  if( !device->i2cWrite( _txBuffer, _txLength ) )
+  {
+    _stats.nacks++;
+    return 3;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Reads up to quantity bytes from the addressed device into the receive buffer.
+ *
+ * @return uint8_t The number of bytes received, 0 on NACK, timeout or uninitialized bus.
+ */
+uint8_t TwoWire::requestFrom( uint8_t address, uint8_t quantity )
+{
+  _rxLength = 0;
+  _rxIndex = 0;
+
+  if( !_initialized ) return 0;
+  if( quantity > BUFFER_LENGTH ) quantity = BUFFER_LENGTH;
+
+  _stats.transactions++;
+
+  if( busStuck() )
+  {
+    _stats.timeouts++;
+    _timeoutFlag = true;
+    PT7C4339SimClock::advance( _timeout > 0 ? _timeout : 1000000 );
+    return 0;
+  }
+
+  PT7C4339SimDevice *device = findDevice( address );
+
+  if( device == nullptr )
+  {
+    _stats.nacks++;
+    _stats.bytes += 1;
+    clockOut( 2 + 9 );
+    return 0;
+  }
+
+  _stats.bytes += 1 + quantity;
+  clockOut( 2 + 9 * ( 1 + quantity ) );
+
+  size_t received = device->i2cRead( _rxBuffer, quantity );
+  if( received == 0 ) _stats.nacks++;
+
+  _rxLength = static_cast<uint8_t>( received );
+  return _rxLength;
+}
+
+uint8_t TwoWire::requestFrom( int address, int quantity )
+{
+  return requestFrom( static_cast<uint8_t>( address ), static_cast<uint8_t>( quantity ) );
+}
+
+int TwoWire::available()
+{
+  return _rxLength - _rxIndex;
+}
+
+int TwoWire::read()
+{
+  if( _rxIndex >= _rxLength ) return -1;
+
+  return _rxBuffer[_rxIndex++];
+}
+
+int TwoWire::peek()
+{
+  if( _rxIndex >= _rxLength ) return -1;
+
+  return _rxBuffer[_rxIndex];
+}
+
+/**
+ * @brief Connects a simulated device to the bus.
+ */
+void TwoWire::attachDevice( PT7C4339SimDevice *device )
+{
+  device->nextDevice = _devices;
+  _devices = device;
+}
+
+void TwoWire::detachDevice( PT7C4339SimDevice *device )
+{
+  PT7C4339SimDevice **link = &_devices;
+
+  while( *link != nullptr )
+  {
+    if( *link == device )
+    {
+      *link = device->nextDevice;
+      device->nextDevice = nullptr;
+      return;
+    }
+    link = &( *link )->nextDevice;
+  }
+}
+
+bool TwoWire::isInitialized()
+{
+  return _initialized;
+}
+
+uint32_t TwoWire::getClock()
+{
+  return _frequency;
+}
+
+uint32_t TwoWire::getWireTimeout()
+{
+  return _timeout;
+}
+
+PT7C4339SimBusStats TwoWire::getStats()
+{
+  return _stats;
+}
+
+void TwoWire::resetStats()
+{
+  _stats.transactions = 0;
+  _stats.bytes = 0;
+  _stats.nacks = 0;
+  _stats.timeouts = 0;
+  _stats.wireTimeNs = 0;
+}
+
+PT7C4339SimDevice *TwoWire::findDevice( uint8_t address )
+{
+  for( PT7C4339SimDevice *d = _devices; d != nullptr; d = d->nextDevice )
+  {
+    if( d->i2cMatches( address ) ) return d;
+  }
+
+  return nullptr;
+}
+
+bool TwoWire::busStuck()
+{
+  for( PT7C4339SimDevice *d = _devices; d != nullptr; d = d->nextDevice )
+  {
+    if( d->i2cHoldsSda() ) return true;
+  }
+
+  return false;
+}
+
+/**
+ * @brief Accounts for the time a transfer of the given number of SCL periods takes and advances the virtual clock.
+ */
+void TwoWire::clockOut( uint32_t bits )
+{
+  uint64_t ns = ( static_cast<uint64_t>( bits ) * 1000000000ULL ) / _frequency;
+
+  _stats.wireTimeNs += ns;
+  _pendingNs += ns;
+  PT7C4339SimClock::advance( _pendingNs / 1000 );
+  _pendingNs %= 1000;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file Wire.h
+ * @brief Host-side stand-in for the Arduino TwoWire (I2C) interface used by the PT7C4339 simulator.
+ *
+ * Transactions are routed to simulated devices attached with attachDevice(). Every transaction
+ * advances the virtual clock by the time it would take on the wire at the configured bus frequency,
+ * and is counted in a PT7C4339SimBusStats structure. The transmit/receive buffers are limited to
+ * BUFFER_LENGTH bytes, like on the AVR core.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#ifndef _PT7C4339_SIM_WIRE_H_
+#define _PT7C4339_SIM_WIRE_H_
+
+#include "Arduino.h"
+
+#ifndef BUFFER_LENGTH
+#define BUFFER_LENGTH 32 ///< Size of the TwoWire transmit/receive buffers, same as the AVR core
+#endif
+
+#define WIRE_HAS_TIMEOUT ///< The stand-in has setWireTimeout() and the timeout flag, like the AVR core
+
+/**
+ * @brief Interface of a device on the simulated I2C bus.
+ */
+class PT7C4339SimDevice
+{
+  public:
+    virtual ~PT7C4339SimDevice() {}
+
+    /**
+     * @brief Returns true if the device acknowledges the given 7bit address.
+     */
+    virtual bool i2cMatches( uint8_t address ) const = 0;
+
+    /**
+     * @brief Handles a write transaction addressed to the device.
+     *
+     * @return true if every byte was acknowledged, false to NACK the transaction.
+     */
+    virtual bool i2cWrite( const uint8_t *data, size_t length ) = 0;
+
+    /**
+     * @brief Handles a read transaction addressed to the device.
+     *
+     * @return The number of bytes returned, 0 to NACK the address.
+     */
+    virtual size_t i2cRead( uint8_t *data, size_t length ) = 0;
+
+    /**
+     * @brief Returns true while the device holds SDA low, which makes every transaction time out.
+     */
+    virtual bool i2cHoldsSda() const { return false; }
+
+    PT7C4339SimDevice *nextDevice = nullptr; ///< Intrusive list link, managed by TwoWire
+};
+
+/**
+ * @struct PT7C4339SimBusStats
+ * Traffic counters of a simulated I2C bus
+ */
+typedef struct
+{
+  uint32_t transactions; ///< Number of START ... STOP transactions
+  uint32_t bytes; ///< Number of bytes on the wire, including address bytes
+  uint32_t nacks; ///< Number of transactions that were not acknowledged
+  uint32_t timeouts; ///< Number of transactions that timed out on a stuck bus
+  uint64_t wireTimeNs; ///< Modelled time spent on the wire in nanoseconds
+} PT7C4339SimBusStats; ///< Traffic counters of a simulated I2C bus
+
+class TwoWire ///< Host-side stand-in for the Arduino TwoWire class
+{
+  public:
+    TwoWire();
+
+    void begin();
+    void begin( int sda, int scl );
+    void end();
+    void setClock( uint32_t frequency );
+    void setWireTimeout( uint32_t timeout = 25000, bool resetWithTimeout = false );
+    bool getWireTimeoutFlag();
+    void clearWireTimeoutFlag();
+
+    void beginTransmission( uint8_t address );
+    void beginTransmission( int address );
+    size_t write( uint8_t data );
+    size_t write( const uint8_t *data, size_t quantity );
+    uint8_t endTransmission( uint8_t sendStop = 1 );
+
+    uint8_t requestFrom( uint8_t address, uint8_t quantity );
+    uint8_t requestFrom( int address, int quantity );
+    int available();
+    int read();
+    int peek();
+
+    /* Simulator */
+    void attachDevice( PT7C4339SimDevice *device );
+    void detachDevice( PT7C4339SimDevice *device );
+
+    bool isInitialized();
+    uint32_t getClock();
+    uint32_t getWireTimeout();
+
+    PT7C4339SimBusStats getStats();
+    void resetStats();
+
+  private:
+    bool _initialized;
+    uint32_t _frequency;
+    uint32_t _timeout;
+    bool _timeoutFlag;
+
+    uint8_t _txAddress;
+    uint8_t _txBuffer[BUFFER_LENGTH];
+    uint8_t _txLength;
+    bool _txOverflow;
+
+    uint8_t _rxBuffer[BUFFER_LENGTH];
+    uint8_t _rxLength;
+    uint8_t _rxIndex;
+
+    PT7C4339SimDevice *_devices;
+    PT7C4339SimBusStats _stats;
+    uint64_t _pendingNs;
+
+    PT7C4339SimDevice *findDevice( uint8_t address );
+    bool busStuck();
+    void clockOut( uint32_t bits );
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,188 @@
+/**
+ * @file PT7C4339-LinuxTest.cpp
+ * @brief Host-side behaviour tests of the PT7C4339_LinuxBus policy, run against the PT7C4339 simulator.
+ *
+ * The RTC is reached through PT7C4339SimI2cDev::ioctl() in place of the ioctl() system call, with a temporary regular
+ * file as the device node, so every I2C_RDWR request is carried out on the simulated bus. Every case is run on a device
+ * put back into the same state before it. The failed checks are printed with their line, and the exit status is
+ * the number of failed cases.
+ *
+ * Build and run from the root of the repository, without the Arduino core:
+ *
+ *   g++ -std=gnu++11 -DPT7C4339_NO_WIRE -Iextras/simulator -Isrc extras/test/PT7C4339-LinuxTest.cpp \
+ *       extras/simulator/Arduino.cpp extras/simulator/Wire.cpp extras/simulator/PT7C4339-Simulator.cpp \
+ *       extras/simulator/PT7C4339-SimI2cDev.cpp -o pt7c4339-linux-test
+ *   ./pt7c4339-linux-test
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "PT7C4339-LinuxBus.h"
+#include "PT7C4339-Simulator.h"
+#include "PT7C4339-SimI2cDev.h"
+
+/**
+ * @brief Checks a condition, and fails the running case with the line of the check if it does not hold.
+ */
+#define CHECK( condition ) \
+  do \
+  { \
+    if( !( condition ) ) \
+    { \
+      printf( "    line %d: %s\n", __LINE__, #condition ); \
+      return false; \
+    } \
+  } while( 0 )
+
+/**
+ * @brief One test case, returning true if every check passed.
+ */
+typedef struct
+{
+  const char *name; ///< Name of the case
+  bool ( *run )(); ///< Runs the case on the prepared device
+} TestCase;
+
+static PT7C4339Simulator *sim;
+static PT7C4339_Linux *rtc;
+static char devicePath[] = "/tmp/pt7c4339-i2c-XXXXXX";
+
+/**
+ * @brief Opens the device node and reads every register once, and fails on a device node that does not exist.
+ */
+static bool testBegin()
+{
+  PT7C4339_Linux missing( "/nonexistent/i2c-9", PT7C4339SimI2cDev::ioctl );
+  CHECK( missing.begin() == 0 );
+  CHECK( missing.getBus().getFd() < 0 );
+
+  PT7C4339_Linux device( devicePath, PT7C4339SimI2cDev::ioctl );
+  CHECK( device.getBus().getFd() < 0 );
+  CHECK( device.begin() == 1 );
+  CHECK( device.getBus().getFd() >= 0 );
+
+  sim->setRegister( PT7C4339_REG_STATUS, 0x80 );
+  CHECK( device.begin() == 2 );
+  return true;
+}
+
+/**
+ * @brief Reads the date and time with a single ioctl, and writes it back with another.
+ */
+static bool testGetDateTime()
+{
+  PT7C4339SimI2cDev::resetCallCount();
+  PT7C4339_DateTime now = rtc->getDateTime();
+  CHECK( now.date.year == 2024 && now.date.month == 2 && now.date.day == 29 );
+  CHECK( now.time.hour == 12 && now.time.minute == 34 && now.time.second == 56 );
+  CHECK( PT7C4339SimI2cDev::getCallCount() == 1 );
+
+  rtc->setVerifyPolicy( PT7C4339_VERIFY_NEVER );
+  PT7C4339SimI2cDev::resetCallCount();
+  CHECK( rtc->setDateTime( { { 2031, 7, 8, PT7C4339_WEEKDAY_UNKNOWN }, { 9, 10, 11 } } ) );
+  CHECK( PT7C4339SimI2cDev::getCallCount() == 1 );
+  CHECK( sim->getRegister( PT7C4339_REG_YEARS ) == 0x31 && sim->getRegister( PT7C4339_REG_SECONDS ) == 0x11 );
+  return true;
+}
+
+/**
+ * @brief Reports a NACK of the device (EREMOTEIO) as PT7C4339_STATUS_NACK, and works again afterwards.
+ */
+static bool testNack()
+{
+  sim->failNextTransactions( 1 );
+  CHECK( rtc->getDateTime().date.year == 0 );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_NACK );
+
+  CHECK( rtc->getDateTime().date.year == 2024 );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_OK );
+
+  rtc->setRetryBudget( 1 );
+  sim->failNextTransactions( 1 );
+  CHECK( rtc->getDateTime().date.year == 2024 );
+  return true;
+}
+
+/**
+ * @brief Reports a stuck bus (ETIMEDOUT) as PT7C4339_STATUS_TIMEOUT, reopens the device node, and works again afterwards.
+ */
+static bool testTimeout()
+{
+  int fd = rtc->getBus().getFd();
+
+  sim->holdSda( true );
+  CHECK( rtc->getDateTime().date.year == 0 );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_TIMEOUT );
+  CHECK( rtc->getBus().getFd() >= 0 );
+
+  sim->holdSda( false );
+  CHECK( rtc->getDateTime().date.year == 2024 );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_OK );
+  CHECK( rtc->getBus().getFd() == fd ); // Reopened, the lowest free descriptor is the one just closed
+  return true;
+}
+
+static const TestCase cases[] =
+{
+  { "begin", testBegin },
+  { "getDateTime", testGetDateTime },
+  { "nack", testNack },
+  { "timeout", testTimeout },
+};
+
+/**
+ * @brief Runs one case on a device put back into the same state before it.
+ */
+static bool runCase( const TestCase &test )
+{
+  sim->powerOn();
+  sim->failNextTransactions( 0 );
+  sim->holdSda( false );
+  sim->setDateTime( 2024, 2, 29, 12, 34, 56 );
+  sim->setRegister( PT7C4339_REG_STATUS, 0x00 );
+
+  PT7C4339_Linux device( devicePath, PT7C4339SimI2cDev::ioctl );
+  rtc = &device;
+
+  if( device.begin() == 0 ) return false;
+
+  bool passed = test.run();
+
+  rtc = nullptr;
+  return passed;
+}
+
+int main()
+{
+  int node = mkstemp( devicePath );
+  if( node < 0 ) return 1;
+  close( node );
+
+  PT7C4339Simulator device;
+  sim = &device;
+
+  int failed = 0;
+  int total = 0;
+
+  for( const TestCase &test : cases )
+  {
+    total++;
+    printf( "%s\n", test.name );
+
+    if( !runCase( test ) )
+    {
+      printf( "  FAILED\n" );
+      failed++;
+    }
+  }
+
+  unlink( devicePath );
+  printf( "%d of %d cases passed\n", total - failed, total );
+
+  return failed;
+}
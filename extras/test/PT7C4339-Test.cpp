@@ -0,0 +1,1132 @@
+/**
+ * @file PT7C4339-Test.cpp
+ * @brief Host-side behaviour tests of the PT7C4339-RTC library, run against the PT7C4339 simulator.
+ *
+ * Every case is run with the default configuration, with the register cache enabled, with the cache and deferred
+ * write verification, and without write verification, on a device put back into the same state before every case.
+ * A case checks the return values of the calls it makes and the registers of the simulated device they leave behind.
+ * The failed checks are printed with their line, and the exit status is the number of failed cases.
+ *
+ * Build and run from the root of the repository:
+ *
+ *   g++ -std=gnu++11 -Iextras/simulator -Isrc extras/test/PT7C4339-Test.cpp src/PT7C4339-RTC.cpp src/PT7C4339-WireBus.cpp \
+ *       extras/simulator/Arduino.cpp extras/simulator/Wire.cpp extras/simulator/PT7C4339-Simulator.cpp \
+ *       extras/simulator/PT7C4339-SimMux.cpp -o pt7c4339-test
+ *   ./pt7c4339-test
+ *
+ * Add -DPT7C4339_ENABLE_STATS to also run the case of the per-method bus statistics.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "PT7C4339-RTC.h"
+#include "PT7C4339-AlarmScheduler.h"
+#include "PT7C4339-CronSchedule.h"
+#include "PT7C4339-DriftEstimator.h"
+#include "PT7C4339-EventCapture.h"
+#include "PT7C4339-Simulator.h"
+#include "PT7C4339-SimMux.h"
+
+#define TEST_FLEET_SIZE 4 ///< Number of RTCs behind the multiplexer of the fleet case, one per channel
+#define TEST_POLL_LIMIT 100 ///< Largest number of poll() calls a non-blocking operation may take
+#define TEST_SQW_PIN 4 ///< Simulated pin connected to the INT/SQW output in the software clock case
+
+/**
+ * @brief Checks a condition, and fails the running case with the line of the check if it does not hold.
+ */
+#define CHECK( condition ) \
+  do \
+  { \
+    if( !( condition ) ) \
+    { \
+      printf( "    line %d: %s\n", __LINE__, #condition ); \
+      return false; \
+    } \
+  } while( 0 )
+
+/**
+ * @brief One test case, returning true if every check passed.
+ */
+typedef struct
+{
+  const char *name; ///< Name of the case
+  bool ( *run )(); ///< Runs the case on the prepared device
+} TestCase;
+
+/**
+ * @brief One configuration of the RTC object the cases are run with.
+ */
+typedef struct
+{
+  const char *name; ///< Name of the configuration in the output
+  bool registerCache; ///< Register cache enabled
+  PT7C4339_verifyPolicy verifyPolicy; ///< Write verification policy
+} TestConfig;
+
+static PT7C4339Simulator *sim;
+static PT7C4339 *rtc;
+
+static PT7C4339SimMux *simMux;
+static PT7C4339Simulator *fleetDevices;
+static PT7C4339_Mux fleetMux( &Wire );
+static PT7C4339 *fleet[TEST_FLEET_SIZE];
+
+static const PT7C4339_Time sampleTime = { 12, 34, 56 };
+static const PT7C4339_Date sampleDate = { 2024, 2, 29, PT7C4339_WEEKDAY_UNKNOWN };
+static const PT7C4339_DateTime sampleDateTime = { sampleDate, sampleTime };
+static const PT7C4339_Alarm1Config sampleAlarm1 = { PT7C4339_A1_HOURS_MINUTES_SECONDS_MATCH, sampleTime, sampleDate };
+static const PT7C4339_Alarm2Config sampleAlarm2 = { PT7C4339_A2_HOURS_MINUTES_MATCH, sampleTime, sampleDate };
+
+static uint8_t alarm1Calls;
+static uint8_t alarm2Calls;
+static uint8_t scheduledCalls;
+
+/**
+ * @brief Alarm 1 callback counting its calls.
+ */
+static void countAlarm1()
+{
+  alarm1Calls++;
+}
+
+/**
+ * @brief Alarm 2 callback counting its calls.
+ */
+static void countAlarm2()
+{
+  alarm2Calls++;
+}
+
+/**
+ * @brief Scheduled alarm callback counting its calls.
+ */
+static void countScheduled( uint8_t )
+{
+  scheduledCalls++;
+}
+
+/**
+ * @brief Scheduled alarm callback counting its calls and taking 15 seconds of simulated time.
+ */
+static void slowScheduled( uint8_t )
+{
+  scheduledCalls++;
+  sim->advanceSeconds( 15 );
+}
+
+/**
+ * @brief SQW falling edge interrupt of the software clock case.
+ */
+static void sqwEdge()
+{
+  rtc->handleSqwEdge();
+}
+
+/**
+ * @brief Converts an event resolved by PT7C4339_EventCapture to microseconds since 1970-01-01.
+ */
+static uint64_t eventMicros( PT7C4339_Event event )
+{
+  return static_cast<uint64_t>( event.epoch ) * 1000000ULL + event.microsecond;
+}
+
+/**
+ * @brief Converts a timestamp of the software clock to microseconds since 1970-01-01, so two of them can be compared.
+ */
+static uint64_t timestampMicros( PT7C4339_Timestamp timestamp )
+{
+  return static_cast<uint64_t>( PT7C4339_dateTimeToEpoch( timestamp.dateTime ) ) * 1000000ULL + timestamp.microsecond;
+}
+
+/**
+ * @brief Waits in steps of 1ms, calling serviceSoftClock() after each, until the software clock is synced.
+ *
+ * @return bool True if it synced within three seconds.
+ */
+static bool waitForSoftClockSync()
+{
+  for( uint16_t i = 0; i < 3000; i++ )
+  {
+    delay( 1 );
+    rtc->serviceSoftClock();
+    if( rtc->isSoftClockSynced() ) return true;
+  }
+
+  return false;
+}
+
+/**
+ * @brief Checks if two dates and times are equal, ignoring the weekday.
+ */
+static bool sameDateTime( PT7C4339_DateTime a, PT7C4339_DateTime b )
+{
+  return a.date.year == b.date.year && a.date.month == b.date.month && a.date.day == b.date.day &&
+         a.time.hour == b.time.hour && a.time.minute == b.time.minute && a.time.second == b.time.second;
+}
+
+/**
+ * @brief Calls poll() until the running non-blocking operation finished.
+ *
+ * @return PT7C4339_asyncStatus The final status, PT7C4339_ASYNC_BUSY if it did not finish within TEST_POLL_LIMIT calls.
+ */
+static PT7C4339_asyncStatus pollUntilDone()
+{
+  PT7C4339_asyncStatus status = PT7C4339_ASYNC_BUSY;
+
+  for( uint8_t i = 0; i < TEST_POLL_LIMIT && status == PT7C4339_ASYNC_BUSY; i++ )
+  {
+    delayMicroseconds( 100 );
+    status = rtc->poll();
+  }
+
+  return status;
+}
+
+/**
+ * @brief Configures both alarms, the square wave and the trickle charger.
+ */
+static bool configureSample()
+{
+  return rtc->setAlarm1( sampleAlarm1 ) && rtc->setAlarm2( sampleAlarm2 ) && rtc->setSqwFrequency( PT7C4339_SQW_8_192KHZ ) &&
+         rtc->setTrickleChargerConfig( PT7C4339_TRICKLE_ENABLE, PT7C4339_DIODE_DISABLE, PT7C4339_RESISTOR_2K );
+}
+
+/**
+ * @brief Sets the date and time and reads it back, including the weekday set by setDateTime(), and converts dates
+ * and times to epochs and to differences across the whole range of the device.
+ */
+static bool testDateTimeRoundTrip()
+{
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+
+  PT7C4339_DateTime now = rtc->getDateTime();
+  CHECK( sameDateTime( now, sampleDateTime ) );
+  CHECK( now.date.weekDay == PT7C4339_THURSDAY );
+  CHECK( rtc->getEpoch() == PT7C4339_dateTimeToEpoch( sampleDateTime ) );
+
+  static const PT7C4339_DateTime first = { { 1900, 1, 1, PT7C4339_WEEKDAY_UNKNOWN }, { 0, 0, 0 } };
+  static const PT7C4339_DateTime last = { { 2099, 12, 31, PT7C4339_WEEKDAY_UNKNOWN }, { 23, 59, 59 } };
+  CHECK( PT7C4339_diffSeconds( first, last ) == 6311433599LL );
+  CHECK( PT7C4339_diffSeconds( last, first ) == -6311433599LL );
+  CHECK( PT7C4339_diffDays( first.date, last.date ) == 73048 );
+
+  CHECK( rtc->setEpoch( 946684799UL ) ); // 1999-12-31 23:59:59
+  CHECK( rtc->getYear() == 1999 && rtc->getMonth() == 12 && rtc->getDay() == 31 );
+  return true;
+}
+
+/**
+ * @brief Lets the device run across the turn of the century, which toggles the century bit of the month register.
+ */
+static bool testCenturyRollover()
+{
+  CHECK( rtc->setDateTime( { { 1999, 12, 31, PT7C4339_WEEKDAY_UNKNOWN }, { 23, 59, 59 } } ) );
+  CHECK( ( sim->getRegister( PT7C4339_REG_MONTHS ) & 0x80 ) == 0 );
+
+  sim->advanceSeconds( 1 );
+
+  PT7C4339_DateTime now = rtc->getDateTime();
+  CHECK( sameDateTime( now, { { 2000, 1, 1, PT7C4339_WEEKDAY_UNKNOWN }, { 0, 0, 0 } } ) );
+  CHECK( now.date.weekDay == PT7C4339_SATURDAY );
+  CHECK( sim->getRegister( PT7C4339_REG_MONTHS ) & 0x80 );
+  return true;
+}
+
+/**
+ * @brief Rejects dates and times out of range without writing them.
+ */
+static bool testInvalidDateTime()
+{
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+
+  CHECK( !rtc->setDateTime( { { 2023, 2, 29, PT7C4339_WEEKDAY_UNKNOWN }, sampleTime } ) );
+  CHECK( !rtc->setDateTime( { { 2024, 13, 1, PT7C4339_WEEKDAY_UNKNOWN }, sampleTime } ) );
+  CHECK( !rtc->setDateTime( { { 2100, 1, 1, PT7C4339_WEEKDAY_UNKNOWN }, sampleTime } ) );
+  CHECK( !rtc->setTime( { 24, 0, 0 } ) );
+  CHECK( !rtc->setMinute( 60 ) );
+
+  CHECK( sameDateTime( rtc->getDateTime(), sampleDateTime ) );
+  return true;
+}
+
+/**
+ * @brief Range-checks only the registers getTime() and getDate() return, and repairs an invalid weekday.
+ */
+static bool testInvalidRegisters()
+{
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+
+  sim->setRegister( PT7C4339_REG_DAYS_OF_WEEK, 0x00 );
+  PT7C4339_Time time = rtc->getTime();
+  CHECK( time.hour == sampleTime.hour && time.minute == sampleTime.minute && time.second == sampleTime.second );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_OK );
+  CHECK( rtc->getDate().month == 0 );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_BCD_RANGE );
+  CHECK( rtc->getDateTime().date.year == 0 && rtc->getDateTime().time.hour == 0 );
+
+  CHECK( rtc->setCorrectWeekDay() );
+  CHECK( sim->getRegister( PT7C4339_REG_DAYS_OF_WEEK ) == PT7C4339_THURSDAY );
+  sim->setRegister( PT7C4339_REG_SECONDS, 0x7A );
+  PT7C4339_Date date = rtc->getDate();
+  CHECK( date.year == sampleDate.year && date.month == sampleDate.month && date.day == sampleDate.day );
+  CHECK( rtc->getTime().hour == 0 );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_BCD_RANGE );
+  return true;
+}
+
+/**
+ * @brief Refuses to write a date the single field setters could not read, or that does not exist after the change.
+ */
+static bool testDateFieldSetters()
+{
+  CHECK( rtc->setDateTime( { { 2024, 1, 31, PT7C4339_WEEKDAY_UNKNOWN }, sampleTime } ) );
+  PT7C4339_DateTime stored = rtc->getDateTime();
+
+  sim->failNextTransactions( 1 );
+  CHECK( !rtc->setMonth( 7 ) );
+  sim->failNextTransactions( 1 );
+  CHECK( !rtc->setYear( 2030 ) );
+  sim->failNextTransactions( 1 );
+  CHECK( !rtc->setDay( 15 ) );
+  sim->failNextTransactions( 1 );
+  CHECK( !rtc->setCorrectWeekDay() );
+  CHECK( !rtc->setMonth( 2 ) );
+  CHECK( sameDateTime( rtc->getDateTime(), stored ) );
+  CHECK( sim->getRegister( PT7C4339_REG_DAYS_OF_WEEK ) == PT7C4339_WEDNESDAY );
+
+  CHECK( rtc->setDay( 29 ) );
+  CHECK( rtc->setMonth( 2 ) );
+  CHECK( !rtc->setYear( 2023 ) );
+  CHECK( rtc->setYear( 2028 ) );
+  CHECK( rtc->getDate().year == 2028 && rtc->getDate().month == 2 && rtc->getDate().day == 29 );
+  CHECK( sim->getRegister( PT7C4339_REG_DAYS_OF_WEEK ) == PT7C4339_TUESDAY );
+  return true;
+}
+
+/**
+ * @brief Reports a NACK as a failure with its status, retries it within the retry budget, and works again afterwards.
+ */
+static bool testBusErrors()
+{
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+
+  sim->failNextTransactions( 1 );
+  CHECK( !rtc->setTime( { 1, 2, 3 } ) );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_NACK );
+  CHECK( sameDateTime( rtc->getDateTime(), sampleDateTime ) );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_OK );
+
+  sim->failNextTransactions( 2 );
+  CHECK( rtc->getDateTime().date.year == 0 );
+  CHECK( rtc->getEpoch() == 0 );
+  sim->failNextTransactions( 1 );
+  CHECK( rtc->getYear() == 0 );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_NACK );
+  Wire.resetStats();
+  CHECK( rtc->getYear() == sampleDate.year );
+  CHECK( Wire.getStats().transactions == 2 ); // Year and century in one burst read
+
+  rtc->setRetryBudget( 1 );
+  sim->failNextTransactions( 1 );
+  CHECK( rtc->setTime( { 1, 2, 3 } ) );
+  CHECK( sim->getRegister( PT7C4339_REG_HOURS ) == 0x01 && sim->getRegister( PT7C4339_REG_MINUTES ) == 0x02 );
+  return true;
+}
+
+/**
+ * @brief Reports a slave holding SDA low as a timeout, frees the bus by clocking SCL, and works again afterwards.
+ */
+static bool testBusRecovery()
+{
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+
+  sim->holdSda( true );
+  sim->releaseSdaAfterClocks( PT7C4339_BUS_CLEAR_CLOCKS + 1, SCL );
+  CHECK( rtc->getDateTime().date.year == 0 );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_TIMEOUT );
+  CHECK( rtc->recoverBus() );
+  CHECK( sameDateTime( rtc->getDateTime(), sampleDateTime ) );
+
+  sim->holdSda( true );
+  sim->releaseSdaAfterClocks( 3, SCL );
+  CHECK( rtc->getDateTime().date.year == 0 );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_TIMEOUT );
+  CHECK( sameDateTime( rtc->getDateTime(), sampleDateTime ) );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_OK );
+
+  rtc->setRetryBudget( 1 );
+  sim->holdSda( true );
+  sim->releaseSdaAfterClocks( 9, SCL );
+  CHECK( rtc->setTime( { 1, 2, 3 } ) );
+  CHECK( sim->getRegister( PT7C4339_REG_HOURS ) == 0x01 );
+  return true;
+}
+
+/**
+ * @brief Reads writes back immediately, never, or together in verifyPendingWrites(), which reports the first mismatch.
+ */
+static bool testVerifyPolicy()
+{
+  rtc->setVerifyPolicy( PT7C4339_VERIFY_ALWAYS );
+  Wire.resetStats();
+  CHECK( rtc->setAlarm1( sampleAlarm1 ) );
+  CHECK( Wire.getStats().transactions == 3 );
+
+  rtc->setVerifyPolicy( PT7C4339_VERIFY_NEVER );
+  Wire.resetStats();
+  CHECK( rtc->setAlarm2( sampleAlarm2 ) );
+  CHECK( Wire.getStats().transactions == 1 );
+
+  rtc->setVerifyPolicy( PT7C4339_VERIFY_DEFERRED );
+  Wire.resetStats();
+  CHECK( rtc->setAlarm1( sampleAlarm1 ) );
+  CHECK( rtc->setAlarm2( sampleAlarm2 ) );
+  CHECK( Wire.getStats().transactions == 2 );
+  CHECK( rtc->setTime( sampleTime ) ); // The timekeeping registers change by themselves, they are read back at once
+  CHECK( Wire.getStats().transactions == 5 );
+
+  uint8_t mismatch = 0;
+  Wire.resetStats();
+  CHECK( rtc->verifyPendingWrites( &mismatch ) );
+  CHECK( mismatch == PT7C4339_REG_NONE );
+  CHECK( Wire.getStats().transactions == 2 );
+
+  CHECK( rtc->setAlarm1( sampleAlarm1 ) );
+  CHECK( rtc->setAlarm2( sampleAlarm2 ) );
+  sim->setRegister( PT7C4339_REG_A2_HOURS, 0x05 );
+  sim->setRegister( PT7C4339_REG_A1_MINUTES, 0x59 );
+  CHECK( !rtc->verifyPendingWrites( &mismatch ) );
+  CHECK( mismatch == PT7C4339_REG_A1_MINUTES );
+  CHECK( rtc->getLastStatus() == PT7C4339_STATUS_VERIFY_MISMATCH );
+
+  CHECK( rtc->verifyPendingWrites( &mismatch ) );
+  CHECK( mismatch == PT7C4339_REG_NONE );
+  return true;
+}
+
+/**
+ * @brief Makes the next bus access of a setter fail: the read of the register, or the write with the register cache,
+ * which is refilled first as a failed write invalidates it.
+ */
+static void failNextAccess()
+{
+  if( rtc->isRegisterCacheEnabled() ) rtc->refreshRegisterCache();
+  sim->failNextTransactions( 1 );
+}
+
+/**
+ * @brief Fails the read-modify-write setters on a NACK without touching the other bits of their register.
+ */
+static bool testReadModifyWriteErrors()
+{
+  static const uint8_t control = 0x1C; // INTCN, RS2 and RS1 set, both alarm interrupts disabled
+
+  sim->setRegister( PT7C4339_REG_CONTROL, control );
+
+  failNextAccess();
+  CHECK( !rtc->enableA1Int( true ) );
+  failNextAccess();
+  CHECK( !rtc->enableA2Int( true ) );
+  failNextAccess();
+  CHECK( !rtc->enableOscillator( false ) );
+  failNextAccess();
+  CHECK( !rtc->enableIntFromBattery( true ) );
+  failNextAccess();
+  CHECK( !rtc->setIntOrSqwFlag( false ) );
+  failNextAccess();
+  CHECK( !rtc->setSqwFrequency( PT7C4339_SQW_1HZ ) );
+  CHECK( sim->getRegister( PT7C4339_REG_CONTROL ) == control );
+
+  sim->setRegister( PT7C4339_REG_A1_DAY_DATE, 0x80 );
+  failNextAccess();
+  CHECK( !rtc->setA1DayDate( { 0, 0, 15, PT7C4339_WEEKDAY_UNKNOWN } ) );
+  CHECK( sim->getRegister( PT7C4339_REG_A1_DAY_DATE ) == 0x80 );
+  CHECK( rtc->setA1DayDate( { 0, 0, 15, PT7C4339_WEEKDAY_UNKNOWN } ) );
+  CHECK( sim->getRegister( PT7C4339_REG_A1_DAY_DATE ) == 0x95 );
+
+  CHECK( rtc->enableA1Int( true ) );
+  CHECK( sim->getRegister( PT7C4339_REG_CONTROL ) == ( control | 0x01 ) );
+  return true;
+}
+
+/**
+ * @brief Restores a saved configuration after the device lost power, also staged with beginUpdate(), and rejects a corrupted
+ * one or one that can not be staged while a non-blocking operation is in progress.
+ */
+static bool testApplyConfig()
+{
+  CHECK( configureSample() );
+
+  PT7C4339_Config config = rtc->saveConfig();
+  uint8_t control = sim->getRegister( PT7C4339_REG_CONTROL );
+  uint8_t trickle = sim->getRegister( PT7C4339_REG_TRICKLE_CHARGER );
+
+  PT7C4339_Config corrupted = config;
+  corrupted.registers[0] ^= 0x01;
+  CHECK( !rtc->applyConfig( corrupted ) );
+
+  CHECK( rtc->reset() );
+  CHECK( rtc->startSetAlarm1( sampleAlarm1 ) );
+  rtc->beginUpdate();
+  CHECK( !rtc->applyConfig( config ) ); // Nothing can be staged while the operation holds its data in the register image
+  rtc->cancelUpdate();
+  CHECK( pollUntilDone() == PT7C4339_ASYNC_DONE );
+  CHECK( sim->getRegister( PT7C4339_REG_TRICKLE_CHARGER ) != trickle );
+
+  rtc->beginUpdate();
+  CHECK( rtc->applyConfig( config ) );
+  CHECK( rtc->commit() );
+  CHECK( sim->getRegister( PT7C4339_REG_CONTROL ) == control );
+  CHECK( sim->getRegister( PT7C4339_REG_TRICKLE_CHARGER ) == trickle );
+
+  CHECK( rtc->reset() );
+  CHECK( rtc->applyConfig( config ) );
+  CHECK( sim->getRegister( PT7C4339_REG_CONTROL ) == control );
+  CHECK( sim->getRegister( PT7C4339_REG_TRICKLE_CHARGER ) == trickle );
+  CHECK( rtc->getAlarm1().time.second == sampleTime.second );
+  return true;
+}
+
+/**
+ * @brief Restores a saved configuration after a power loss the RTC object did not see, so its register cache is stale.
+ */
+static bool testApplyConfigAfterPowerLoss()
+{
+  CHECK( configureSample() );
+
+  PT7C4339_Config config = rtc->saveConfig();
+  uint8_t image[PT7C4339_CONFIG_SIZE];
+  for( uint8_t i = 0; i < PT7C4339_CONFIG_SIZE; i++ ) image[i] = sim->getRegister( PT7C4339_CONFIG_FIRST_REG + i );
+
+  sim->powerOn();
+  CHECK( sim->getRegister( PT7C4339_REG_CONTROL ) != image[PT7C4339_REG_CONTROL - PT7C4339_CONFIG_FIRST_REG] );
+
+  CHECK( rtc->applyConfig( config ) );
+
+  for( uint8_t i = 0; i < PT7C4339_CONFIG_SIZE; i++ )
+  {
+    if( PT7C4339_CONFIG_FIRST_REG + i != PT7C4339_REG_STATUS ) CHECK( sim->getRegister( PT7C4339_CONFIG_FIRST_REG + i ) == image[i] );
+  }
+
+  CHECK( rtc->getSqwFrequency() == PT7C4339_SQW_8_192KHZ );
+  CHECK( rtc->getRtcStopFlag() );
+  return true;
+}
+
+/**
+ * @brief Clears status flags with one write that is never read back, without losing the ones the device sets
+ * before commit(), also with several staged clears.
+ */
+static bool testStagedFlagClears()
+{
+  sim->setRegister( PT7C4339_REG_STATUS, 0x03 );
+  Wire.resetStats();
+  CHECK( rtc->clearA1Flag() );
+  CHECK( Wire.getStats().transactions == 1 ); // Not read back, A1F may already be set again
+  CHECK( sim->getRegister( PT7C4339_REG_STATUS ) == 0x02 );
+  Wire.resetStats();
+  CHECK( rtc->verifyPendingWrites() );
+  CHECK( Wire.getStats().transactions == 0 );
+
+  sim->setRegister( PT7C4339_REG_STATUS, 0x00 );
+  rtc->beginUpdate();
+  CHECK( rtc->clearA1Flag() );
+  sim->setRegister( PT7C4339_REG_STATUS, 0x82 );
+  CHECK( rtc->getA2Flag() && rtc->getRtcStopFlag() && !rtc->getA1Flag() );
+  CHECK( rtc->commit() );
+  CHECK( sim->getRegister( PT7C4339_REG_STATUS ) == 0x82 );
+
+  sim->setRegister( PT7C4339_REG_STATUS, 0x83 );
+  rtc->beginUpdate();
+  CHECK( rtc->clearA1Flag() );
+  CHECK( rtc->clearRtcStopFlag() );
+  CHECK( rtc->enableA2Int( true ) );
+  CHECK( rtc->commit() );
+  CHECK( sim->getRegister( PT7C4339_REG_STATUS ) == 0x02 );
+  CHECK( sim->getRegister( PT7C4339_REG_CONTROL ) & 0x02 );
+  return true;
+}
+
+/**
+ * @brief Puts every register back to its power-on default.
+ */
+static bool testReset()
+{
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+  CHECK( configureSample() );
+
+  CHECK( rtc->reset() );
+
+  static const uint8_t expected[PT7C4339_REGISTER_COUNT] =
+  {
+    0x00, 0x00, 0x00, 0x01, 0x01, 0x81, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00,
+    0x18, 0x00, 0x00
+  };
+
+  for( uint8_t reg = 0; reg < PT7C4339_REGISTER_COUNT; reg++ )
+  {
+    if( reg != PT7C4339_REG_STATUS ) CHECK( sim->getRegister( reg ) == expected[reg] );
+  }
+
+  CHECK( rtc->getYear() == 2000 && rtc->getMonth() == 1 && rtc->getDay() == 1 );
+  return true;
+}
+
+/**
+ * @brief Resumes from a saved state without any I2C traffic, restores the register cache from it,
+ * and falls back to begin() on a state with a bad magic or checksum.
+ */
+static bool testResume()
+{
+  CHECK( configureSample() );
+  CHECK( rtc->enableRegisterCache( true ) );
+  PT7C4339_ResumeState state = rtc->getResumeState();
+  CHECK( state.flags == ( PT7C4339_RESUME_MAGIC | PT7C4339_RESUME_CACHE_VALID ) );
+
+  PT7C4339 woken( &Wire );
+  Wire.resetStats();
+  CHECK( woken.resume( state ) == 1 );
+  CHECK( woken.isRegisterCacheEnabled() );
+  CHECK( woken.getSqwFrequency() == PT7C4339_SQW_8_192KHZ );
+  CHECK( woken.getAlarm1().time.minute == sampleTime.minute );
+  CHECK( Wire.getStats().transactions == 0 );
+  CHECK( sameDateTime( woken.getDateTime(), sampleDateTime ) );
+
+  PT7C4339 uncached( &Wire );
+  state = uncached.getResumeState();
+  CHECK( state.flags == PT7C4339_RESUME_MAGIC );
+  Wire.resetStats();
+  CHECK( uncached.resume( state ) == 1 );
+  CHECK( !uncached.isRegisterCacheEnabled() );
+  CHECK( Wire.getStats().transactions == 0 );
+
+  sim->setRegister( PT7C4339_REG_STATUS, 0x80 );
+
+  PT7C4339_ResumeState badMagic = rtc->getResumeState();
+  badMagic.flags = 0x51;
+  PT7C4339 coldMagic( &Wire );
+  Wire.resetStats();
+  CHECK( coldMagic.resume( badMagic ) == 2 );
+  CHECK( Wire.getStats().transactions > 0 );
+
+  PT7C4339_ResumeState badChecksum = rtc->getResumeState();
+  badChecksum.cache.registers[0] ^= 0x01;
+  PT7C4339 coldChecksum( &Wire );
+  Wire.resetStats();
+  CHECK( coldChecksum.resume( badChecksum ) == 2 );
+  CHECK( Wire.getStats().transactions > 0 );
+  CHECK( !coldChecksum.isRegisterCacheEnabled() );
+  return true;
+}
+
+/**
+ * @brief Syncs the software clock on the SQW edges, keeps now() monotonic across edges and resyncs,
+ * and drops the sync when the timekeeping registers are written.
+ */
+static bool testSoftClock()
+{
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+
+  sim->connectIntPin( TEST_SQW_PIN );
+  pinMode( TEST_SQW_PIN, INPUT_PULLUP );
+  attachInterrupt( digitalPinToInterrupt( TEST_SQW_PIN ), sqwEdge, FALLING );
+
+  CHECK( rtc->beginSoftClock( 5 ) );
+  CHECK( !rtc->isSoftClockSynced() );
+  CHECK( rtc->now().dateTime.date.year == 0 );
+  CHECK( waitForSoftClockSync() );
+
+  PT7C4339_Timestamp previous = rtc->now();
+  CHECK( previous.dateTime.date.year == sampleDate.year );
+
+  Wire.resetStats();
+  for( uint16_t i = 0; i < 12000; i++ )
+  {
+    delay( 1 );
+    rtc->serviceSoftClock();
+
+    PT7C4339_Timestamp current = rtc->now();
+    CHECK( timestampMicros( current ) >= timestampMicros( previous ) );
+    previous = current;
+  }
+  CHECK( rtc->isSoftClockSynced() );
+  CHECK( Wire.getStats().transactions <= 6 ); // A resync every fifth edge, two transactions each
+
+  uint32_t device = PT7C4339_dateTimeToEpoch( rtc->getDateTime() );
+  uint32_t soft = PT7C4339_dateTimeToEpoch( rtc->now().dateTime );
+  CHECK( device - soft <= 1 );
+
+  CHECK( rtc->setTime( { 1, 2, 3 } ) );
+  CHECK( !rtc->isSoftClockSynced() );
+  CHECK( waitForSoftClockSync() );
+  CHECK( rtc->now().dateTime.time.hour == 1 && rtc->now().dateTime.time.minute == 2 );
+  return true;
+}
+
+/**
+ * @brief Resolves captured events in order and at their exact distances with one time read per batch,
+ * on both sides of the anchor, keeps them on a failed read, and drops the ones that do not fit.
+ */
+static bool testEventCapture()
+{
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+
+  PT7C4339_EventCapture<4, PT7C4339> events( rtc );
+  PT7C4339_Event batch[4];
+
+  CHECK( events.capture( 1 ) );
+  delay( 250 );
+  CHECK( events.capture( 2 ) );
+  delay( 2000 );
+  CHECK( events.capture( 3 ) );
+  CHECK( events.push( 4, micros() + 1700000UL ) ); // Timestamped by a capture unit after the anchor is read
+  CHECK( !events.capture( 5 ) );
+  CHECK( events.getDropped() == 1 && events.available() == 4 );
+
+  sim->failNextTransactions( 1 );
+  CHECK( events.resolve( batch, 4 ) == 0 );
+  CHECK( events.available() == 4 );
+
+  uint32_t device = PT7C4339_dateTimeToEpoch( rtc->getDateTime() );
+  Wire.resetStats();
+  CHECK( events.resolve( batch, 4 ) == 4 );
+  CHECK( Wire.getStats().transactions == 2 );
+  CHECK( events.available() == 0 );
+
+  for( uint8_t i = 0; i < 4; i++ ) CHECK( batch[i].id == i + 1 && batch[i].microsecond < 1000000UL );
+  CHECK( eventMicros( batch[1] ) - eventMicros( batch[0] ) == 250000ULL );
+  CHECK( eventMicros( batch[2] ) - eventMicros( batch[1] ) == 2000000ULL );
+  CHECK( eventMicros( batch[3] ) - eventMicros( batch[2] ) >= 1700000ULL );
+  CHECK( eventMicros( batch[3] ) - eventMicros( batch[2] ) < 1800000ULL );
+  CHECK( batch[2].epoch - device <= 1 );
+
+  CHECK( events.capture( 6 ) );
+  CHECK( events.capture( 7 ) );
+  CHECK( events.resolve( batch, 1 ) == 1 && batch[0].id == 6 );
+  CHECK( events.resolve( batch, 4 ) == 1 && batch[0].id == 7 );
+  return true;
+}
+
+/**
+ * @brief Fits the frequency error of a drifting crystal from samples against the virtual clock, and steps the seconds
+ * register towards the reference without changing the corrected time.
+ */
+static bool testDriftEstimator()
+{
+  static const int32_t driftPpb = 20000; // 20 ppm fast, 1.7s per day
+
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+  sim->setDriftPpb( driftPpb );
+
+  PT7C4339_DriftEstimator<PT7C4339> drift( rtc );
+  uint32_t startEpoch = PT7C4339_dateTimeToEpoch( sampleDateTime );
+  uint64_t startMicros = PT7C4339SimClock::now();
+
+  for( uint16_t sample = 0; sample <= 288; sample++ ) // Every 10 minutes for two days
+  {
+    uint64_t elapsed = PT7C4339SimClock::now() - startMicros;
+    CHECK( drift.addSample( startEpoch + static_cast<uint32_t>( elapsed / 1000000 ), static_cast<uint32_t>( elapsed % 1000000 ) ) );
+    sim->advanceSeconds( 600 );
+  }
+
+  CHECK( drift.sampleCount() == 289 );
+  CHECK( drift.getDriftPpb() > driftPpb - 1000 && drift.getDriftPpb() < driftPpb + 1000 );
+
+  uint64_t elapsed = PT7C4339SimClock::now() - startMicros;
+  uint32_t reference = startEpoch + static_cast<uint32_t>( elapsed / 1000000 );
+  CHECK( rtc->getEpoch() - reference >= 3 ); // About 3.5s ahead after two days
+  CHECK( drift.getEpoch() - reference + 1 <= 2 ); // Within a second of the reference once corrected
+
+  sim->setDriftPpb( 0 );
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+  PT7C4339_DriftModel model = { 0, startEpoch, 2400 };
+  drift.setModel( model );
+  uint32_t corrected = drift.getEpoch();
+
+  CHECK( drift.step() == 1 );
+  CHECK( sim->getRegister( PT7C4339_REG_SECONDS ) == 0x55 );
+  CHECK( drift.step( 5 ) == 1 );
+  CHECK( drift.step( 5 ) == 0 );
+  CHECK( sim->getRegister( PT7C4339_REG_SECONDS ) == 0x54 );
+  CHECK( drift.getEpoch() == corrected );
+
+  model.offsetMs = -2600;
+  drift.setModel( model );
+  CHECK( drift.step( 5 ) == -3 );
+  CHECK( sim->getRegister( PT7C4339_REG_SECONDS ) == 0x57 );
+  return true;
+}
+
+/**
+ * @brief Runs every non-blocking operation to its end with poll(), and reports a failed transaction.
+ *
+ * Blocking writes and updates between the steps must not disturb the data of the operation in the shared register image.
+ */
+static bool testAsync()
+{
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+
+  CHECK( rtc->startReadDateTime() );
+  CHECK( pollUntilDone() == PT7C4339_ASYNC_DONE );
+  CHECK( sameDateTime( rtc->getAsyncDateTime(), sampleDateTime ) );
+
+  CHECK( rtc->startSetAlarm1( sampleAlarm1 ) );
+  CHECK( rtc->setA1Time( { 1, 2, 3 } ) );
+  rtc->beginUpdate();
+  CHECK( !rtc->setA1Time( { 4, 5, 6 } ) );
+  rtc->cancelUpdate();
+  CHECK( pollUntilDone() == PT7C4339_ASYNC_DONE );
+  CHECK( rtc->getA1Rate() == PT7C4339_A1_HOURS_MINUTES_SECONDS_MATCH );
+  CHECK( rtc->getA1Time().minute == sampleTime.minute );
+  CHECK( rtc->verifyPendingWrites( nullptr ) );
+
+  CHECK( rtc->startReset() );
+  CHECK( pollUntilDone() == PT7C4339_ASYNC_DONE );
+  CHECK( sim->getRegister( PT7C4339_REG_A1_SECONDS ) == 0x00 && sim->getRegister( PT7C4339_REG_CONTROL ) == 0x18 );
+
+  CHECK( rtc->startReadDateTime() );
+  sim->failNextTransactions( 1 );
+  CHECK( pollUntilDone() == PT7C4339_ASYNC_ERROR_BUS );
+  return true;
+}
+
+/**
+ * @brief Calls the callbacks of the matched alarms from service() and clears their flags, only after an interrupt.
+ */
+static bool testServiceCallbacks()
+{
+  alarm1Calls = 0;
+  alarm2Calls = 0;
+  rtc->onAlarm1( countAlarm1 );
+  rtc->onAlarm2( countAlarm2 );
+
+  sim->setRegister( PT7C4339_REG_STATUS, 0x03 );
+  CHECK( rtc->service() == 0 );
+
+  rtc->notifyInterrupt();
+  CHECK( rtc->service() == ( PT7C4339_ALARM1_EVENT | PT7C4339_ALARM2_EVENT ) );
+  CHECK( alarm1Calls == 1 && alarm2Calls == 1 );
+  CHECK( ( sim->getRegister( PT7C4339_REG_STATUS ) & 0x03 ) == 0 );
+
+  sim->setRegister( PT7C4339_REG_STATUS, 0x02 );
+  rtc->notifyInterrupt();
+  CHECK( rtc->service() == PT7C4339_ALARM2_EVENT );
+  CHECK( alarm1Calls == 1 && alarm2Calls == 2 );
+
+  rtc->onAlarm1( nullptr );
+  rtc->onAlarm2( nullptr );
+  return true;
+}
+
+/**
+ * @brief Follows a cron schedule on alarm 2 through a working day and the following night.
+ */
+static bool testCron()
+{
+  sim->setDateTime( 2024, 2, 29, 16, 50, 0 );
+  sim->setRegister( PT7C4339_REG_DAYS_OF_WEEK, PT7C4339_THURSDAY );
+
+  PT7C4339_CronSchedule schedule = PT7C4339_cronParse( "*/15 8-17 * * 1-5" );
+  PT7C4339_CronAlarm<> cron( rtc );
+
+  CHECK( cron.begin( schedule ) );
+  CHECK( cron.getPlan().alarm == 2 && cron.nextDue() == PT7C4339_dateTimeToEpoch( { { 2024, 2, 29, PT7C4339_WEEKDAY_UNKNOWN }, { 17, 0, 0 } } ) );
+  CHECK( rtc->isA2IntEnabled() );
+
+  uint8_t fires = 0;
+
+  for( uint32_t i = 0; i < 15UL * 3600 + 30 * 60; i++ )
+  {
+    sim->advanceSeconds( 1 );
+    if( ( sim->getRegister( PT7C4339_REG_STATUS ) & 0x02 ) == 0 ) continue;
+
+    CHECK( rtc->getEpoch() == cron.nextDue() );
+    CHECK( rtc->clearA2Flag() );
+    CHECK( cron.service() );
+    fires++;
+  }
+
+  CHECK( fires == 6 ); // 17:00, 17:15, 17:30 and 17:45 on Thursday, 08:00 and 08:15 on Friday
+  CHECK( cron.nextDue() == PT7C4339_dateTimeToEpoch( { { 2024, 3, 1, PT7C4339_WEEKDAY_UNKNOWN }, { 8, 30, 0 } } ) );
+  return true;
+}
+
+/**
+ * @brief Dispatches a one-shot and a recurring alarm of the scheduler through alarm 1.
+ */
+static bool testScheduler()
+{
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+
+  PT7C4339_AlarmScheduler<4> scheduler( rtc );
+  uint32_t start = PT7C4339_dateTimeToEpoch( sampleDateTime );
+
+  scheduledCalls = 0;
+  CHECK( scheduler.add( PT7C4339_epochToDateTime( start + 10 ), 0, countScheduled ) != PT7C4339_SCHEDULER_NO_ID );
+  CHECK( scheduler.add( PT7C4339_epochToDateTime( start + 20 ), 60, countScheduled ) != PT7C4339_SCHEDULER_NO_ID );
+  CHECK( scheduler.service() );
+  CHECK( rtc->isA1IntEnabled() && scheduler.nextDue() == start + 10 );
+
+  sim->advanceSeconds( 10 );
+  CHECK( sim->getRegister( PT7C4339_REG_STATUS ) & 0x01 );
+  CHECK( rtc->clearA1Flag() );
+  CHECK( scheduler.service() );
+  CHECK( scheduledCalls == 1 && scheduler.count() == 1 && scheduler.nextDue() == start + 20 );
+
+  sim->advanceSeconds( 10 );
+  CHECK( rtc->clearA1Flag() );
+  CHECK( scheduler.service() );
+  CHECK( scheduledCalls == 2 && scheduler.count() == 1 && scheduler.nextDue() == start + 80 );
+  return true;
+}
+
+/**
+ * @brief Dispatches an alarm that became due while a slow callback ran, instead of arming alarm 1 for a time already past.
+ */
+static bool testSchedulerSlowCallback()
+{
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+
+  PT7C4339_AlarmScheduler<4> scheduler( rtc );
+  uint32_t start = PT7C4339_dateTimeToEpoch( sampleDateTime );
+
+  scheduledCalls = 0;
+  CHECK( scheduler.add( PT7C4339_epochToDateTime( start + 10 ), 0, slowScheduled ) != PT7C4339_SCHEDULER_NO_ID );
+  CHECK( scheduler.add( PT7C4339_epochToDateTime( start + 20 ), 0, countScheduled ) != PT7C4339_SCHEDULER_NO_ID );
+  CHECK( scheduler.add( PT7C4339_epochToDateTime( start + 100 ), 0, countScheduled ) != PT7C4339_SCHEDULER_NO_ID );
+  CHECK( scheduler.service() );
+
+  sim->advanceSeconds( 10 );
+  CHECK( rtc->clearA1Flag() );
+  CHECK( scheduler.service() );
+  CHECK( scheduledCalls == 2 && scheduler.count() == 1 && scheduler.nextDue() == start + 100 );
+
+  PT7C4339_Alarm1Config alarm = rtc->getAlarm1();
+  PT7C4339_DateTime due = PT7C4339_epochToDateTime( start + 100 );
+  CHECK( alarm.rate == PT7C4339_A1_DAY_HOURS_MINUTES_SECONDS_MATCH && alarm.dayDate.day == due.date.day );
+  CHECK( alarm.time.hour == due.time.hour && alarm.time.minute == due.time.minute && alarm.time.second == due.time.second );
+  return true;
+}
+
+/**
+ * @brief Reads the date and time of every RTC behind the multiplexer in one sweep, with one channel select per RTC
+ * and none while the channel is still selected, and reports the one that failed.
+ */
+static bool testFleet()
+{
+  PT7C4339_DateTime dateTimes[TEST_FLEET_SIZE];
+
+  for( uint8_t i = 0; i < TEST_FLEET_SIZE; i++ )
+  {
+    fleetDevices[i].powerOn();
+    fleetDevices[i].failNextTransactions( 0 );
+    fleetDevices[i].setRegister( PT7C4339_REG_STATUS, 0x00 );
+    fleetDevices[i].setDateTime( 2024, 2, 29, 12, 0, i );
+  }
+
+  uint32_t selects = fleetMux.getWriteCount();
+  uint32_t controlWrites = simMux->getControlWrites();
+  CHECK( PT7C4339::readDateTimes( fleet, TEST_FLEET_SIZE, dateTimes ) == TEST_FLEET_SIZE );
+  CHECK( fleetMux.getWriteCount() - selects == TEST_FLEET_SIZE );
+  CHECK( simMux->getControlWrites() - controlWrites == TEST_FLEET_SIZE );
+
+  for( uint8_t i = 0; i < TEST_FLEET_SIZE; i++ )
+  {
+    CHECK( dateTimes[i].date.day == 29 && dateTimes[i].time.hour == 12 && dateTimes[i].time.second == i );
+  }
+
+  PT7C4339 *last = fleet[TEST_FLEET_SIZE - 1];
+  selects = fleetMux.getWriteCount();
+  controlWrites = simMux->getControlWrites();
+  CHECK( last->getDateTime().time.second == TEST_FLEET_SIZE - 1 );
+  CHECK( last->getTime().second == TEST_FLEET_SIZE - 1 );
+  CHECK( last->getDateTime().date.day == 29 );
+  CHECK( fleetMux.getWriteCount() == selects && simMux->getControlWrites() == controlWrites );
+
+  fleetMux.invalidate();
+  CHECK( last->getDateTime().time.second == TEST_FLEET_SIZE - 1 );
+  CHECK( last->getDateTime().time.second == TEST_FLEET_SIZE - 1 );
+  CHECK( fleetMux.getWriteCount() - selects == 1 && simMux->getControlWrites() - controlWrites == 1 );
+  CHECK( simMux->getControl() == ( 1 << ( TEST_FLEET_SIZE - 1 ) ) );
+
+  fleetDevices[2].failNextTransactions( 1 );
+  CHECK( PT7C4339::readDateTimes( fleet, TEST_FLEET_SIZE, dateTimes ) == TEST_FLEET_SIZE - 1 );
+  CHECK( dateTimes[2].date.year == 0 && dateTimes[3].time.second == 3 );
+  return true;
+}
+
+#ifdef PT7C4339_ENABLE_STATS
+/**
+ * @brief Counts the bus traffic of every method in its own slot, and the calls left without a slot once every slot is taken.
+ */
+static bool testApiStats()
+{
+  rtc->resetStats();
+  CHECK( rtc->getApiStats( PT7C4339_API_GET_DATE_TIME ).calls == 0 );
+  CHECK( rtc->getUntrackedCalls() == 0 );
+
+  Wire.resetStats();
+  CHECK( sameDateTime( rtc->getDateTime(), { sampleDate, { 12, 34, 56 } } ) );
+  PT7C4339_ApiStats stats = rtc->getApiStats( PT7C4339_API_GET_DATE_TIME );
+  CHECK( stats.calls == 1 && stats.transactions == 2 && stats.bytes == 10 && stats.nacks == 0 );
+  CHECK( stats.transactions == Wire.getStats().transactions && stats.bytes == Wire.getStats().bytes );
+  uint32_t histogramCalls = 0;
+  for( uint8_t i = 0; i < PT7C4339_STATS_BUCKETS; i++ ) histogramCalls += stats.latencyHistogram[i];
+  CHECK( histogramCalls == 1 );
+
+  Wire.resetStats();
+  CHECK( rtc->setDateTime( sampleDateTime ) );
+  stats = rtc->getApiStats( PT7C4339_API_SET_DATE_TIME );
+  CHECK( stats.calls == 1 && stats.transactions == Wire.getStats().transactions && stats.bytes == Wire.getStats().bytes );
+  CHECK( stats.transactions == ( rtc->getVerifyPolicy() == PT7C4339_VERIFY_NEVER ? 1U : 3U ) );
+  histogramCalls = 0;
+  for( uint8_t i = 0; i < PT7C4339_STATS_BUCKETS; i++ ) histogramCalls += stats.latencyHistogram[i];
+  CHECK( histogramCalls == 1 );
+
+  sim->failNextTransactions( 1 );
+  CHECK( rtc->getDateTime().date.year == 0 );
+  stats = rtc->getApiStats( PT7C4339_API_GET_DATE_TIME );
+  CHECK( stats.calls == 2 && stats.nacks == 1 );
+
+  rtc->setVerifyPolicy( PT7C4339_VERIFY_DEFERRED );
+  CHECK( rtc->setAlarm1( sampleAlarm1 ) );
+  sim->setRegister( PT7C4339_REG_A1_MINUTES, 0x59 );
+  CHECK( !rtc->verifyPendingWrites() );
+  CHECK( rtc->getApiStats( PT7C4339_API_VERIFY_PENDING_WRITES ).verifyMismatches == 1 );
+  CHECK( rtc->getApiStats( PT7C4339_API_SET_ALARM1 ).verifyMismatches == 0 );
+
+  rtc->resetStats();
+  CHECK( rtc->getApiStats( PT7C4339_API_GET_DATE_TIME ).calls == 0 );
+  CHECK( rtc->getApiStats( PT7C4339_API_GET_DATE_TIME ).transactions == 0 );
+  CHECK( rtc->getApiStats( PT7C4339_API_VERIFY_PENDING_WRITES ).verifyMismatches == 0 );
+
+#if PT7C4339_STATS_SLOTS < PT7C4339_API_COUNT
+  for( uint8_t i = 0; i < PT7C4339_STATS_SLOTS; i++ ) CHECK( rtc->trackApiStats( static_cast<PT7C4339_apiMethod>( i ) ) );
+  CHECK( !rtc->trackApiStats( PT7C4339_API_GET_SECOND ) );
+  CHECK( rtc->getSecond() == sampleTime.second );
+  CHECK( rtc->getApiStats( PT7C4339_API_GET_SECOND ).calls == 0 );
+  CHECK( rtc->getUntrackedCalls() == 1 );
+
+  rtc->resetStats();
+  CHECK( rtc->getUntrackedCalls() == 0 );
+  CHECK( rtc->trackApiStats( PT7C4339_API_GET_SECOND ) );
+#endif
+  return true;
+}
+#endif
+
+static const TestCase cases[] =
+{
+  { "dateTimeRoundTrip", testDateTimeRoundTrip },
+  { "centuryRollover", testCenturyRollover },
+  { "invalidDateTime", testInvalidDateTime },
+  { "invalidRegisters", testInvalidRegisters },
+  { "dateFieldSetters", testDateFieldSetters },
+  { "busErrors", testBusErrors },
+  { "busRecovery", testBusRecovery },
+  { "verifyPolicy", testVerifyPolicy },
+  { "readModifyWriteErrors", testReadModifyWriteErrors },
+  { "applyConfig", testApplyConfig },
+  { "applyConfigAfterPowerLoss", testApplyConfigAfterPowerLoss },
+  { "stagedFlagClears", testStagedFlagClears },
+  { "reset", testReset },
+  { "resume", testResume },
+  { "softClock", testSoftClock },
+  { "eventCapture", testEventCapture },
+  { "driftEstimator", testDriftEstimator },
+  { "async", testAsync },
+  { "serviceCallbacks", testServiceCallbacks },
+  { "cron", testCron },
+  { "scheduler", testScheduler },
+  { "schedulerSlowCallback", testSchedulerSlowCallback },
+  { "fleet", testFleet },
+#ifdef PT7C4339_ENABLE_STATS
+  { "apiStats", testApiStats },
+#endif
+};
+
+static const TestConfig configs[] =
+{
+  { "default", false, PT7C4339_VERIFY_ALWAYS },
+  { "registerCache", true, PT7C4339_VERIFY_ALWAYS },
+  { "deferredVerify", true, PT7C4339_VERIFY_DEFERRED },
+  { "noVerify", false, PT7C4339_VERIFY_NEVER },
+};
+
+/**
+ * @brief Runs one case in one configuration, on a device put back into the same state before it.
+ */
+static bool runCase( const TestCase &test, const TestConfig &config )
+{
+  sim->powerOn();
+  sim->failNextTransactions( 0 );
+  sim->holdSda( false );
+  sim->setDriftPpb( 0 );
+  sim->setDateTime( 2024, 2, 29, 12, 34, 56 );
+  sim->setRegister( PT7C4339_REG_STATUS, 0x00 );
+  simMux->setControl( 0x00 );
+  fleetMux.invalidate();
+
+  PT7C4339 device( &Wire );
+  rtc = &device;
+
+  Wire.end();
+  if( rtc->begin() == 0 ) return false;
+  if( config.registerCache && !rtc->enableRegisterCache( true ) ) return false;
+  rtc->setVerifyPolicy( config.verifyPolicy );
+
+  bool passed = test.run();
+
+  detachInterrupt( digitalPinToInterrupt( TEST_SQW_PIN ) );
+
+  rtc = nullptr;
+  return passed;
+}
+
+int main()
+{
+  PT7C4339Simulator device;
+  sim = &device;
+
+  PT7C4339SimMux mux;
+  PT7C4339Simulator devices[TEST_FLEET_SIZE];
+  PT7C4339 fleetRtcs[TEST_FLEET_SIZE];
+  simMux = &mux;
+  fleetDevices = devices;
+
+  for( uint8_t i = 0; i < TEST_FLEET_SIZE; i++ )
+  {
+    mux.connect( i, &devices[i] );
+    fleetRtcs[i].setMux( &fleetMux, i );
+    fleet[i] = &fleetRtcs[i];
+  }
+
+  int failed = 0;
+  int total = 0;
+
+  for( const TestConfig &config : configs )
+  {
+    for( const TestCase &test : cases )
+    {
+      total++;
+      printf( "%s (%s)\n", test.name, config.name );
+
+      if( !runCase( test, config ) )
+      {
+        printf( "  FAILED\n" );
+        failed++;
+      }
+    }
+  }
+
+  printf( "%d of %d cases passed\n", total - failed, total );
+
+  return failed;
+}
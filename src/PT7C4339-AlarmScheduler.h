@@ -0,0 +1,397 @@
+/**
+ * @file PT7C4339-AlarmScheduler.h
+ * @brief Header-only software alarm scheduler for the PT7C4339-RTC library.
+ *
+ * Holds any number of one-shot and recurring alarms, up to a capacity fixed at compile time, in a min-heap ordered by
+ * their next due time, and keeps only the earliest one programmed into alarm 1 of the PT7C4339 (second resolution).
+ * The MCU can then sleep until INT/SQW goes low, however many schedules it has to follow.
+ * The RTC type defaults to PT7C4339, set it to drive a PT7C4339T with another bus policy.
+ *
+ * The scheduler owns alarm 1 and its interrupt enable bit. INT/SQW must be in interrupt mode (setIntOrSqwFlag( true )),
+ * and the alarm 1 flag is expected to be cleared by PT7C4339::service(), with an onAlarm1() callback that calls service()
+ * of the scheduler:
+ *
+ * @code
+ * PT7C4339 rtc;
+ * PT7C4339_AlarmScheduler<16> scheduler( &rtc );
+ *
+ * void onRtcInterrupt() { rtc.notifyInterrupt(); }
+ * void onRtcAlarm1() { scheduler.service(); }
+ *
+ * // setup(): rtc.onAlarm1( onRtcAlarm1 ); scheduler.add( ... ); scheduler.service();
+ * // loop():  rtc.service();
+ * @endcode
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#ifndef _PT7C4339_ALARM_SCHEDULER_H_
+#define _PT7C4339_ALARM_SCHEDULER_H_
+
+#include "PT7C4339-RTC.h"
+
+#define PT7C4339_SCHEDULER_NO_ID      0xFF ///< Returned by add() when the alarm could not be added, never used as an alarm id
+#define PT7C4339_SCHEDULER_LEAD       1 ///< Alarms due within this many seconds are dispatched at once, as alarm 1 could not be armed for them in time
+
+typedef void ( *PT7C4339_scheduledCallback )( uint8_t id ); ///< Function called by the scheduler when an alarm is due, with the id returned by add()
+
+/**
+ * @struct PT7C4339_ScheduledAlarm
+ * One alarm held by PT7C4339_AlarmScheduler
+ */
+typedef struct
+{
+  uint32_t due; ///< Next due time, as a Unix timestamp
+  uint32_t period; ///< Seconds between two due times of a recurring alarm, 0 for a one-shot alarm
+  PT7C4339_scheduledCallback callback; ///< Function called when the alarm is due
+  uint8_t id; ///< Id of the alarm, returned by add()
+} PT7C4339_ScheduledAlarm; ///< One alarm held by PT7C4339_AlarmScheduler
+
+#ifndef PT7C4339_NO_WIRE
+template<uint8_t CAPACITY, class RTC = PT7C4339>
+#else
+template<uint8_t CAPACITY, class RTC>
+#endif
+class PT7C4339_AlarmScheduler ///< Software alarm scheduler multiplexing up to CAPACITY alarms onto alarm 1 of the PT7C4339 RTC of type RTC
+{
+  static_assert( CAPACITY > 0 && CAPACITY < PT7C4339_SCHEDULER_NO_ID, "The capacity must be 1-254" );
+
+  public:
+    PT7C4339_AlarmScheduler( RTC *rtc );
+
+    uint8_t add( PT7C4339_DateTime first, uint32_t periodSeconds, PT7C4339_scheduledCallback callback );
+    bool remove( uint8_t id );
+    void clear();
+
+    uint8_t count();
+    bool isEmpty();
+    uint32_t nextDue();
+
+    bool service();
+
+  private:
+    RTC *_rtc;
+
+    PT7C4339_ScheduledAlarm _heap[CAPACITY];
+    uint8_t _count;
+    uint8_t _nextId;
+
+    bool _armed;
+    uint32_t _armedDue;
+
+    bool contains( uint8_t id );
+    void push( PT7C4339_ScheduledAlarm alarm );
+    PT7C4339_ScheduledAlarm pop();
+    void removeAt( uint8_t index );
+    void siftUp( uint8_t index );
+    void siftDown( uint8_t index );
+    bool arm();
+};
+
+/**
+ * @brief Constructs an empty scheduler driving alarm 1 of the given RTC.
+ *
+ * @param rtc The RTC whose alarm 1 the scheduler programs. Its begin() must be called before service().
+ */
+template<uint8_t CAPACITY, class RTC>
+PT7C4339_AlarmScheduler<CAPACITY, RTC>::PT7C4339_AlarmScheduler( RTC *rtc )
+{
+  _rtc = rtc;
+  _count = 0;
+  _nextId = 0;
+  _armed = false;
+  _armedDue = 0;
+}
+
+/**
+ * @brief Adds a one-shot or recurring alarm, without any I2C traffic.
+ *
+ * Alarm 1 is only programmed by the next call of service(), so call it after adding or removing alarms.
+ *
+ * @param first The first due date and time. The weekday is ignored.
+ * @param periodSeconds Seconds between two due times of a recurring alarm, 0 for a one-shot alarm.
+ * @param callback The function to call when the alarm is due, with the id of the alarm.
+ * @return uint8_t The id of the new alarm, PT7C4339_SCHEDULER_NO_ID if the scheduler is full or the date and time is invalid.
+ */
+template<uint8_t CAPACITY, class RTC>
+uint8_t PT7C4339_AlarmScheduler<CAPACITY, RTC>::add( PT7C4339_DateTime first, uint32_t periodSeconds, PT7C4339_scheduledCallback callback )
+{
+  if( _count >= CAPACITY || callback == nullptr || !PT7C4339_isValidDateTime( first ) ) return PT7C4339_SCHEDULER_NO_ID;
+
+  while( contains( _nextId ) ) _nextId = ( _nextId + 1 ) % PT7C4339_SCHEDULER_NO_ID;
+
+  PT7C4339_ScheduledAlarm alarm;
+  alarm.due = PT7C4339_dateTimeToEpoch( first );
+  alarm.period = periodSeconds;
+  alarm.callback = callback;
+  alarm.id = _nextId;
+
+  _nextId = ( _nextId + 1 ) % PT7C4339_SCHEDULER_NO_ID;
+
+  push( alarm );
+  return alarm.id;
+}
+
+/**
+ * @brief Removes an alarm, without any I2C traffic. Can be called from an alarm callback.
+ *
+ * @param id The id returned by add().
+ * @return bool True if the alarm was removed, false if there is no alarm with this id.
+ */
+template<uint8_t CAPACITY, class RTC>
+bool PT7C4339_AlarmScheduler<CAPACITY, RTC>::remove( uint8_t id )
+{
+  for( uint8_t i = 0; i < _count; i++ )
+  {
+    if( _heap[i].id == id )
+    {
+      removeAt( i );
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Removes every alarm, without any I2C traffic.
+ */
+template<uint8_t CAPACITY, class RTC>
+void PT7C4339_AlarmScheduler<CAPACITY, RTC>::clear()
+{
+  _count = 0;
+}
+
+/**
+ * @brief Retrieves the number of alarms held.
+ *
+ * @return uint8_t The number of alarms held (0-CAPACITY).
+ */
+template<uint8_t CAPACITY, class RTC>
+uint8_t PT7C4339_AlarmScheduler<CAPACITY, RTC>::count()
+{
+  return _count;
+}
+
+/**
+ * @brief Checks if the scheduler holds no alarm.
+ *
+ * @return bool True if the scheduler holds no alarm, false otherwise.
+ */
+template<uint8_t CAPACITY, class RTC>
+bool PT7C4339_AlarmScheduler<CAPACITY, RTC>::isEmpty()
+{
+  return _count == 0;
+}
+
+/**
+ * @brief Retrieves the due time of the earliest alarm.
+ *
+ * @return uint32_t The due time of the earliest alarm as a Unix timestamp, 0 if the scheduler is empty.
+ */
+template<uint8_t CAPACITY, class RTC>
+uint32_t PT7C4339_AlarmScheduler<CAPACITY, RTC>::nextDue()
+{
+  return _count > 0 ? _heap[0].due : 0;
+}
+
+/**
+ * @brief Dispatches every due alarm, then programs the earliest remaining one into alarm 1.
+ *
+ * The current time is read with one burst read. Every alarm due up to PT7C4339_SCHEDULER_LEAD seconds from now is removed
+ * from the heap, put back with its next due time if it is recurring, and its callback is called. Missed periods of a recurring
+ * alarm are skipped, so it is called once however late service() runs. If a callback was called, the time is read again
+ * and the alarms that became due meanwhile are dispatched, so alarm 1 is never armed for a time already past, which it would
+ * only match a month later. If the earliest alarm changed, alarm 1 is then programmed with a single burst write, matching day of the month, hours, minutes and seconds. With no alarm left,
+ * the alarm 1 interrupt is disabled.
+ *
+ * Call it from the onAlarm1() callback of the RTC, and after adding or removing alarms.
+ *
+ * @return bool True if alarm 1 is programmed for the earliest alarm (or disabled if there is none), false if the bus failed.
+ *
+ * @note Alarm 1 can not match a month, so an alarm due more than a month ahead wakes the MCU on the same day of an earlier month.
+ * service() then finds nothing due and programs alarm 1 again.
+ */
+template<uint8_t CAPACITY, class RTC>
+bool PT7C4339_AlarmScheduler<CAPACITY, RTC>::service()
+{
+  bool dispatched = true;
+
+  while( _count > 0 && dispatched ) // The callbacks may take long enough for the next alarm to be due before it is armed
+  {
+    PT7C4339_DateTime dateTime = _rtc->getDateTime();
+    if( dateTime.date.year == 0 ) return false;
+
+    uint32_t now = PT7C4339_dateTimeToEpoch( dateTime );
+    dispatched = false;
+
+    while( _count > 0 && _heap[0].due <= now + PT7C4339_SCHEDULER_LEAD )
+    {
+      PT7C4339_ScheduledAlarm alarm = pop();
+
+      if( alarm.period > 0 )
+      {
+        uint32_t late = now > alarm.due ? now - alarm.due : 0;
+
+        PT7C4339_ScheduledAlarm next = alarm;
+        next.due += ( late / alarm.period + 1 ) * alarm.period;
+        if( next.due <= now + PT7C4339_SCHEDULER_LEAD ) next.due += alarm.period;
+        push( next );
+      }
+
+      alarm.callback( alarm.id );
+      dispatched = true;
+    }
+  }
+
+  return arm();
+}
+
+/**
+ * @brief Checks if an alarm id is in use.
+ *
+ * @param id The id to look for.
+ * @return bool True if an alarm held has this id, false otherwise.
+ */
+template<uint8_t CAPACITY, class RTC>
+bool PT7C4339_AlarmScheduler<CAPACITY, RTC>::contains( uint8_t id )
+{
+  for( uint8_t i = 0; i < _count; i++ )
+  {
+    if( _heap[i].id == id ) return true;
+  }
+
+  return false;
+}
+
+/**
+ * @brief Inserts an alarm into the heap. The caller checks that the heap is not full.
+ *
+ * @param alarm The alarm to insert.
+ */
+template<uint8_t CAPACITY, class RTC>
+void PT7C4339_AlarmScheduler<CAPACITY, RTC>::push( PT7C4339_ScheduledAlarm alarm )
+{
+  _heap[_count] = alarm;
+  siftUp( _count );
+  _count++;
+}
+
+/**
+ * @brief Removes the earliest alarm from the heap. The caller checks that the heap is not empty.
+ *
+ * @return PT7C4339_ScheduledAlarm The earliest alarm.
+ */
+template<uint8_t CAPACITY, class RTC>
+PT7C4339_ScheduledAlarm PT7C4339_AlarmScheduler<CAPACITY, RTC>::pop()
+{
+  PT7C4339_ScheduledAlarm top = _heap[0];
+  removeAt( 0 );
+
+  return top;
+}
+
+/**
+ * @brief Removes the alarm at a position of the heap, moving the last alarm into its place.
+ *
+ * @param index The position of the alarm to remove.
+ */
+template<uint8_t CAPACITY, class RTC>
+void PT7C4339_AlarmScheduler<CAPACITY, RTC>::removeAt( uint8_t index )
+{
+  _count--;
+  if( index == _count ) return;
+
+  _heap[index] = _heap[_count];
+  siftUp( index );
+  siftDown( index );
+}
+
+/**
+ * @brief Moves an alarm towards the top of the heap until its parent is due earlier.
+ *
+ * @param index The position of the alarm.
+ */
+template<uint8_t CAPACITY, class RTC>
+void PT7C4339_AlarmScheduler<CAPACITY, RTC>::siftUp( uint8_t index )
+{
+  while( index > 0 )
+  {
+    uint8_t parent = ( index - 1 ) / 2;
+    if( _heap[parent].due <= _heap[index].due ) return;
+
+    PT7C4339_ScheduledAlarm swap = _heap[parent];
+    _heap[parent] = _heap[index];
+    _heap[index] = swap;
+    index = parent;
+  }
+}
+
+/**
+ * @brief Moves an alarm towards the bottom of the heap until its children are due later.
+ *
+ * @param index The position of the alarm.
+ */
+template<uint8_t CAPACITY, class RTC>
+void PT7C4339_AlarmScheduler<CAPACITY, RTC>::siftDown( uint8_t index )
+{
+  for( ;; )
+  {
+    uint16_t earliest = index;
+    uint16_t left = 2 * index + 1;
+    uint16_t right = left + 1;
+
+    if( left < _count && _heap[left].due < _heap[earliest].due ) earliest = left;
+    if( right < _count && _heap[right].due < _heap[earliest].due ) earliest = right;
+    if( earliest == index ) return;
+
+    PT7C4339_ScheduledAlarm swap = _heap[earliest];
+    _heap[earliest] = _heap[index];
+    _heap[index] = swap;
+    index = earliest;
+  }
+}
+
+/**
+ * @brief Programs the earliest alarm into alarm 1 if it changed, or disables the alarm 1 interrupt if there is none.
+ *
+ * @return bool True if alarm 1 matches the earliest alarm (or is disabled), false if the bus failed.
+ */
+template<uint8_t CAPACITY, class RTC>
+bool PT7C4339_AlarmScheduler<CAPACITY, RTC>::arm()
+{
+  if( _count == 0 )
+  {
+    if( !_armed ) return true;
+    if( !_rtc->enableA1Int( false ) ) return false;
+
+    _armed = false;
+    return true;
+  }
+
+  if( _armed && _armedDue == _heap[0].due ) return true;
+
+  PT7C4339_DateTime due = PT7C4339_epochToDateTime( _heap[0].due );
+
+  PT7C4339_Alarm1Config config;
+  config.rate = PT7C4339_A1_DAY_HOURS_MINUTES_SECONDS_MATCH;
+  config.time = due.time;
+  config.dayDate = due.date;
+  config.dayDate.weekDay = PT7C4339_WEEKDAY_UNKNOWN;
+
+  if( !_rtc->setAlarm1( config ) )
+  {
+    _armed = false;
+    return false;
+  }
+
+  if( !_armed && !_rtc->enableA1Int( true ) ) return false;
+
+  _armed = true;
+  _armedDue = _heap[0].due;
+  return true;
+}
+
+#endif
@@ -0,0 +1,389 @@
+/**
+ * @file PT7C4339-Calendar.h
+ * @brief Header-only constexpr calendar arithmetic for the PT7C4339-RTC library.
+ *
+ * Date and time types shared with the PT7C4339 class, and constant-time calendar functions on them:
+ * conversion to and from days since 1970-01-01 and Unix timestamps, adding and subtracting seconds, minutes and days,
+ * differences, day of the year, ISO 8601 week number and days in a month. The conversions are based on the
+ * days_from_civil and civil_from_days algorithms of Howard Hinnant (Gregorian calendar).
+ *
+ * Every function is constexpr and single-expression (C++11), so calculations on constant dates are done at compile time,
+ * and nothing allocates or loops. The only lookup table, the lengths of the months, is packed into an integer constant,
+ * so it takes no RAM and can be read at compile time, which a PROGMEM array could not.
+ *
+ * @note The PT7C4339 holds dates from 1900-01-01 to 2099-12-31, which every function supports.
+ * Day counts are valid for years 1-65535, Unix timestamps cover 1970-01-01 to 2106-02-07.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#ifndef _PT7C4339_CALENDAR_H_
+#define _PT7C4339_CALENDAR_H_
+
+#include <stdint.h>
+
+#define PT7C4339_EPOCH_MAX              4102444799UL ///< Unix timestamp of 2099-12-31 23:59:59, the last second the PT7C4339 can hold
+#define PT7C4339_SECONDS_PER_DAY        86400L ///< Number of seconds in a day
+#define PT7C4339_LONG_MONTHS            0x15AA ///< Bit n is set if month n has 31 days
+
+enum PT7C4339_daysOfWeek ///< Enum for the days of the week of the PT7C4339 RTC
+{
+  PT7C4339_WEEKDAY_UNKNOWN = 0, ///< Used for calling setDate()
+  PT7C4339_MONDAY = 1, ///< Monday
+  PT7C4339_TUESDAY = 2, ///< Tuesday
+  PT7C4339_WEDNESDAY = 3, ///< Wednesday
+  PT7C4339_THURSDAY = 4, ///< Thursday
+  PT7C4339_FRIDAY = 5, ///< Friday
+  PT7C4339_SATURDAY = 6, ///< Saturday
+  PT7C4339_SUNDAY = 7 ///< Sunday
+};
+
+/**
+ * @struct PT7C4339_Time
+ * Time structure for the PT7C4339 RTC
+ */
+typedef struct
+{
+  uint8_t hour; ///< Hours (0-23)
+  uint8_t minute; ///< Minutes (0-59)
+  uint8_t second; ///< Seconds (0-59)
+} PT7C4339_Time; ///< Time structure for the PT7C4339 RTC
+
+/**
+ * @struct PT7C4339_Date
+ * Date structure for the PT7C4339 RTC
+ */
+typedef struct
+{
+  uint16_t year; ///< Year (1900-2099)
+  uint8_t month; ///< Month (1-12)
+  uint8_t day; ///< Day (1-31)
+  PT7C4339_daysOfWeek weekDay; ///< Day of the week (1-7, where 1 = Monday and 7 = Sunday)
+} PT7C4339_Date; ///< Date structure for the PT7C4339 RTC
+
+/**
+ * @struct PT7C4339_DateTime
+ * Combined date and time structure for the PT7C4339 RTC
+ */
+typedef struct
+{
+  PT7C4339_Date date; ///< Date part (year, month, day, weekday)
+  PT7C4339_Time time; ///< Time part (hour, minute, second)
+} PT7C4339_DateTime; ///< Combined date and time structure for the PT7C4339 RTC
+
+/* Calendar properties */
+
+/**
+ * @brief Checks if a year is a leap year in the Gregorian calendar.
+ *
+ * @param year The full year.
+ * @return bool True if the year has 366 days.
+ */
+constexpr bool PT7C4339_isLeapYear( uint16_t year )
+{
+  return year % 4 == 0 && ( year % 100 != 0 || year % 400 == 0 );
+}
+
+/**
+ * @brief Returns the number of days in a month.
+ *
+ * @param year The full year.
+ * @param month The month (1-12).
+ * @return uint8_t The number of days in the month (28-31), 0 for an invalid month.
+ */
+constexpr uint8_t PT7C4339_daysInMonth( uint16_t year, uint8_t month )
+{
+  return ( month < 1 || month > 12 ) ? 0
+         : month == 2 ? ( PT7C4339_isLeapYear( year ) ? 29 : 28 )
+         : 30 + ( ( PT7C4339_LONG_MONTHS >> month ) & 1 );
+}
+
+/**
+ * @brief Checks if a date and time is valid and in the range of the PT7C4339 (1900-01-01 00:00:00 to 2099-12-31 23:59:59). The weekday is ignored.
+ *
+ * @param dateTime The date and time to check.
+ * @return bool True if every field is in range.
+ */
+constexpr bool PT7C4339_isValidDateTime( PT7C4339_DateTime dateTime )
+{
+  return dateTime.date.year >= 1900 && dateTime.date.year <= 2099 && dateTime.date.day >= 1
+         && dateTime.date.day <= PT7C4339_daysInMonth( dateTime.date.year, dateTime.date.month )
+         && dateTime.time.hour < 24 && dateTime.time.minute < 60 && dateTime.time.second < 60;
+}
+
+/* Conversions between civil dates and days since 1970-01-01 */
+
+/**
+ * @brief Helper of PT7C4339_daysFromCivil(), counts days with the year starting in March.
+ */
+constexpr int32_t PT7C4339_daysFromMarchYear( int32_t marchYear, uint8_t month, uint8_t day )
+{
+  return ( marchYear / 400 ) * 146097L + ( marchYear % 400 ) * 365L + ( marchYear % 400 ) / 4 - ( marchYear % 400 ) / 100
+         + ( 153L * ( month > 2 ? month - 3 : month + 9 ) + 2 ) / 5 + day - 1 - 719468L;
+}
+
+/**
+ * @brief Converts a civil date to the number of days since 1970-01-01.
+ *
+ * @param year The full year.
+ * @param month The month (1-12).
+ * @param day The day of the month (1-31).
+ * @return int32_t Days since 1970-01-01, negative for earlier dates.
+ */
+constexpr int32_t PT7C4339_daysFromCivil( uint16_t year, uint8_t month, uint8_t day )
+{
+  return PT7C4339_daysFromMarchYear( static_cast<int32_t>( year ) - ( month <= 2 ? 1 : 0 ), month, day );
+}
+
+/**
+ * @brief Returns the day of the week of a day counted from 1970-01-01 (a Thursday).
+ *
+ * @param days Days since 1970-01-01.
+ * @return PT7C4339_daysOfWeek The day of the week, where 1 = Monday ... 7 = Sunday.
+ */
+constexpr PT7C4339_daysOfWeek PT7C4339_weekDayFromDays( int32_t days )
+{
+  return static_cast<PT7C4339_daysOfWeek>( ( days % 7 + 10 ) % 7 + 1 );
+}
+
+/**
+ * @brief Helper of PT7C4339_civilFromDays(), builds the date from the March-based year and month.
+ */
+constexpr PT7C4339_Date PT7C4339_civilFromMarchMonth( uint32_t marchYear, uint32_t dayOfYear, uint32_t marchMonth, PT7C4339_daysOfWeek weekDay )
+{
+  return PT7C4339_Date{ static_cast<uint16_t>( marchYear + ( marchMonth >= 10 ? 1 : 0 ) ),
+                        static_cast<uint8_t>( marchMonth < 10 ? marchMonth + 3 : marchMonth - 9 ),
+                        static_cast<uint8_t>( dayOfYear - ( 153 * marchMonth + 2 ) / 5 + 1 ),
+                        weekDay };
+}
+
+/**
+ * @brief Helper of PT7C4339_civilFromDays(), splits the March-based day of the year into month and day.
+ */
+constexpr PT7C4339_Date PT7C4339_civilFromDayOfYear( uint32_t marchYear, uint32_t dayOfYear, PT7C4339_daysOfWeek weekDay )
+{
+  return PT7C4339_civilFromMarchMonth( marchYear, dayOfYear, ( 5 * dayOfYear + 2 ) / 153, weekDay );
+}
+
+/**
+ * @brief Helper of PT7C4339_civilFromDays(), splits the day of the 400 year era into year and day of the year.
+ */
+constexpr PT7C4339_Date PT7C4339_civilFromYearOfEra( uint32_t era, uint32_t dayOfEra, uint32_t yearOfEra, PT7C4339_daysOfWeek weekDay )
+{
+  return PT7C4339_civilFromDayOfYear( era * 400 + yearOfEra, dayOfEra - ( 365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100 ), weekDay );
+}
+
+/**
+ * @brief Helper of PT7C4339_civilFromDays(), finds the year of the 400 year era.
+ */
+constexpr PT7C4339_Date PT7C4339_civilFromDayOfEra( uint32_t era, uint32_t dayOfEra, PT7C4339_daysOfWeek weekDay )
+{
+  return PT7C4339_civilFromYearOfEra( era, dayOfEra, ( dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096 ) / 365, weekDay );
+}
+
+/**
+ * @brief Converts a number of days since 1970-01-01 to a civil date, including the day of the week.
+ *
+ * @param days Days since 1970-01-01, at least -719162 (0001-01-01).
+ * @return PT7C4339_Date The civil date.
+ */
+constexpr PT7C4339_Date PT7C4339_civilFromDays( int32_t days )
+{
+  return PT7C4339_civilFromDayOfEra( static_cast<uint32_t>( days + 719468L ) / 146097UL, static_cast<uint32_t>( days + 719468L ) % 146097UL, PT7C4339_weekDayFromDays( days ) );
+}
+
+/**
+ * @brief Converts a date and time to a Unix timestamp (seconds since 1970-01-01 00:00:00).
+ *
+ * @param dateTime The date and time, from 1970-01-01 00:00:00 to 2106-02-07 06:28:15. The weekday is ignored.
+ * @return uint32_t The Unix timestamp.
+ */
+constexpr uint32_t PT7C4339_dateTimeToEpoch( PT7C4339_DateTime dateTime )
+{
+  return static_cast<uint32_t>( PT7C4339_daysFromCivil( dateTime.date.year, dateTime.date.month, dateTime.date.day ) ) * 86400UL
+         + dateTime.time.hour * 3600UL + dateTime.time.minute * 60UL + dateTime.time.second;
+}
+
+/**
+ * @brief Converts a Unix timestamp (seconds since 1970-01-01 00:00:00) to a date and time, including the day of the week.
+ *
+ * @param epoch The Unix timestamp.
+ * @return PT7C4339_DateTime The date and time.
+ */
+constexpr PT7C4339_DateTime PT7C4339_epochToDateTime( uint32_t epoch )
+{
+  return PT7C4339_DateTime{ PT7C4339_civilFromDays( static_cast<int32_t>( epoch / 86400UL ) ),
+                            PT7C4339_Time{ static_cast<uint8_t>( epoch / 3600UL % 24 ), static_cast<uint8_t>( epoch / 60UL % 60 ), static_cast<uint8_t>( epoch % 60 ) } };
+}
+
+
+/* Day of the year, ISO week */
+
+/**
+ * @brief Returns the day of the year of a date.
+ *
+ * @param date The date. The weekday is ignored.
+ * @return uint16_t The day of the year (1-366).
+ */
+constexpr uint16_t PT7C4339_dayOfYear( PT7C4339_Date date )
+{
+  return static_cast<uint16_t>( PT7C4339_daysFromCivil( date.year, date.month, date.day ) - PT7C4339_daysFromCivil( date.year, 1, 1 ) + 1 );
+}
+
+/**
+ * @brief Helper of the ISO week functions, returns the day count of the Thursday in the ISO week of a day.
+ */
+constexpr int32_t PT7C4339_isoThursday( int32_t days )
+{
+  return days + 4 - PT7C4339_weekDayFromDays( days );
+}
+
+/**
+ * @brief Helper of PT7C4339_isoWeek(), counts the weeks from the first Thursday of the year.
+ */
+constexpr uint8_t PT7C4339_isoWeekOfThursday( int32_t thursday )
+{
+  return static_cast<uint8_t>( ( thursday - PT7C4339_daysFromCivil( PT7C4339_civilFromDays( thursday ).year, 1, 1 ) ) / 7 + 1 );
+}
+
+/**
+ * @brief Returns the ISO 8601 week number of a date. Weeks start on Monday, week 1 holds the first Thursday of the year.
+ *
+ * @param date The date. The weekday is ignored.
+ * @return uint8_t The ISO week number (1-53). Early January days may belong to week 52 or 53 of the previous year,
+ *         and late December days to week 1 of the next year, see PT7C4339_isoWeekYear().
+ */
+constexpr uint8_t PT7C4339_isoWeek( PT7C4339_Date date )
+{
+  return PT7C4339_isoWeekOfThursday( PT7C4339_isoThursday( PT7C4339_daysFromCivil( date.year, date.month, date.day ) ) );
+}
+
+/**
+ * @brief Returns the year the ISO 8601 week of a date belongs to.
+ *
+ * @param date The date. The weekday is ignored.
+ * @return uint16_t The ISO week-numbering year, which differs from the calendar year for some days around New Year.
+ */
+constexpr uint16_t PT7C4339_isoWeekYear( PT7C4339_Date date )
+{
+  return PT7C4339_civilFromDays( PT7C4339_isoThursday( PT7C4339_daysFromCivil( date.year, date.month, date.day ) ) ).year;
+}
+
+/* Arithmetic */
+
+/**
+ * @brief Returns the number of seconds since midnight of a time.
+ *
+ * @param time The time.
+ * @return int32_t Seconds since midnight (0-86399).
+ */
+constexpr int32_t PT7C4339_secondsOfDay( PT7C4339_Time time )
+{
+  return time.hour * 3600L + time.minute * 60L + time.second;
+}
+
+/**
+ * @brief Helper of the add functions, builds a date and time from a day count and a number of seconds since its midnight (0-86399).
+ */
+constexpr PT7C4339_DateTime PT7C4339_dateTimeFromDays( int32_t days, int32_t secondsOfDay )
+{
+  return PT7C4339_DateTime{ PT7C4339_civilFromDays( days ),
+                            PT7C4339_Time{ static_cast<uint8_t>( secondsOfDay / 3600 ), static_cast<uint8_t>( secondsOfDay / 60 % 60 ), static_cast<uint8_t>( secondsOfDay % 60 ) } };
+}
+
+/**
+ * @brief Helper of the add functions, moves a carry of -1, 0 or 1 day from the seconds to the day count.
+ */
+constexpr PT7C4339_DateTime PT7C4339_carryDay( int32_t days, int32_t seconds, int8_t carry )
+{
+  return PT7C4339_dateTimeFromDays( days + carry, seconds - carry * PT7C4339_SECONDS_PER_DAY );
+}
+
+/**
+ * @brief Helper of the add functions, normalizes a number of seconds from the midnight of a day, between -86399 and 172798.
+ */
+constexpr PT7C4339_DateTime PT7C4339_normalizeSeconds( int32_t days, int32_t seconds )
+{
+  return PT7C4339_carryDay( days, seconds, seconds < 0 ? -1 : ( seconds >= PT7C4339_SECONDS_PER_DAY ? 1 : 0 ) );
+}
+
+/**
+ * @brief Adds a number of days and seconds to a date and time.
+ *
+ * @param dateTime The date and time. The weekday of the result is recalculated.
+ * @param days The number of days to add, negative to subtract.
+ * @param seconds The number of seconds to add, negative to subtract, less than a day (86400) either way.
+ * @return PT7C4339_DateTime The resulting date and time.
+ */
+constexpr PT7C4339_DateTime PT7C4339_addDaysSeconds( PT7C4339_DateTime dateTime, int32_t days, int32_t seconds )
+{
+  return PT7C4339_normalizeSeconds( PT7C4339_daysFromCivil( dateTime.date.year, dateTime.date.month, dateTime.date.day ) + days,
+                                    PT7C4339_secondsOfDay( dateTime.time ) + seconds );
+}
+
+/**
+ * @brief Adds a number of seconds to a date and time.
+ *
+ * @param dateTime The date and time. The weekday of the result is recalculated.
+ * @param seconds The number of seconds to add, negative to subtract.
+ * @return PT7C4339_DateTime The resulting date and time.
+ */
+constexpr PT7C4339_DateTime PT7C4339_addSeconds( PT7C4339_DateTime dateTime, int32_t seconds )
+{
+  return PT7C4339_addDaysSeconds( dateTime, seconds / PT7C4339_SECONDS_PER_DAY, seconds % PT7C4339_SECONDS_PER_DAY );
+}
+
+/**
+ * @brief Adds a number of minutes to a date and time.
+ *
+ * @param dateTime The date and time. The weekday of the result is recalculated.
+ * @param minutes The number of minutes to add, negative to subtract.
+ * @return PT7C4339_DateTime The resulting date and time.
+ */
+constexpr PT7C4339_DateTime PT7C4339_addMinutes( PT7C4339_DateTime dateTime, int32_t minutes )
+{
+  return PT7C4339_addDaysSeconds( dateTime, minutes / 1440, minutes % 1440 * 60 );
+}
+
+/**
+ * @brief Adds a number of days to a date and time.
+ *
+ * @param dateTime The date and time. The weekday of the result is recalculated.
+ * @param days The number of days to add, negative to subtract.
+ * @return PT7C4339_DateTime The resulting date and time.
+ */
+constexpr PT7C4339_DateTime PT7C4339_addDays( PT7C4339_DateTime dateTime, int32_t days )
+{
+  return PT7C4339_addDaysSeconds( dateTime, days, 0 );
+}
+
+/**
+ * @brief Returns the number of calendar days from one date to another.
+ *
+ * @param from The earlier date. The weekday is ignored.
+ * @param to The later date. The weekday is ignored.
+ * @return int32_t The number of days, negative if to is before from.
+ */
+constexpr int32_t PT7C4339_diffDays( PT7C4339_Date from, PT7C4339_Date to )
+{
+  return PT7C4339_daysFromCivil( to.year, to.month, to.day ) - PT7C4339_daysFromCivil( from.year, from.month, from.day );
+}
+
+/**
+ * @brief Returns the number of seconds from one date and time to another.
+ *
+ * @param from The earlier date and time. The weekday is ignored.
+ * @param to The later date and time. The weekday is ignored.
+ * @return int64_t The number of seconds, negative if to is before from. 64 bits wide, as the 200 years of the
+ *         PT7C4339 range (about 6.3 billion seconds) do not fit in 32 bits. Use PT7C4339_diffDays() where days are enough,
+ *         it avoids the 64-bit arithmetic on 8-bit MCUs.
+ */
+constexpr int64_t PT7C4339_diffSeconds( PT7C4339_DateTime from, PT7C4339_DateTime to )
+{
+  return static_cast<int64_t>( PT7C4339_diffDays( from.date, to.date ) ) * PT7C4339_SECONDS_PER_DAY
+         + PT7C4339_secondsOfDay( to.time ) - PT7C4339_secondsOfDay( from.time );
+}
+
+#endif
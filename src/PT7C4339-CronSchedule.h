@@ -0,0 +1,660 @@
+/**
+ * @file PT7C4339-CronSchedule.h
+ * @brief Header-only cron-style schedule compiler for the alarms of the PT7C4339-RTC library.
+ *
+ * PT7C4339_cronParse() turns a cron expression into one bit mask per field, and PT7C4339_cronCompile() picks the
+ * alarm rate that lets the hardware match as much of it as it can: the fields the alarm compares are the ones the
+ * schedule restricts, the others are masked. The resulting plan also tells which alarm registers change from one
+ * occurrence to the next. A schedule the mask registers can express exactly (e.g. "30 7 * * *") needs no re-arm at all,
+ * any other one is re-armed after each fire by writing only the registers that changed, usually a single byte.
+ *
+ * Expressions have 5 fields (minute hour day-of-month month day-of-week, firing at second 0) or 6 fields (second first).
+ * Each field is *, a number, a range a-b, a step (* or a-b or a, followed by /n), or a comma separated list of these.
+ * The day of the week is 0-7, where both 0 and 7 are Sunday. As in cron, if both the day of the month and the day of
+ * the week are restricted, a day matches if either of them does.
+ *
+ * From C++14 the parser and the compiler are constexpr, so a constant expression costs neither flash for the parser nor time:
+ *
+ * @code
+ * constexpr PT7C4339_CronPlan plan = PT7C4339_cronCompile( PT7C4339_cronParse( "0 8 * * *" ) ); // Alarm 2, hours and minutes match
+ * rtc.setAlarmRegisters( plan.firstRegister, plan.registers, plan.length );
+ * @endcode
+ *
+ * PT7C4339_CronAlarm follows a schedule at runtime. It owns the alarm and its interrupt enable bit, INT/SQW must be
+ * in interrupt mode (setIntOrSqwFlag( true )), and its service() must be called from the onAlarm1() or onAlarm2() callback:
+ *
+ * @code
+ * PT7C4339 rtc;
+ * PT7C4339_CronAlarm<> workHours( &rtc );
+ *
+ * void onRtcAlarm2() { workHours.service(); }
+ *
+ * // setup(): rtc.onAlarm2( onRtcAlarm2 ); workHours.begin( PT7C4339_cronParse( "0,15,30,45 8-17 * * 1-5" ) );
+ * // loop():  rtc.service();
+ * @endcode
+ *
+ * @note The alarm only fires on the occurrence it is armed for, so service() must run before the next occurrence is due.
+ * Matching the day of the week needs the weekday register of the RTC to count 1 = Monday ... 7 = Sunday.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#ifndef _PT7C4339_CRON_SCHEDULE_H_
+#define _PT7C4339_CRON_SCHEDULE_H_
+
+#include "PT7C4339-RTC.h"
+
+#if __cplusplus >= 201402L
+  #define PT7C4339_CRON_CONSTEXPR constexpr ///< The parser and the compiler loop, which constexpr functions may only do from C++14
+#else
+  #define PT7C4339_CRON_CONSTEXPR inline ///< The parser and the compiler loop, which constexpr functions may only do from C++14
+#endif
+
+#define PT7C4339_CRON_ALL_SECONDS     0x0FFFFFFFFFFFFFFFULL ///< Mask of every second (bits 0-59)
+#define PT7C4339_CRON_ALL_MINUTES     0x0FFFFFFFFFFFFFFFULL ///< Mask of every minute (bits 0-59)
+#define PT7C4339_CRON_ALL_HOURS       0x00FFFFFFUL ///< Mask of every hour (bits 0-23)
+#define PT7C4339_CRON_ALL_DAYS        0xFFFFFFFEUL ///< Mask of every day of the month (bits 1-31)
+#define PT7C4339_CRON_ALL_MONTHS      0x1FFE ///< Mask of every month (bits 1-12)
+#define PT7C4339_CRON_ALL_WEEKDAYS    0xFE ///< Mask of every day of the week (bits 1-7)
+#define PT7C4339_CRON_SEARCH_DAYS     1462 ///< Days searched for the next occurrence, enough to reach the next February 29th
+#define PT7C4339_CRON_NO_VALUE        0xFF ///< Returned by PT7C4339_cronNextBit() if no bit is set in the range
+
+/**
+ * @struct PT7C4339_CronSchedule
+ * Cron expression parsed into one bit mask per field by PT7C4339_cronParse()
+ */
+typedef struct
+{
+  uint64_t seconds; ///< Bit n is set if second n (0-59) matches, only bit 0 for a 5 field expression
+  uint64_t minutes; ///< Bit n is set if minute n (0-59) matches
+  uint32_t hours; ///< Bit n is set if hour n (0-23) matches
+  uint32_t days; ///< Bit n is set if day of the month n (1-31) matches
+  uint16_t months; ///< Bit n is set if month n (1-12) matches
+  uint8_t weekDays; ///< Bit n is set if day of the week n (1 = Monday ... 7 = Sunday) matches
+  bool valid; ///< False if the expression could not be parsed
+} PT7C4339_CronSchedule; ///< Cron expression parsed into one bit mask per field by PT7C4339_cronParse()
+
+/**
+ * @struct PT7C4339_CronPlan
+ * Alarm configuration compiled from a schedule by PT7C4339_cronCompile()
+ */
+typedef struct
+{
+  uint8_t alarm; ///< Alarm the schedule runs on (1 or 2), 0 if the schedule can not be compiled
+  uint8_t rate; ///< PT7C4339_A1_rate or PT7C4339_A2_rate value of the alarm
+  uint8_t firstRegister; ///< Address of the first alarm register, PT7C4339_REG_A1_SECONDS or PT7C4339_REG_A2_MINUTES
+  uint8_t length; ///< Number of alarm registers (4 for alarm 1, 3 for alarm 2)
+  uint8_t registers[4]; ///< Register values of the first occurrence, mask and DY/DT bits included
+  uint8_t rearmMask; ///< Bit n is set if register n may change between two occurrences, 0 if the registers never change
+  bool exact; ///< True if the alarm only fires on occurrences, false if the month is not matched and some fires must be skipped
+} PT7C4339_CronPlan; ///< Alarm configuration compiled from a schedule by PT7C4339_cronCompile()
+
+/* Parser */
+
+/**
+ * @brief Helper of PT7C4339_cronParse(), checks if a character is a decimal digit.
+ */
+constexpr bool PT7C4339_cronIsDigit( char c )
+{
+  return c >= '0' && c <= '9';
+}
+
+/**
+ * @brief Helper of PT7C4339_cronParse(), checks if a character separates two fields.
+ */
+constexpr bool PT7C4339_cronIsSpace( char c )
+{
+  return c == ' ' || c == '\t';
+}
+
+/**
+ * @brief Helper of PT7C4339_cronParse(), counts the fields of an expression.
+ */
+PT7C4339_CRON_CONSTEXPR uint8_t PT7C4339_cronCountFields( const char *expression )
+{
+  uint8_t count = 0;
+  bool inField = false;
+
+  for( const char *c = expression; *c != '\0'; c++ )
+  {
+    bool space = PT7C4339_cronIsSpace( *c );
+    if( !space && !inField && count < 0xFF ) count++;
+    inField = !space;
+  }
+
+  return count;
+}
+
+/**
+ * @brief Helper of PT7C4339_cronParse(), reads a decimal number and moves the cursor past it.
+ */
+PT7C4339_CRON_CONSTEXPR uint16_t PT7C4339_cronParseNumber( const char *&cursor )
+{
+  uint16_t value = 0;
+
+  while( PT7C4339_cronIsDigit( *cursor ) )
+  {
+    if( value < 1000 ) value = value * 10 + ( *cursor - '0' );
+    cursor++;
+  }
+
+  return value;
+}
+
+/**
+ * @brief Parses one field of a cron expression and moves the cursor past it.
+ *
+ * @param cursor Points to the first character of the field, moved to the character after it.
+ * @param minimum The smallest value of the field.
+ * @param maximum The largest value of the field.
+ * @return uint64_t Bit n is set if value n matches, 0 if the field is invalid.
+ */
+PT7C4339_CRON_CONSTEXPR uint64_t PT7C4339_cronParseField( const char *&cursor, uint8_t minimum, uint8_t maximum )
+{
+  uint64_t mask = 0;
+
+  for( ;; )
+  {
+    uint16_t first = minimum;
+    uint16_t last = maximum;
+    uint16_t step = 1;
+
+    if( *cursor == '*' ) cursor++;
+    else
+    {
+      if( !PT7C4339_cronIsDigit( *cursor ) ) return 0;
+      first = PT7C4339_cronParseNumber( cursor );
+      if( *cursor != '/' ) last = first;
+
+      if( *cursor == '-' )
+      {
+        cursor++;
+        if( !PT7C4339_cronIsDigit( *cursor ) ) return 0;
+        last = PT7C4339_cronParseNumber( cursor );
+      }
+    }
+
+    if( *cursor == '/' )
+    {
+      cursor++;
+      if( !PT7C4339_cronIsDigit( *cursor ) ) return 0;
+      step = PT7C4339_cronParseNumber( cursor );
+    }
+
+    if( first < minimum || last > maximum || first > last || step == 0 ) return 0;
+
+    for( uint16_t value = first; value <= last; value += step ) mask |= 1ULL << value;
+
+    if( *cursor != ',' ) return mask;
+    cursor++;
+  }
+}
+
+/**
+ * @brief Parses a cron expression with 5 fields (minute hour day-of-month month day-of-week) or 6 fields (second first).
+ *
+ * @param expression The expression, e.g. "0 8 * * 1-5" or "0-59/10 * * * * *". Fields are separated by spaces or tabs.
+ * @return PT7C4339_CronSchedule The parsed schedule, with valid set to false if the expression is invalid.
+ */
+PT7C4339_CRON_CONSTEXPR PT7C4339_CronSchedule PT7C4339_cronParse( const char *expression )
+{
+  PT7C4339_CronSchedule schedule = {};
+  if( expression == nullptr ) return schedule;
+
+  uint8_t count = PT7C4339_cronCountFields( expression );
+  if( count != 5 && count != 6 ) return schedule;
+
+  const uint8_t minimum[6] = { 0, 0, 0, 1, 1, 0 };
+  const uint8_t maximum[6] = { 59, 59, 23, 31, 12, 7 };
+  uint64_t masks[6] = { 1, 0, 0, 0, 0, 0 }; // A 5 field expression fires at second 0
+
+  const char *cursor = expression;
+
+  for( uint8_t field = 6 - count; field < 6; field++ )
+  {
+    while( PT7C4339_cronIsSpace( *cursor ) ) cursor++;
+
+    masks[field] = PT7C4339_cronParseField( cursor, minimum[field], maximum[field] );
+    if( masks[field] == 0 ) return schedule;
+    if( *cursor != '\0' && !PT7C4339_cronIsSpace( *cursor ) ) return schedule;
+  }
+
+  schedule.seconds = masks[0];
+  schedule.minutes = masks[1];
+  schedule.hours = static_cast<uint32_t>( masks[2] );
+  schedule.days = static_cast<uint32_t>( masks[3] );
+  schedule.months = static_cast<uint16_t>( masks[4] );
+  schedule.weekDays = static_cast<uint8_t>( ( masks[5] | ( masks[5] << 7 ) ) & PT7C4339_CRON_ALL_WEEKDAYS ); // Sunday 0 folded onto 7
+  schedule.valid = true;
+
+  return schedule;
+}
+
+/* Matching */
+
+/**
+ * @brief Helper of the matching functions, finds the lowest set bit of a mask from a given position.
+ *
+ * @return uint8_t The position of the bit, PT7C4339_CRON_NO_VALUE if no bit is set from the position to the maximum.
+ */
+PT7C4339_CRON_CONSTEXPR uint8_t PT7C4339_cronNextBit( uint64_t mask, uint8_t from, uint8_t maximum )
+{
+  for( uint8_t n = from; n <= maximum; n++ )
+  {
+    if( ( mask >> n ) & 1 ) return n;
+  }
+
+  return PT7C4339_CRON_NO_VALUE;
+}
+
+/**
+ * @brief Checks if a date matches the month, day of the month and day of the week fields of a schedule.
+ *
+ * @param schedule The schedule.
+ * @param date The date, with its day of the week.
+ * @return bool True if the date matches.
+ */
+PT7C4339_CRON_CONSTEXPR bool PT7C4339_cronMatchesDate( PT7C4339_CronSchedule schedule, PT7C4339_Date date )
+{
+  bool month = ( schedule.months >> date.month ) & 1;
+  bool day = ( schedule.days >> date.day ) & 1;
+  bool weekDay = ( schedule.weekDays >> date.weekDay ) & 1;
+
+  if( schedule.days != PT7C4339_CRON_ALL_DAYS && schedule.weekDays != PT7C4339_CRON_ALL_WEEKDAYS ) return month && ( day || weekDay );
+
+  return month && day && weekDay;
+}
+
+/**
+ * @brief Checks if a Unix timestamp is an occurrence of a schedule.
+ *
+ * @param schedule The schedule.
+ * @param epoch The Unix timestamp.
+ * @return bool True if every field matches, false otherwise or if the schedule is invalid.
+ */
+PT7C4339_CRON_CONSTEXPR bool PT7C4339_cronMatches( PT7C4339_CronSchedule schedule, uint32_t epoch )
+{
+  PT7C4339_DateTime dateTime = PT7C4339_epochToDateTime( epoch );
+
+  return schedule.valid && PT7C4339_cronMatchesDate( schedule, dateTime.date ) &&
+         ( ( schedule.hours >> dateTime.time.hour ) & 1 ) &&
+         ( ( schedule.minutes >> dateTime.time.minute ) & 1 ) &&
+         ( ( schedule.seconds >> dateTime.time.second ) & 1 );
+}
+
+/**
+ * @brief Helper of PT7C4339_cronNext(), finds the first matching time of the day at or after a given second of the day.
+ *
+ * @return int32_t The matching second of the day, -1 if none is left in the day.
+ */
+PT7C4339_CRON_CONSTEXPR int32_t PT7C4339_cronFirstSecondOfDay( PT7C4339_CronSchedule schedule, int32_t secondsOfDay )
+{
+  uint8_t hour = secondsOfDay / 3600;
+  uint8_t minute = ( secondsOfDay / 60 ) % 60;
+  uint8_t second = secondsOfDay % 60;
+
+  for( uint8_t h = PT7C4339_cronNextBit( schedule.hours, hour, 23 ); h != PT7C4339_CRON_NO_VALUE; h = PT7C4339_cronNextBit( schedule.hours, h + 1, 23 ) )
+  {
+    for( uint8_t m = PT7C4339_cronNextBit( schedule.minutes, ( h == hour ) ? minute : 0, 59 ); m != PT7C4339_CRON_NO_VALUE; m = PT7C4339_cronNextBit( schedule.minutes, m + 1, 59 ) )
+    {
+      uint8_t s = PT7C4339_cronNextBit( schedule.seconds, ( h == hour && m == minute ) ? second : 0, 59 );
+      if( s != PT7C4339_CRON_NO_VALUE ) return h * 3600L + m * 60L + s;
+    }
+  }
+
+  return -1;
+}
+
+/**
+ * @brief Finds the next occurrence of a schedule after a given time.
+ *
+ * Walks day by day from the given time, checking the date fields once per day, for at most PT7C4339_CRON_SEARCH_DAYS days.
+ *
+ * @param schedule The schedule.
+ * @param after The Unix timestamp the occurrence must be later than.
+ * @return uint32_t The Unix timestamp of the next occurrence, 0 if the schedule is invalid, never matches (e.g. February 30th)
+ *         or its next occurrence is past PT7C4339_EPOCH_MAX.
+ */
+PT7C4339_CRON_CONSTEXPR uint32_t PT7C4339_cronNext( PT7C4339_CronSchedule schedule, uint32_t after )
+{
+  if( !schedule.valid || after >= PT7C4339_EPOCH_MAX ) return 0;
+
+  int32_t days = static_cast<int32_t>( ( after + 1 ) / PT7C4339_SECONDS_PER_DAY );
+  int32_t secondsOfDay = static_cast<int32_t>( ( after + 1 ) % PT7C4339_SECONDS_PER_DAY );
+
+  for( uint16_t i = 0; i < PT7C4339_CRON_SEARCH_DAYS; i++ )
+  {
+    if( PT7C4339_cronMatchesDate( schedule, PT7C4339_civilFromDays( days ) ) )
+    {
+      int32_t second = PT7C4339_cronFirstSecondOfDay( schedule, secondsOfDay );
+
+      if( second >= 0 )
+      {
+        uint32_t next = static_cast<uint32_t>( days ) * PT7C4339_SECONDS_PER_DAY + second;
+        return ( next <= PT7C4339_EPOCH_MAX ) ? next : 0;
+      }
+    }
+
+    days++;
+    secondsOfDay = 0;
+  }
+
+  return 0;
+}
+
+/* Compiler */
+
+/**
+ * @brief Helper of the compiler, checks if exactly one bit of a mask is set.
+ */
+constexpr bool PT7C4339_cronIsSingle( uint64_t mask )
+{
+  return mask != 0 && ( mask & ( mask - 1 ) ) == 0;
+}
+
+/**
+ * @brief Helper of the compiler, converts a value (0-99) to BCD.
+ */
+constexpr uint8_t PT7C4339_cronToBcd( uint8_t value )
+{
+  return static_cast<uint8_t>( ( ( value / 10 ) << 4 ) | ( value % 10 ) );
+}
+
+/**
+ * @brief Encodes the alarm registers of a plan for an occurrence given by its fields.
+ *
+ * The fields the rate masks are written as 0x80, the others as BCD, and the day register as a weekday with the DY bit
+ * if the rate matches the day of the week.
+ *
+ * @param plan The plan, as returned by PT7C4339_cronCompile().
+ * @param second The second of the occurrence, ignored for alarm 2.
+ * @param minute The minute of the occurrence.
+ * @param hour The hour of the occurrence (24-hour format).
+ * @param day The day of the month of the occurrence.
+ * @param weekDay The day of the week of the occurrence (1 = Monday ... 7 = Sunday).
+ * @return PT7C4339_CronPlan The plan with the registers of the occurrence.
+ */
+PT7C4339_CRON_CONSTEXPR PT7C4339_CronPlan PT7C4339_cronEncode( PT7C4339_CronPlan plan, uint8_t second, uint8_t minute, uint8_t hour, uint8_t day, uint8_t weekDay )
+{
+  const uint8_t fields[4] = { second, minute, hour, day };
+  uint8_t offset = 4 - plan.length; // Alarm 2 has no seconds register
+  bool byWeekDay = ( plan.rate >> plan.length ) & 1;
+
+  for( uint8_t i = 0; i < plan.length; i++ )
+  {
+    bool masked = ( plan.rate >> i ) & 1;
+    bool isDay = ( i + offset == 3 );
+
+    if( masked ) plan.registers[i] = 0x80;
+    else if( isDay && byWeekDay ) plan.registers[i] = 0x40 | weekDay;
+    else plan.registers[i] = PT7C4339_cronToBcd( fields[i + offset] );
+  }
+
+  return plan;
+}
+
+/**
+ * @brief Encodes the alarm registers of a plan for the occurrence at a given time, what PT7C4339_CronAlarm writes on a re-arm.
+ *
+ * @param plan The plan, as returned by PT7C4339_cronCompile().
+ * @param epoch The Unix timestamp of the occurrence, e.g. returned by PT7C4339_cronNext().
+ * @return PT7C4339_CronPlan The plan with the registers of the occurrence.
+ */
+PT7C4339_CRON_CONSTEXPR PT7C4339_CronPlan PT7C4339_cronTarget( PT7C4339_CronPlan plan, uint32_t epoch )
+{
+  PT7C4339_DateTime dateTime = PT7C4339_epochToDateTime( epoch );
+
+  return PT7C4339_cronEncode( plan, dateTime.time.second, dateTime.time.minute, dateTime.time.hour, dateTime.date.day, dateTime.date.weekDay );
+}
+
+/**
+ * @brief Compiles a schedule to the alarm configuration that matches as many of its fields in hardware as possible.
+ *
+ * The rate is chosen by the most significant restricted field: the month or the day of the month needs a date match,
+ * the day of the week a weekday match, then the hour, the minute and the second. The fields below it are matched too,
+ * the fields above it are masked. If every matched field has a single value, the registers never change and
+ * rearmMask is 0. Otherwise the registers hold the first value of every field, and rearmMask tells which of them
+ * PT7C4339_cronTarget() may change for the next occurrence. Alarm 2 can only be used if the schedule fires at second 0.
+ *
+ * @param schedule The schedule, as returned by PT7C4339_cronParse().
+ * @param alarm The alarm to use (1 or 2), 0 to use alarm 2 if the schedule fires at second 0 and alarm 1 otherwise.
+ * @return PT7C4339_CronPlan The plan, with alarm set to 0 if the schedule is invalid or can not run on the given alarm.
+ */
+PT7C4339_CRON_CONSTEXPR PT7C4339_CronPlan PT7C4339_cronCompile( PT7C4339_CronSchedule schedule, uint8_t alarm = 0 )
+{
+  PT7C4339_CronPlan plan = {};
+  if( !schedule.valid ) return plan;
+
+  bool atSecondZero = ( schedule.seconds == 1 );
+  if( alarm == 0 ) alarm = atSecondZero ? 2 : 1;
+  if( alarm != 1 && alarm != 2 ) return plan;
+  if( alarm == 2 && !atSecondZero ) return plan;
+
+  bool allDays = ( schedule.days == PT7C4339_CRON_ALL_DAYS );
+  bool allMonths = ( schedule.months == PT7C4339_CRON_ALL_MONTHS );
+  bool allWeekDays = ( schedule.weekDays == PT7C4339_CRON_ALL_WEEKDAYS );
+
+  uint8_t level = 0; // Most significant matched field: 1 second, 2 minute, 3 hour, 4 day of the month, 5 day of the week
+  if( !allDays || !allMonths ) level = 4;
+  else if( !allWeekDays ) level = 5;
+  else if( schedule.hours != PT7C4339_CRON_ALL_HOURS ) level = 3;
+  else if( schedule.minutes != PT7C4339_CRON_ALL_MINUTES ) level = 2;
+  else if( schedule.seconds != PT7C4339_CRON_ALL_SECONDS && alarm == 1 ) level = 1;
+
+  const uint8_t alarm1Rates[6] = { PT7C4339_A1_EVERY_SECOND, PT7C4339_A1_SECONDS_MATCH, PT7C4339_A1_MINUTES_SECONDS_MATCH,
+                                   PT7C4339_A1_HOURS_MINUTES_SECONDS_MATCH, PT7C4339_A1_DAY_HOURS_MINUTES_SECONDS_MATCH,
+                                   PT7C4339_A1_WEEKDAY_HOURS_MINUTES_SECONDS_MATCH };
+  const uint8_t alarm2Rates[6] = { PT7C4339_A2_EVERY_MINUTE, PT7C4339_A2_EVERY_MINUTE, PT7C4339_A2_MINUTES_MATCH,
+                                   PT7C4339_A2_HOURS_MINUTES_MATCH, PT7C4339_A2_DAY_HOURS_MINUTES_MATCH,
+                                   PT7C4339_A2_WEEKDAY_HOURS_MINUTES_MATCH };
+
+  plan.alarm = alarm;
+  plan.rate = ( alarm == 1 ) ? alarm1Rates[level] : alarm2Rates[level];
+  plan.firstRegister = ( alarm == 1 ) ? PT7C4339_REG_A1_SECONDS : PT7C4339_REG_A2_MINUTES;
+  plan.length = ( alarm == 1 ) ? 4 : 3;
+  plan.exact = allMonths;
+
+  const bool varies[4] = { level >= 1 && !PT7C4339_cronIsSingle( schedule.seconds ),
+                           level >= 2 && !PT7C4339_cronIsSingle( schedule.minutes ),
+                           level >= 3 && !PT7C4339_cronIsSingle( schedule.hours ),
+                           ( level == 4 && !( PT7C4339_cronIsSingle( schedule.days ) && allWeekDays ) ) ||
+                           ( level == 5 && !PT7C4339_cronIsSingle( schedule.weekDays ) ) };
+  uint8_t offset = 4 - plan.length;
+
+  for( uint8_t i = 0; i < plan.length; i++ )
+  {
+    if( varies[i + offset] ) plan.rearmMask |= 1 << i;
+  }
+
+  return PT7C4339_cronEncode( plan, PT7C4339_cronNextBit( schedule.seconds, 0, 59 ), PT7C4339_cronNextBit( schedule.minutes, 0, 59 ),
+                              PT7C4339_cronNextBit( schedule.hours, 0, 23 ), PT7C4339_cronNextBit( schedule.days, 1, 31 ),
+                              PT7C4339_cronNextBit( schedule.weekDays, 1, 7 ) );
+}
+
+/* Runtime */
+
+#ifndef PT7C4339_NO_WIRE
+template<class RTC = PT7C4339>
+#else
+template<class RTC>
+#endif
+class PT7C4339_CronAlarm ///< Follows a cron schedule with alarm 1 or 2 of the PT7C4339 RTC of type RTC, re-arming only the registers that change
+{
+  public:
+    PT7C4339_CronAlarm( RTC *rtc );
+
+    bool begin( PT7C4339_CronSchedule schedule, uint8_t alarm = 0 );
+    bool service();
+
+    bool isArmed();
+    uint32_t nextDue();
+    PT7C4339_CronPlan getPlan();
+
+  private:
+    RTC *_rtc;
+
+    PT7C4339_CronSchedule _schedule;
+    PT7C4339_CronPlan _plan;
+    uint8_t _registers[4]; // Alarm registers as last written to the RTC
+
+    bool _armed;
+    uint32_t _due;
+
+    bool enableInt( bool enable );
+};
+
+/**
+ * @brief Constructs an idle cron alarm for the given RTC.
+ *
+ * @param rtc The RTC whose alarm follows the schedule. Its begin() must be called before begin().
+ */
+template<class RTC>
+PT7C4339_CronAlarm<RTC>::PT7C4339_CronAlarm( RTC *rtc )
+{
+  _rtc = rtc;
+  _schedule = PT7C4339_CronSchedule();
+  _plan = PT7C4339_CronPlan();
+  _armed = false;
+  _due = 0;
+
+  for( uint8_t i = 0; i < 4; i++ ) _registers[i] = 0;
+}
+
+/**
+ * @brief Compiles a schedule, then arms the alarm for its next occurrence with one burst write of the alarm registers
+ * and enables the interrupt of the alarm.
+ *
+ * @param schedule The schedule, as returned by PT7C4339_cronParse().
+ * @param alarm The alarm to use (1 or 2), 0 to let PT7C4339_cronCompile() choose.
+ * @return bool True if the alarm is armed, false if the schedule can not be compiled, has no next occurrence, or a read or write failed.
+ */
+template<class RTC>
+bool PT7C4339_CronAlarm<RTC>::begin( PT7C4339_CronSchedule schedule, uint8_t alarm )
+{
+  _armed = false;
+  _schedule = schedule;
+  _plan = PT7C4339_cronCompile( schedule, alarm );
+  if( _plan.alarm == 0 ) return false;
+
+  uint32_t now = _rtc->getEpoch();
+  if( now == 0 ) return false;
+
+  _due = PT7C4339_cronNext( schedule, now );
+  if( _due == 0 ) return false;
+
+  PT7C4339_CronPlan target = PT7C4339_cronTarget( _plan, _due );
+  if( !_rtc->setAlarmRegisters( target.firstRegister, target.registers, target.length ) ) return false;
+
+  for( uint8_t i = 0; i < 4; i++ ) _registers[i] = target.registers[i];
+
+  if( !enableInt( true ) ) return false;
+
+  _armed = true;
+  return true;
+}
+
+/**
+ * @brief Re-arms the alarm for the next occurrence after it fired. Call it from the onAlarm1() or onAlarm2() callback.
+ *
+ * The registers of the next occurrence are compared to the ones on the RTC, and only the span that differs is written,
+ * so a fixed schedule costs no I2C traffic and a typical one a single byte write (plus its verification, by the policy).
+ * If the plan is not exact (the month is not matched), the time is read first, and a fire before the due time is skipped
+ * without a write.
+ *
+ * @return bool True if the fire was an occurrence of the schedule, false if it is not armed, the fire was skipped or the time read failed.
+ *         isArmed() is false afterwards if the schedule has no more occurrences or the write failed.
+ */
+template<class RTC>
+bool PT7C4339_CronAlarm<RTC>::service()
+{
+  if( !_armed ) return false;
+
+  uint32_t fired = _due;
+
+  if( !_plan.exact )
+  {
+    uint32_t now = _rtc->getEpoch();
+    if( now == 0 || now < _due ) return false;
+
+    fired = now;
+  }
+
+  _due = PT7C4339_cronNext( _schedule, fired );
+
+  if( _due == 0 )
+  {
+    _armed = false;
+    enableInt( false );
+    return true;
+  }
+
+  PT7C4339_CronPlan target = PT7C4339_cronTarget( _plan, _due );
+  uint8_t first = PT7C4339_CRON_NO_VALUE;
+  uint8_t last = 0;
+
+  for( uint8_t i = 0; i < _plan.length; i++ )
+  {
+    if( target.registers[i] == _registers[i] ) continue;
+
+    if( first == PT7C4339_CRON_NO_VALUE ) first = i;
+    last = i;
+  }
+
+  if( first == PT7C4339_CRON_NO_VALUE ) return true;
+
+  if( !_rtc->setAlarmRegisters( _plan.firstRegister + first, target.registers + first, last - first + 1 ) )
+  {
+    _armed = false;
+    return true;
+  }
+
+  for( uint8_t i = first; i <= last; i++ ) _registers[i] = target.registers[i];
+
+  return true;
+}
+
+/**
+ * @brief Checks if the alarm is armed for an occurrence.
+ *
+ * @return bool True after a successful begin(), until the schedule runs out of occurrences or a write fails.
+ */
+template<class RTC>
+bool PT7C4339_CronAlarm<RTC>::isArmed()
+{
+  return _armed;
+}
+
+/**
+ * @brief Gets the occurrence the alarm is armed for, without any I2C traffic.
+ *
+ * @return uint32_t The Unix timestamp of the occurrence, 0 if the alarm is not armed.
+ */
+template<class RTC>
+uint32_t PT7C4339_CronAlarm<RTC>::nextDue()
+{
+  return _armed ? _due : 0;
+}
+
+/**
+ * @brief Gets the plan compiled by begin().
+ *
+ * @return PT7C4339_CronPlan The plan, with alarm set to 0 before begin() or if the schedule could not be compiled.
+ */
+template<class RTC>
+PT7C4339_CronPlan PT7C4339_CronAlarm<RTC>::getPlan()
+{
+  return _plan;
+}
+
+/**
+ * @brief Enables or disables the interrupt of the alarm of the plan.
+ */
+template<class RTC>
+bool PT7C4339_CronAlarm<RTC>::enableInt( bool enable )
+{
+  return ( _plan.alarm == 1 ) ? _rtc->enableA1Int( enable ) : _rtc->enableA2Int( enable );
+}
+
+#endif
@@ -0,0 +1,374 @@
+/**
+ * @file PT7C4339-DriftEstimator.h
+ * @brief Header-only oscillator drift estimator and software frequency correction for the PT7C4339-RTC library.
+ *
+ * The PT7C4339 has no aging offset register, so the frequency error of its crystal shows up as a steadily growing
+ * time offset. The estimator fits a line to the offsets measured against a reference (a host, NTP or GNSS sync) with an
+ * online least squares regression, without storing the samples. The slope is the drift in parts per billion, and with it
+ * every time read through the estimator is corrected, so the interval between two syncs can be much longer.
+ * The RTC type defaults to PT7C4339, set it to use a PT7C4339T with another bus policy.
+ *
+ * The fitted model is a few bytes (PT7C4339_DriftModel): save it with getModel() after a sync, e.g. into EEPROM,
+ * and hand it back with setModel() after a restart. step() can also move the RTC itself by whole seconds,
+ * so its registers, alarms included, stay close to the reference:
+ *
+ * @code
+ * PT7C4339 rtc;
+ * PT7C4339_DriftEstimator<> drift( &rtc );
+ *
+ * // On every sync:  drift.addSample( referenceEpoch ); save( drift.getModel() );
+ * // After a reset:  drift.setModel( load() );
+ * // Reading time:   uint32_t now = drift.getEpoch();
+ * // After a SQW edge or seconds alarm: drift.step();
+ * @endcode
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#ifndef _PT7C4339_DRIFT_ESTIMATOR_H_
+#define _PT7C4339_DRIFT_ESTIMATOR_H_
+
+#include "PT7C4339-RTC.h"
+
+#define PT7C4339_DRIFT_MIN_SPAN       3600 ///< Seconds the samples must span before the drift is fitted, as a shorter span gives a noisy slope
+#define PT7C4339_DRIFT_MAX_STEP       10 ///< Largest number of seconds step() moves the RTC by in one call
+#define PT7C4339_DRIFT_STEP_WINDOW    100000 ///< Microseconds after the seconds update in which step() writes, if the software clock tells the phase
+#define PT7C4339_DRIFT_MAX_OFFSET_MS  2000000000L ///< Largest offset in milliseconds (about 23 days) a sample can have
+#define PT7C4339_DRIFT_MAX_PPB        1000000000L ///< Largest drift in parts per billion the fit can result in
+
+/**
+ * @struct PT7C4339_DriftModel
+ * Offset of the RTC from the reference as a line over time, fitted by PT7C4339_DriftEstimator
+ */
+typedef struct
+{
+  int32_t driftPpb; ///< Frequency error of the RTC in parts per billion, positive if the RTC runs fast (1 ppm is 86.4 ms per day)
+  uint32_t anchorEpoch; ///< Unix timestamp where offsetMs was fitted
+  int32_t offsetMs; ///< Offset of the RTC from the reference at anchorEpoch in milliseconds, positive if the RTC is ahead
+} PT7C4339_DriftModel; ///< Offset of the RTC from the reference as a line over time, fitted by PT7C4339_DriftEstimator
+
+#ifndef PT7C4339_NO_WIRE
+template<class RTC = PT7C4339>
+#else
+template<class RTC>
+#endif
+class PT7C4339_DriftEstimator ///< Oscillator drift estimator and software frequency correction for the PT7C4339 RTC of type RTC
+{
+  public:
+    PT7C4339_DriftEstimator( RTC *rtc );
+
+    bool addSample( uint32_t referenceEpoch, uint32_t referenceMicros = 0 );
+    void addOffset( uint32_t referenceEpoch, int32_t offsetMs );
+    void clearSamples();
+    uint32_t sampleCount();
+
+    PT7C4339_DriftModel getModel();
+    void setModel( PT7C4339_DriftModel model );
+    int32_t getDriftPpb();
+    int32_t getOffsetMs( uint32_t epoch );
+
+    uint32_t correct( uint32_t rtcEpoch );
+    uint32_t getEpoch();
+    PT7C4339_DateTime getDateTime();
+
+    int8_t step( uint8_t maxSeconds = 1 );
+
+  private:
+    RTC *_rtc;
+
+    PT7C4339_DriftModel _model;
+    int32_t _steppedMs;
+
+    uint32_t _samples;
+    uint32_t _firstEpoch;
+    int32_t _minX;
+    int32_t _maxX;
+    double _meanX;
+    double _meanY;
+    double _cxx;
+    double _cxy;
+
+    void fit();
+};
+
+/**
+ * @brief Constructs an estimator for the given RTC, with no samples and a zero drift model.
+ *
+ * @param rtc The RTC whose time is sampled and corrected. Its begin() must be called before the first bus access.
+ */
+template<class RTC>
+PT7C4339_DriftEstimator<RTC>::PT7C4339_DriftEstimator( RTC *rtc )
+{
+  _rtc = rtc;
+  _model = {};
+
+  clearSamples();
+}
+
+/**
+ * @brief Measures the offset of the RTC from a reference time and adds it to the regression.
+ *
+ * Call it right when the reference time is valid, e.g. on the pulse per second of a GNSS receiver.
+ * With a synchronized software clock, the RTC time is taken from now() with millisecond resolution and without any
+ * I2C traffic. Otherwise it is read with one burst read, and as the fraction of its second is unknown,
+ * the middle of the second is assumed.
+ *
+ * @param referenceEpoch The reference time as a Unix timestamp.
+ * @param referenceMicros Microseconds elapsed in the reference second (0-999999).
+ * @return bool True if the sample was added, false if the read failed or the offset is more than PT7C4339_DRIFT_MAX_OFFSET_MS.
+ */
+template<class RTC>
+bool PT7C4339_DriftEstimator<RTC>::addSample( uint32_t referenceEpoch, uint32_t referenceMicros )
+{
+  uint32_t rtcEpoch;
+  uint32_t rtcMillis;
+
+  if( _rtc->isSoftClockSynced() )
+  {
+    PT7C4339_Timestamp timestamp = _rtc->now();
+    rtcEpoch = PT7C4339_dateTimeToEpoch( timestamp.dateTime );
+    rtcMillis = timestamp.microsecond / 1000;
+  }
+  else
+  {
+    rtcEpoch = _rtc->getEpoch();
+    if( rtcEpoch == 0 ) return false;
+    rtcMillis = 500;
+  }
+
+  int64_t offsetMs = ( static_cast<int64_t>( rtcEpoch ) - referenceEpoch ) * 1000 + rtcMillis - referenceMicros / 1000;
+  if( offsetMs > PT7C4339_DRIFT_MAX_OFFSET_MS || offsetMs < -PT7C4339_DRIFT_MAX_OFFSET_MS ) return false;
+
+  addOffset( referenceEpoch, static_cast<int32_t>( offsetMs ) );
+  return true;
+}
+
+/**
+ * @brief Adds an offset measured elsewhere to the regression, without any I2C traffic.
+ *
+ * Use it when the RTC time is compared with the reference on the other end of the link, e.g. by a host that receives
+ * timestamps from the device. The offset must be the one of the RTC as it is, including the seconds moved by step().
+ *
+ * @param referenceEpoch The reference time of the measurement as a Unix timestamp.
+ * @param offsetMs The offset of the RTC from the reference in milliseconds, positive if the RTC is ahead.
+ */
+template<class RTC>
+void PT7C4339_DriftEstimator<RTC>::addOffset( uint32_t referenceEpoch, int32_t offsetMs )
+{
+  if( _samples == 0 ) _firstEpoch = referenceEpoch;
+
+  int32_t x = static_cast<int32_t>( referenceEpoch - _firstEpoch );
+  double y = static_cast<double>( offsetMs ) + _steppedMs; // The offset the oscillator would have without the steps
+
+  if( _samples == 0 || x < _minX ) _minX = x;
+  if( _samples == 0 || x > _maxX ) _maxX = x;
+  _samples++;
+
+  double dx = x - _meanX;
+  _meanX += dx / _samples;
+  _meanY += ( y - _meanY ) / _samples;
+  _cxx += dx * ( x - _meanX );
+  _cxy += dx * ( y - _meanY );
+
+  fit();
+}
+
+/**
+ * @brief Discards the samples of the regression, the drift model is kept until the next sample.
+ */
+template<class RTC>
+void PT7C4339_DriftEstimator<RTC>::clearSamples()
+{
+  _steppedMs = 0;
+  _samples = 0;
+  _firstEpoch = 0;
+  _minX = 0;
+  _maxX = 0;
+  _meanX = 0;
+  _meanY = 0;
+  _cxx = 0;
+  _cxy = 0;
+}
+
+/**
+ * @brief Gets the number of samples in the regression.
+ *
+ * @return uint32_t The number of samples added since the construction, clearSamples() or setModel().
+ */
+template<class RTC>
+uint32_t PT7C4339_DriftEstimator<RTC>::sampleCount()
+{
+  return _samples;
+}
+
+/**
+ * @brief Gets the drift model, to save it across restarts.
+ *
+ * @return PT7C4339_DriftModel The offset line of the RTC as it is now, with the seconds moved by step() included.
+ */
+template<class RTC>
+PT7C4339_DriftModel PT7C4339_DriftEstimator<RTC>::getModel()
+{
+  return _model;
+}
+
+/**
+ * @brief Restores a drift model saved with getModel(), and discards the samples of the regression.
+ *
+ * With the next sample, the offset is measured again and the drift of the model is kept,
+ * until the samples span PT7C4339_DRIFT_MIN_SPAN seconds and the drift is fitted from them.
+ *
+ * @param model The drift model to use.
+ */
+template<class RTC>
+void PT7C4339_DriftEstimator<RTC>::setModel( PT7C4339_DriftModel model )
+{
+  _model = model;
+
+  clearSamples();
+}
+
+/**
+ * @brief Gets the frequency error of the RTC.
+ *
+ * @return int32_t The drift in parts per billion, positive if the RTC runs fast.
+ */
+template<class RTC>
+int32_t PT7C4339_DriftEstimator<RTC>::getDriftPpb()
+{
+  return _model.driftPpb;
+}
+
+/**
+ * @brief Predicts the offset of the RTC from the reference at a given time, without any I2C traffic.
+ *
+ * @param epoch The time as a Unix timestamp, of the RTC or of the reference, as they differ too little to matter.
+ * @return int32_t The predicted offset in milliseconds, positive if the RTC is ahead.
+ */
+template<class RTC>
+int32_t PT7C4339_DriftEstimator<RTC>::getOffsetMs( uint32_t epoch )
+{
+  int64_t elapsed = static_cast<int64_t>( epoch ) - _model.anchorEpoch;
+
+  return _model.offsetMs + static_cast<int32_t>( elapsed * _model.driftPpb / 1000000 );
+}
+
+/**
+ * @brief Corrects a time read from the RTC by the predicted offset, without any I2C traffic.
+ *
+ * @param rtcEpoch The time read from the RTC as a Unix timestamp.
+ * @return uint32_t The time of the reference, rounded to the nearest second. 0 if rtcEpoch is 0, the result of a failed read.
+ */
+template<class RTC>
+uint32_t PT7C4339_DriftEstimator<RTC>::correct( uint32_t rtcEpoch )
+{
+  if( rtcEpoch == 0 ) return 0;
+
+  int32_t offsetMs = getOffsetMs( rtcEpoch );
+  int32_t offsetSeconds = ( offsetMs >= 0 ) ? ( offsetMs + 500 ) / 1000 : -( ( 500 - offsetMs ) / 1000 );
+
+  return rtcEpoch - offsetSeconds;
+}
+
+/**
+ * @brief Reads the date and time with one burst read and corrects it by the predicted offset.
+ *
+ * @return uint32_t The corrected time as a Unix timestamp, 0 if the read failed.
+ */
+template<class RTC>
+uint32_t PT7C4339_DriftEstimator<RTC>::getEpoch()
+{
+  return correct( _rtc->getEpoch() );
+}
+
+/**
+ * @brief Reads the date and time with one burst read and corrects it by the predicted offset.
+ *
+ * @return PT7C4339_DateTime The corrected date and time, with the weekday calculated. Every field is 0 if the read failed.
+ */
+template<class RTC>
+PT7C4339_DateTime PT7C4339_DriftEstimator<RTC>::getDateTime()
+{
+  uint32_t epoch = getEpoch();
+
+  if( epoch == 0 )
+  {
+    PT7C4339_DateTime dateTime = {};
+    return dateTime;
+  }
+
+  return PT7C4339_epochToDateTime( epoch );
+}
+
+/**
+ * @brief Moves the RTC towards the reference by whole seconds through the seconds register, if it is off by half a second or more.
+ *
+ * The date and time is read with one burst read, and the seconds register is written with the step applied,
+ * unless that would cross a minute boundary.
+ * Writing the seconds restarts the countdown chain of the RTC, so call it right after the seconds changed,
+ * e.g. after a 1Hz SQW edge or an alarm matching every second, to lose only the time since then.
+ * With a synchronized software clock, nothing is done later than PT7C4339_DRIFT_STEP_WINDOW microseconds into the second.
+ * The model is updated by the step, so the corrected time does not change. The time lost is measured by the next samples.
+ *
+ * @param maxSeconds The largest step in seconds (1-PT7C4339_DRIFT_MAX_STEP), 1 by default so the clock never jumps much.
+ * @return int8_t The seconds the RTC was moved back (positive) or forward (negative), 0 if no step was needed or possible.
+ */
+template<class RTC>
+int8_t PT7C4339_DriftEstimator<RTC>::step( uint8_t maxSeconds )
+{
+  if( maxSeconds > PT7C4339_DRIFT_MAX_STEP ) maxSeconds = PT7C4339_DRIFT_MAX_STEP;
+  if( _rtc->isSoftClockSynced() && _rtc->now().microsecond > PT7C4339_DRIFT_STEP_WINDOW ) return 0;
+
+  PT7C4339_DateTime dateTime = _rtc->getDateTime();
+  if( dateTime.date.month == 0 ) return 0;
+
+  uint8_t seconds = dateTime.time.second;
+  if( seconds > 58 ) return 0; // The minute could roll over before the write
+
+  int32_t offsetMs = getOffsetMs( PT7C4339_dateTimeToEpoch( dateTime ) );
+  int32_t offsetSeconds = ( offsetMs >= 0 ) ? ( offsetMs + 500 ) / 1000 : -( ( 500 - offsetMs ) / 1000 );
+
+  if( offsetSeconds > maxSeconds ) offsetSeconds = maxSeconds;
+  if( offsetSeconds < -maxSeconds ) offsetSeconds = -maxSeconds;
+  if( offsetSeconds == 0 ) return 0;
+
+  int32_t stepped = static_cast<int32_t>( seconds ) - offsetSeconds;
+  if( stepped < 0 || stepped > 58 ) return 0;
+
+  if( !_rtc->setSecond( static_cast<uint8_t>( stepped ) ) ) return 0;
+
+  _model.offsetMs -= offsetSeconds * 1000;
+  _steppedMs += offsetSeconds * 1000;
+
+  return static_cast<int8_t>( offsetSeconds );
+}
+
+/**
+ * @brief Fits the drift model to the samples.
+ *
+ * The offset is the mean of the samples, anchored at their mean time, where the fitted line is the most accurate.
+ * The drift is the slope of the line, fitted once the samples span PT7C4339_DRIFT_MIN_SPAN seconds, otherwise the drift
+ * of the model is kept.
+ */
+template<class RTC>
+void PT7C4339_DriftEstimator<RTC>::fit()
+{
+  if( _samples >= 2 && _maxX - _minX >= PT7C4339_DRIFT_MIN_SPAN && _cxx > 0 )
+  {
+    double driftPpb = _cxy / _cxx * 1000000.0; // Milliseconds per second to parts per billion
+
+    if( driftPpb > PT7C4339_DRIFT_MAX_PPB ) driftPpb = PT7C4339_DRIFT_MAX_PPB;
+    if( driftPpb < -PT7C4339_DRIFT_MAX_PPB ) driftPpb = -PT7C4339_DRIFT_MAX_PPB;
+    _model.driftPpb = static_cast<int32_t>( driftPpb < 0 ? driftPpb - 0.5 : driftPpb + 0.5 );
+  }
+
+  int32_t anchorX = static_cast<int32_t>( _meanX < 0 ? _meanX - 0.5 : _meanX + 0.5 );
+  double offsetMs = _meanY + ( anchorX - _meanX ) * _model.driftPpb / 1000000.0 - _steppedMs;
+
+  _model.anchorEpoch = _firstEpoch + anchorX;
+  _model.offsetMs = static_cast<int32_t>( offsetMs < 0 ? offsetMs - 0.5 : offsetMs + 0.5 );
+}
+
+#endif
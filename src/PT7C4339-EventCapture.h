@@ -0,0 +1,280 @@
+/**
+ * @file PT7C4339-EventCapture.h
+ * @brief Header-only interrupt-safe event timestamp capture for the PT7C4339-RTC library.
+ *
+ * An interrupt handler can not read the RTC, as that blocks on I2C. capture() only stores the microsecond timer
+ * and an event id into a single-producer/single-consumer ring buffer. resolve(), called from the main loop,
+ * then converts the whole batch to calendar time with one time read, anchored to the timer value it was taken at.
+ * However many events were captured, a batch costs one burst read, or no bus traffic with a synchronized software clock.
+ * The RTC type defaults to PT7C4339, set it to use a PT7C4339T with another bus policy.
+ *
+ * @code
+ * PT7C4339 rtc;
+ * PT7C4339_EventCapture<256> events( &rtc );
+ * PT7C4339_Event batch[32];
+ *
+ * void onEdge() { events.capture( 1 ); }
+ *
+ * // loop(): uint16_t count = events.resolve( batch, 32 ); // batch[i].epoch, .microsecond, .id
+ * @endcode
+ *
+ * capture() never waits and needs no critical section. resolve() and the other consumer methods mask interrupts
+ * only to copy the shared indices, as 16-bit loads are not atomic on 8-bit MCUs.
+ * The producer and the consumer must run on the same core.
+ *
+ * @note The timer wraps every 71 minutes, so call resolve() well within 35 minutes of a capture.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#ifndef _PT7C4339_EVENT_CAPTURE_H_
+#define _PT7C4339_EVENT_CAPTURE_H_
+
+#include "PT7C4339-RTC.h"
+
+#define PT7C4339_EVENT_UNKNOWN_FRACTION  500000 ///< Microseconds assumed into the second read from the RTC, as its fraction is unknown without the software clock
+
+/**
+ * @struct PT7C4339_CapturedEvent
+ * Event stored by PT7C4339_EventCapture::capture(), before it is resolved to calendar time
+ */
+typedef struct
+{
+  uint32_t micros; ///< Microsecond timer of the bus policy at the capture
+  uint8_t id; ///< Id of the event, given to capture()
+} PT7C4339_CapturedEvent; ///< Event stored by PT7C4339_EventCapture::capture(), before it is resolved to calendar time
+
+/**
+ * @struct PT7C4339_Event
+ * Event resolved to calendar time by PT7C4339_EventCapture::resolve()
+ */
+typedef struct
+{
+  uint32_t epoch; ///< Time of the event as a Unix timestamp
+  uint32_t microsecond; ///< Microseconds elapsed in the second of the event (0-999999)
+  uint8_t id; ///< Id of the event, given to capture()
+} PT7C4339_Event; ///< Event resolved to calendar time by PT7C4339_EventCapture::resolve()
+
+#ifndef PT7C4339_NO_WIRE
+template<uint16_t CAPACITY, class RTC = PT7C4339>
+#else
+template<uint16_t CAPACITY, class RTC>
+#endif
+class PT7C4339_EventCapture ///< Ring buffer of up to CAPACITY events captured in interrupts, resolved to the calendar time of the PT7C4339 RTC of type RTC
+{
+  static_assert( CAPACITY >= 2 && CAPACITY <= 32768 && ( CAPACITY & ( CAPACITY - 1 ) ) == 0, "The capacity must be a power of 2 from 2 to 32768" );
+
+  public:
+    PT7C4339_EventCapture( RTC *rtc );
+
+    bool capture( uint8_t id );
+    bool push( uint8_t id, uint32_t micros );
+
+    uint16_t available();
+    uint32_t getDropped();
+    void clear();
+
+    uint16_t resolve( PT7C4339_Event *events, uint16_t maxCount );
+
+  private:
+    RTC *_rtc;
+
+    PT7C4339_CapturedEvent _ring[CAPACITY];
+    volatile uint16_t _head;
+    volatile uint16_t _tail;
+    volatile uint32_t _dropped;
+
+    bool readAnchor( uint32_t *epoch, uint32_t *fraction, uint32_t *micros );
+};
+
+/**
+ * @brief Constructs an empty event buffer for the given RTC.
+ *
+ * @param rtc The RTC the events are resolved with. Its begin() must be called before resolve().
+ */
+template<uint16_t CAPACITY, class RTC>
+PT7C4339_EventCapture<CAPACITY, RTC>::PT7C4339_EventCapture( RTC *rtc )
+{
+  _rtc = rtc;
+  _head = 0;
+  _tail = 0;
+  _dropped = 0;
+}
+
+/**
+ * @brief Captures an event with the current microsecond timer of the bus policy. Call it from the interrupt handler.
+ *
+ * @param id The id of the event, e.g. the pin or the kind of the edge.
+ * @return bool True if the event was stored, false if the buffer is full and it was dropped.
+ */
+template<uint16_t CAPACITY, class RTC>
+bool PT7C4339_EventCapture<CAPACITY, RTC>::capture( uint8_t id )
+{
+  return push( id, _rtc->getBus().timeMicros() );
+}
+
+/**
+ * @brief Stores an event captured at a given timer value, e.g. by an input capture unit. Call it from the interrupt handler.
+ *
+ * @param id The id of the event.
+ * @param micros The value of the microsecond timer of the bus policy (micros() with Wire) at the event.
+ * @return bool True if the event was stored, false if the buffer is full and it was dropped.
+ */
+template<uint16_t CAPACITY, class RTC>
+bool PT7C4339_EventCapture<CAPACITY, RTC>::push( uint8_t id, uint32_t micros )
+{
+  uint16_t head = _head;
+
+  if( static_cast<uint16_t>( head - _tail ) >= CAPACITY )
+  {
+    _dropped++;
+    return false;
+  }
+
+  PT7C4339_CapturedEvent &slot = _ring[head & ( CAPACITY - 1 )];
+  slot.micros = micros;
+  slot.id = id;
+
+  __atomic_signal_fence( __ATOMIC_RELEASE ); // The slot is written before the consumer can see it
+  _head = head + 1;
+
+  return true;
+}
+
+/**
+ * @brief Gets the number of events waiting to be resolved.
+ *
+ * @return uint16_t The number of events in the buffer.
+ */
+template<uint16_t CAPACITY, class RTC>
+uint16_t PT7C4339_EventCapture<CAPACITY, RTC>::available()
+{
+  _rtc->getBus().enterCritical();
+  uint16_t head = _head;
+  _rtc->getBus().exitCritical();
+
+  return head - _tail;
+}
+
+/**
+ * @brief Gets the number of events dropped because the buffer was full.
+ *
+ * @return uint32_t The number of events dropped since the construction.
+ */
+template<uint16_t CAPACITY, class RTC>
+uint32_t PT7C4339_EventCapture<CAPACITY, RTC>::getDropped()
+{
+  _rtc->getBus().enterCritical();
+  uint32_t dropped = _dropped;
+  _rtc->getBus().exitCritical();
+
+  return dropped;
+}
+
+/**
+ * @brief Discards the events waiting to be resolved.
+ */
+template<uint16_t CAPACITY, class RTC>
+void PT7C4339_EventCapture<CAPACITY, RTC>::clear()
+{
+  _rtc->getBus().enterCritical();
+  _tail = _head;
+  _rtc->getBus().exitCritical();
+}
+
+/**
+ * @brief Resolves the oldest waiting events to calendar time, with at most one time read for the whole batch.
+ *
+ * The time is taken once, together with the microsecond timer, and every event is placed relative to it by its own timer value.
+ * With a synchronized software clock, the time comes from now() with microsecond resolution and without any I2C traffic.
+ * Otherwise the date and time is read with one burst read, and as the fraction of its second is unknown,
+ * PT7C4339_EVENT_UNKNOWN_FRACTION is assumed: the events are then within half a second of the RTC, but exact relative to each other.
+ *
+ * @param events Array that receives the resolved events, oldest first.
+ * @param maxCount The size of the array.
+ * @return uint16_t The number of events resolved and removed from the buffer. 0 if there were none or the read failed,
+ *         in which case the events are kept.
+ */
+template<uint16_t CAPACITY, class RTC>
+uint16_t PT7C4339_EventCapture<CAPACITY, RTC>::resolve( PT7C4339_Event *events, uint16_t maxCount )
+{
+  uint16_t count = available();
+  if( count > maxCount ) count = maxCount;
+  if( count == 0 ) return 0;
+
+  uint32_t anchorEpoch;
+  uint32_t anchorFraction;
+  uint32_t anchorMicros;
+
+  if( !readAnchor( &anchorEpoch, &anchorFraction, &anchorMicros ) ) return 0;
+
+  __atomic_signal_fence( __ATOMIC_ACQUIRE ); // The slots are read after the head that published them
+  uint16_t tail = _tail;
+
+  for( uint16_t i = 0; i < count; i++ )
+  {
+    const PT7C4339_CapturedEvent &slot = _ring[static_cast<uint16_t>( tail + i ) & ( CAPACITY - 1 )];
+
+    // 32-bit arithmetic only: the delta fits in int32_t within 35 minutes, and the fraction is normalised separately
+    int32_t delta = static_cast<int32_t>( slot.micros - anchorMicros );
+    int32_t seconds = delta / 1000000L;
+    int32_t fraction = static_cast<int32_t>( anchorFraction ) + delta % 1000000L;
+
+    if( fraction < 0 )
+    {
+      seconds--;
+      fraction += 1000000L;
+    }
+    else if( fraction >= 1000000L )
+    {
+      seconds++;
+      fraction -= 1000000L;
+    }
+
+    events[i].epoch = anchorEpoch + seconds;
+    events[i].microsecond = static_cast<uint32_t>( fraction );
+    events[i].id = slot.id;
+  }
+
+  __atomic_signal_fence( __ATOMIC_RELEASE ); // The slots are read before the producer can reuse them
+
+  _rtc->getBus().enterCritical();
+  _tail = tail + count;
+  _rtc->getBus().exitCritical();
+
+  return count;
+}
+
+/**
+ * @brief Takes the current time and the microsecond timer value it belongs to.
+ *
+ * @param epoch Receives the current time as a Unix timestamp.
+ * @param fraction Receives the microseconds elapsed in the current second.
+ * @param micros Receives the microsecond timer of the bus policy at the time taken.
+ * @return bool True if the time was taken, false if the read failed.
+ */
+template<uint16_t CAPACITY, class RTC>
+bool PT7C4339_EventCapture<CAPACITY, RTC>::readAnchor( uint32_t *epoch, uint32_t *fraction, uint32_t *micros )
+{
+  if( _rtc->isSoftClockSynced() )
+  {
+    *micros = _rtc->getBus().timeMicros();
+    PT7C4339_Timestamp timestamp = _rtc->now();
+
+    *epoch = PT7C4339_dateTimeToEpoch( timestamp.dateTime );
+    *fraction = timestamp.microsecond;
+    return true;
+  }
+
+  *micros = _rtc->getBus().timeMicros(); // The RTC latches its time at the start of the read
+  uint32_t now = _rtc->getEpoch();
+  if( now == 0 ) return false;
+
+  *epoch = now;
+  *fraction = PT7C4339_EVENT_UNKNOWN_FRACTION;
+  return true;
+}
+
+#endif
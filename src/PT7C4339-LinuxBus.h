@@ -0,0 +1,319 @@
+/**
+ * @file PT7C4339-LinuxBus.h
+ * @brief Header-only bus policy of the PT7C4339-RTC library for the Linux userspace I2C interface (/dev/i2c-N).
+ *
+ * Every register read is one I2C_RDWR ioctl with two messages, the register pointer write and the data read,
+ * joined by a repeated start, so reading the date and time is a single system call. Every write is one message.
+ * The adapter timeout is set with I2C_TIMEOUT, and the errno of a failed transfer is reported as a PT7C4339_status.
+ * The ioctl function can be replaced, so the backend can be tested without a kernel driver, e.g. on a regular file
+ * with a function that stands in for the device.
+ *
+ * Build without the Arduino core, with PT7C4339_NO_WIRE defined for the whole build (it is defined here if this
+ * file is included first):
+ *
+ * @code
+ * PT7C4339_Linux rtc( "/dev/i2c-1" );
+ *
+ * if( rtc.begin() == 0 ) return 1;
+ * PT7C4339_DateTime now = rtc.getDateTime(); // One ioctl
+ * @endcode
+ *
+ * @note There are no interrupts in userspace: handleSqwEdge() must be called from the thread that uses the RTC,
+ * e.g. after polling a GPIO line event, as the critical sections of PT7C4339_PosixTiming do nothing.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#ifndef _PT7C4339_LINUX_BUS_H_
+#define _PT7C4339_LINUX_BUS_H_
+
+#ifndef PT7C4339_NO_WIRE
+  #define PT7C4339_NO_WIRE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "PT7C4339-RTC-impl.h"
+
+#define PT7C4339_LINUX_DEFAULT_DEVICE "/dev/i2c-1" ///< I2C adapter used by default, the one on the header of most single board computers
+
+typedef int ( *PT7C4339_ioctlFunction )( int fd, unsigned long request, void *arg ); ///< Function issuing the I2C_RDWR requests, ioctl() by default
+
+class PT7C4339_PosixTiming ///< Timing of a bus policy from the POSIX clocks, without critical sections
+{
+  public:
+    /**
+     * @brief Returns the microseconds elapsed on the monotonic clock, wrapping like micros() of Arduino.
+     */
+    uint32_t timeMicros()
+    {
+      struct timespec ts;
+      clock_gettime( CLOCK_MONOTONIC, &ts );
+
+      return static_cast<uint32_t>( static_cast<uint64_t>( ts.tv_sec ) * 1000000ULL + ts.tv_nsec / 1000 );
+    }
+
+    /**
+     * @brief Sleeps for the given number of milliseconds.
+     */
+    void sleepMillis( uint32_t ms )
+    {
+      struct timespec ts;
+      ts.tv_sec = ms / 1000;
+      ts.tv_nsec = static_cast<long>( ms % 1000 ) * 1000000L;
+
+      while( nanosleep( &ts, &ts ) != 0 ) {}
+    }
+
+    /**
+     * @brief Does nothing, handleSqwEdge() runs on the thread of the other methods.
+     */
+    void enterCritical()
+    {
+    }
+
+    /**
+     * @brief Does nothing, handleSqwEdge() runs on the thread of the other methods.
+     */
+    void exitCritical()
+    {
+    }
+};
+
+class PT7C4339_LinuxBus : public PT7C4339_PosixTiming ///< Bus policy for the Linux userspace I2C interface, with combined I2C_RDWR transfers
+{
+  public:
+    PT7C4339_LinuxBus( const char *device = PT7C4339_LINUX_DEFAULT_DEVICE, PT7C4339_ioctlFunction ioctlFunction = nullptr, uint8_t address = PT7C4339_I2C_ADDRESS );
+    PT7C4339_LinuxBus( const PT7C4339_LinuxBus & ) = delete;
+    PT7C4339_LinuxBus &operator=( const PT7C4339_LinuxBus & ) = delete;
+    ~PT7C4339_LinuxBus();
+
+    void begin();
+    bool probe();
+    PT7C4339_status read( uint8_t REG, uint8_t *DATA, uint8_t length );
+    PT7C4339_status write( uint8_t REG, const uint8_t *DATA, uint8_t length );
+    bool recover();
+
+    uint32_t getTimeout();
+    void setTimeout( uint32_t timeoutUs );
+
+    int getFd();
+    void end();
+
+  private:
+    const char *_device;
+    PT7C4339_ioctlFunction _ioctl;
+    uint8_t _address;
+    int _fd;
+    uint32_t _timeoutUs;
+
+    PT7C4339_status transfer( struct i2c_msg *msgs, uint8_t count );
+    void applyTimeout();
+
+    static int systemIoctl( int fd, unsigned long request, void *arg );
+};
+
+typedef PT7C4339T<PT7C4339_LinuxBus> PT7C4339_Linux; ///< Class for the PT7C4339 RTC on a Linux /dev/i2c-N adapter
+
+/**
+ * @brief Constructs the bus policy, the device is opened by begin().
+ *
+ * @param device Path of the I2C adapter device node (default is /dev/i2c-1), must stay valid for the lifetime of the object.
+ * @param ioctlFunction Function issuing the I2C_RDWR requests, nullptr for the ioctl() system call.
+ * @param address The 7bit I2C address of the RTC (default is 0x68).
+ */
+inline PT7C4339_LinuxBus::PT7C4339_LinuxBus( const char *device, PT7C4339_ioctlFunction ioctlFunction, uint8_t address )
+{
+  _device = device;
+  _ioctl = ( ioctlFunction != nullptr ) ? ioctlFunction : systemIoctl;
+  _address = address;
+  _fd = -1;
+  _timeoutUs = PT7C4339_BUS_TIMEOUT_US;
+}
+
+/**
+ * @brief Closes the device node.
+ */
+inline PT7C4339_LinuxBus::~PT7C4339_LinuxBus()
+{
+  end();
+}
+
+/**
+ * @brief Opens the device node and sets the adapter timeout, called by begin() of the RTC if the RTC did not answer.
+ */
+inline void PT7C4339_LinuxBus::begin()
+{
+  end();
+  _fd = open( _device, O_RDWR | O_CLOEXEC );
+
+  applyTimeout();
+}
+
+/**
+ * @brief Checks if the RTC acknowledges its address, with a one byte read.
+ *
+ * @return bool True if the device node is open and the read was acknowledged, false otherwise.
+ */
+inline bool PT7C4339_LinuxBus::probe()
+{
+  uint8_t data;
+  struct i2c_msg msg = { _address, I2C_M_RD, 1, &data };
+
+  return transfer( &msg, 1 ) == PT7C4339_STATUS_OK;
+}
+
+/**
+ * @brief Reads consecutive registers with one I2C_RDWR ioctl: the register pointer write, a repeated start and the data read.
+ *
+ * @param REG The address of the first register to read.
+ * @param DATA Buffer of at least length bytes that receives the register values.
+ * @param length The number of registers to read.
+ * @return PT7C4339_status PT7C4339_STATUS_OK if the transfer succeeded, otherwise the reason of the failure.
+ */
+inline PT7C4339_status PT7C4339_LinuxBus::read( uint8_t REG, uint8_t *DATA, uint8_t length )
+{
+  struct i2c_msg msgs[2] =
+  {
+    { _address, 0, 1, &REG },
+    { _address, I2C_M_RD, length, DATA }
+  };
+
+  return transfer( msgs, 2 );
+}
+
+/**
+ * @brief Writes consecutive registers with one I2C_RDWR ioctl, the register address followed by the data bytes.
+ *
+ * @param REG The address of the first register to write.
+ * @param DATA The data bytes to write.
+ * @param length The number of registers to write (1-17).
+ * @return PT7C4339_status PT7C4339_STATUS_OK if the transfer succeeded, otherwise the reason of the failure.
+ */
+inline PT7C4339_status PT7C4339_LinuxBus::write( uint8_t REG, const uint8_t *DATA, uint8_t length )
+{
+  if( length > PT7C4339_REGISTER_COUNT ) return PT7C4339_STATUS_BUS_ERROR;
+
+  uint8_t buf[1 + PT7C4339_REGISTER_COUNT];
+  buf[0] = REG;
+  memcpy( buf + 1, DATA, length );
+
+  struct i2c_msg msg = { _address, 0, static_cast<__u16>( 1 + length ), buf };
+
+  return transfer( &msg, 1 );
+}
+
+/**
+ * @brief Opens the device node again, after a transfer timed out.
+ *
+ * Userspace can not drive the lines: the adapter drivers with bus recovery support clock SCL to free SDA themselves
+ * when a transfer times out. Reopening the device node resets the state of the file descriptor and applies the timeout again.
+ *
+ * @return bool True if the device node is open again, false otherwise.
+ */
+inline bool PT7C4339_LinuxBus::recover()
+{
+  begin();
+
+  return _fd >= 0;
+}
+
+/**
+ * @brief Gets the adapter timeout of a transfer.
+ *
+ * @return uint32_t The timeout in microseconds, PT7C4339_BUS_TIMEOUT_US by default.
+ */
+inline uint32_t PT7C4339_LinuxBus::getTimeout()
+{
+  return _timeoutUs;
+}
+
+/**
+ * @brief Sets the adapter timeout of a transfer, after which it fails with ETIMEDOUT, reported as PT7C4339_STATUS_TIMEOUT.
+ *
+ * The kernel takes it in units of 10ms, so it is rounded up. The timeout belongs to the adapter, shared by every
+ * user of the device node.
+ *
+ * @param timeoutUs The timeout in microseconds, 0 keeps the default of the adapter driver.
+ */
+inline void PT7C4339_LinuxBus::setTimeout( uint32_t timeoutUs )
+{
+  _timeoutUs = timeoutUs;
+
+  applyTimeout();
+}
+
+/**
+ * @brief Gets the file descriptor of the device node.
+ *
+ * @return int The file descriptor, -1 if the device node is not open.
+ */
+inline int PT7C4339_LinuxBus::getFd()
+{
+  return _fd;
+}
+
+/**
+ * @brief Closes the device node, the next begin() of the RTC opens it again.
+ */
+inline void PT7C4339_LinuxBus::end()
+{
+  if( _fd >= 0 ) close( _fd );
+  _fd = -1;
+}
+
+/**
+ * @brief Issues the messages as one combined transfer, with a single stop at the end.
+ *
+ * @param msgs The messages of the transfer.
+ * @param count The number of messages.
+ * @return PT7C4339_status PT7C4339_STATUS_OK if the ioctl transferred every message, PT7C4339_STATUS_TIMEOUT (ETIMEDOUT),
+ *         PT7C4339_STATUS_NACK (ENXIO, EREMOTEIO, EIO), PT7C4339_STATUS_SHORT_READ if only some of the messages were transferred,
+ *         or PT7C4339_STATUS_BUS_ERROR if the device node is not open or the driver failed otherwise.
+ */
+inline PT7C4339_status PT7C4339_LinuxBus::transfer( struct i2c_msg *msgs, uint8_t count )
+{
+  if( _fd < 0 ) return PT7C4339_STATUS_BUS_ERROR;
+
+  struct i2c_rdwr_ioctl_data data = { msgs, count };
+
+  int transferred = _ioctl( _fd, I2C_RDWR, &data );
+  if( transferred == count ) return PT7C4339_STATUS_OK;
+  if( transferred >= 0 ) return PT7C4339_STATUS_SHORT_READ;
+
+  if( errno == ETIMEDOUT ) return PT7C4339_STATUS_TIMEOUT;
+  if( errno == ENXIO || errno == EREMOTEIO || errno == EIO ) return PT7C4339_STATUS_NACK;
+
+  return PT7C4339_STATUS_BUS_ERROR;
+}
+
+/**
+ * @brief Sets the adapter timeout with I2C_TIMEOUT, if the device node is open and a timeout is set.
+ */
+inline void PT7C4339_LinuxBus::applyTimeout()
+{
+  if( _fd < 0 || _timeoutUs == 0 ) return;
+
+  uintptr_t ticks = ( _timeoutUs + 9999 ) / 10000; // I2C_TIMEOUT takes its value, not a pointer, in units of 10ms
+  _ioctl( _fd, I2C_TIMEOUT, reinterpret_cast<void *>( ticks ) );
+}
+
+/**
+ * @brief Default ioctl function of the bus policy, the system call itself.
+ */
+inline int PT7C4339_LinuxBus::systemIoctl( int fd, unsigned long request, void *arg )
+{
+  return ioctl( fd, request, arg );
+}
+
+#endif
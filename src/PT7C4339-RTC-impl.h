@@ -0,0 +1,3359 @@
+/**
+ * @file PT7C4339-RTC-impl.h
+ * @brief Member function definitions of the PT7C4339T class template.
+ *
+ * PT7C4339, the class for the Wire bus policy, is instantiated once in PT7C4339-RTC.cpp, so sketches only need PT7C4339-RTC.h.
+ * Include this file instead of PT7C4339-RTC.h to use PT7C4339T with another bus policy: the methods are then
+ * instantiated for it where they are used, and inlined with the calls of the bus policy.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#ifndef _PT7C4339_RTC_IMPL_H_
+#define _PT7C4339_RTC_IMPL_H_
+
+#include "PT7C4339-RTC.h"
+
+#ifdef PT7C4339_ENABLE_STATS
+  #define PT7C4339_TRACE( method )                  StatsScope statsScope( this, method ) ///< Attributes the bus traffic of the enclosing call to method
+  #define PT7C4339_COUNT_TRANSACTION( bytes, nack ) countTransaction( bytes, nack ) ///< Counts one I2C transaction
+  #define PT7C4339_COUNT_VERIFY_MISMATCH()          countVerifyMismatch() ///< Counts one failed write verification
+#else
+  #define PT7C4339_TRACE( method )
+  #define PT7C4339_COUNT_TRANSACTION( bytes, nack )
+  #define PT7C4339_COUNT_VERIFY_MISMATCH()
+#endif
+
+/**
+ * @brief Register values written by reset(), 2000-01-01 00:00:00, alarms cleared, 32.768kHz square wave.
+ */
+template<class Bus>
+const uint8_t PT7C4339T<Bus>::resetImage[PT7C4339_REGISTER_COUNT] =
+{
+  0x00, 0x00, 0x00, 0x01, 0x01, 0x81, 0x00, // Timekeeping
+  0x00, 0x00, 0x00, 0x00, // Alarm 1
+  0x00, 0x00, 0x00, // Alarm 2
+  0x18, 0x80, 0x00 // Control, status, trickle charger
+};
+
+/**
+ * @brief Puts every member except the bus policy into its initial state, called by the constructor.
+ */
+template<class Bus>
+void PT7C4339T<Bus>::init()
+{
+  _lastStatus = PT7C4339_STATUS_OK;
+  _retryBudget = 0;
+
+  _cacheEnabled = false;
+  _cacheValid = false;
+
+  _verifyPolicy = PT7C4339_VERIFY_ALWAYS;
+  _pendingVerifyMask = 0;
+
+  _updateActive = false;
+  _stagedMask = 0;
+
+  _softClockEnabled = false;
+  _softClockSynced = false;
+  _softResyncInterval = PT7C4339_SOFT_CLOCK_DEFAULT_RESYNC;
+  _sqwEdges = 0;
+  _sqwLatch = 0;
+  _softNow = {};
+  _softNowEdges = 0;
+  _softSyncEdges = 0;
+
+  _asyncOperation = PT7C4339_ASYNC_NONE;
+  _asyncStatus = PT7C4339_ASYNC_IDLE;
+  _asyncStep = 0;
+  _asyncOffset = 0;
+  _asyncWaitStart = 0;
+  _asyncDateTime = {};
+
+  _onAlarm1 = nullptr;
+  _onAlarm2 = nullptr;
+  _interruptPending = false;
+
+#ifdef PT7C4339_ENABLE_STATS
+  _statsMethod = PT7C4339_API_COUNT;
+  _statsActive = nullptr;
+  resetStats();
+#endif
+}
+
+/**
+ * @brief Gets the bus policy the RTC is accessed through.
+ *
+ * @return Bus& The bus policy object, constructed from the arguments of the constructor.
+ */
+template<class Bus>
+Bus &PT7C4339T<Bus>::getBus()
+{
+  return _bus;
+}
+
+/**
+ * @brief Initializes the PT7C4339 RTC over I2C.
+ *
+ * This function attempts to establish I2C communication with the PT7C4339 RTC.
+ * If the initial transmission fails, it will initialize the bus with the begin() of the bus policy,
+ * which for Wire uses either the default or the custom SDA/SCL pins and the specified frequency.
+ * Every register is then read with a single burst read of 0x00-0x10, which covers the checks of the 12-hour mode
+ * bits of the time, alarm 1 and alarm 2, and the stop flag. If the register cache is enabled, it is filled from the same read.
+ * The RTC is set to 24-hour mode if it was previously in 12-hour mode, which takes a verified write per register.
+ *
+ * @return uint8_t
+ *         - 0: Initialization failed (I2C communication error or failed to set 24-hour mode)
+ *         - 1: Initialization successful and RTC is in 24-hour mode
+ *         - 2: Initialization successful but RTC stop flag is set - power failure or was reset
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::begin()
+{
+  PT7C4339_TRACE( PT7C4339_API_BEGIN );
+  bool found = _bus.probe();
+  PT7C4339_COUNT_TRANSACTION( 1, !found );
+
+  if( !found )
+  {
+    _bus.begin();
+
+    found = _bus.probe();
+    PT7C4339_COUNT_TRANSACTION( 1, !found );
+
+    if( !found ) return 0;
+  }
+
+  uint8_t image[PT7C4339_REGISTER_COUNT];
+  if( !readBus( PT7C4339_REG_SECONDS, image, PT7C4339_REGISTER_COUNT ) )
+  {
+    _cacheValid = false;
+    return 0;
+  }
+
+  if( _cacheEnabled )
+  {
+    memcpy( _cache, image + PT7C4339_CACHE_FIRST_REG, PT7C4339_CACHE_SIZE );
+    _cacheValid = true;
+  }
+
+  const uint8_t hoursRegisters[3] = { PT7C4339_REG_HOURS, PT7C4339_REG_A1_HOURS, PT7C4339_REG_A2_HOURS };
+  for( uint8_t i = 0; i < 3; i++ )
+  {
+    uint8_t hours = image[hoursRegisters[i]];
+    bool is12H = hours & 0x40;
+    if( is12H && !writeRegister( hoursRegisters[i], hours & 0xBF ) ) return 0;
+  }
+
+  if( image[PT7C4339_REG_STATUS] & 0x80 ) return 2;
+  else return 1;
+}
+
+/**
+ * @brief Saves the state of the object that resume() needs to skip begin() after deep sleep.
+ *
+ * The state holds the register cache, if it is enabled and valid. Keep it in RAM that is retained across deep sleep
+ * (e.g. RTC_DATA_ATTR on the ESP32) and save it again right before sleeping, so it holds the latest writes.
+ * Takes no I2C traffic.
+ *
+ * @return PT7C4339_ResumeState The state to pass to resume() after waking up.
+ */
+template<class Bus>
+PT7C4339_ResumeState PT7C4339T<Bus>::getResumeState()
+{
+  PT7C4339_ResumeState state;
+  memset( &state, 0, sizeof( state ) );
+  state.flags = PT7C4339_RESUME_MAGIC;
+
+  if( _cacheEnabled && _cacheValid )
+  {
+    memcpy( state.cache.registers, _cache + ( PT7C4339_CONFIG_FIRST_REG - PT7C4339_CACHE_FIRST_REG ), PT7C4339_CONFIG_SIZE );
+    state.flags |= PT7C4339_RESUME_CACHE_VALID;
+  }
+
+  state.cache.checksum = configChecksum( state.cache.registers ) ^ state.flags;
+
+  return state;
+}
+
+/**
+ * @brief Initializes the RTC after a wake-up from deep sleep, from a state saved by getResumeState(), without any I2C traffic.
+ *
+ * The bus is initialized with the begin() of the bus policy, as the peripheral lost its state in deep sleep, but the RTC is
+ * not probed and no register is read: the device kept running on its own, and begin() already set it to 24-hour mode
+ * before the state was saved. The register cache is enabled and restored if it was valid when the state was saved,
+ * otherwise an enabled cache is refilled on its next use.
+ * If the state is invalid, e.g. the retained RAM holds garbage after a cold boot, this falls back to begin().
+ *
+ * @param state The state saved by getResumeState() before going to deep sleep.
+ * @return uint8_t
+ *         - 0: The state was invalid and begin() failed
+ *         - 1: Resumed from the state, or the state was invalid and begin() succeeded
+ *         - 2: The state was invalid, and begin() found the RTC stop flag set
+ *
+ * @note The stop flag is not checked on a resume. Call getRtcStopFlag() if the backup supply of the RTC may have failed during the sleep.
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::resume( PT7C4339_ResumeState state )
+{
+  PT7C4339_TRACE( PT7C4339_API_RESUME );
+  bool valid = ( state.flags & 0xF0 ) == PT7C4339_RESUME_MAGIC && ( state.flags & 0x0E ) == 0
+    && state.cache.checksum == ( configChecksum( state.cache.registers ) ^ state.flags );
+
+  if( !valid ) return begin();
+
+  _bus.begin();
+
+  _cacheValid = false;
+  if( state.flags & PT7C4339_RESUME_CACHE_VALID )
+  {
+    memcpy( _cache + ( PT7C4339_CONFIG_FIRST_REG - PT7C4339_CACHE_FIRST_REG ), state.cache.registers, PT7C4339_CONFIG_SIZE );
+    _cacheEnabled = true;
+    _cacheValid = true;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Checks if the register cache is enabled.
+ *
+ * @return bool True if the register cache is enabled, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::isRegisterCacheEnabled()
+{
+  return _cacheEnabled;
+}
+
+/**
+ * @brief Enables or disables the register cache of the alarm, control and trickle charger registers.
+ *
+ * When enabled, registers 0x07-0x10 are kept in a shadow copy that is filled by one burst read,
+ * and kept up to date by every write. Reads of these registers, including the read half of every
+ * read-modify-write, are then served from the shadow copy without any I2C traffic.
+ * The status register (0x0F) is never served from the cache, as the OSF, A1F and A2F flags are set by the device.
+ *
+ * @param enable Set to true to enable the cache, false to disable it.
+ * @return bool True if the operation was successful, false if the cache could not be filled.
+ *
+ * @note The cache assumes that nothing else writes the registers of the device. If the registers may have changed
+ * without the library knowing, e.g. after a power failure, call refreshRegisterCache() or begin().
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::enableRegisterCache( bool enable )
+{
+  PT7C4339_TRACE( PT7C4339_API_ENABLE_REGISTER_CACHE );
+  _cacheEnabled = enable;
+  _cacheValid = false;
+
+  if( enable ) return refreshRegisterCache();
+  else return true;
+}
+
+/**
+ * @brief Refills the register cache from the device with a single burst read of registers 0x07-0x10.
+ *
+ * @return bool True if the cache was refilled, false if the cache is disabled or the read failed.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::refreshRegisterCache()
+{
+  PT7C4339_TRACE( PT7C4339_API_REFRESH_REGISTER_CACHE );
+  if( !_cacheEnabled ) return false;
+
+  _cacheValid = readBus( PT7C4339_CACHE_FIRST_REG, _cache, PT7C4339_CACHE_SIZE );
+
+  return _cacheValid;
+}
+
+/**
+ * @brief Retrieves the write verification policy.
+ *
+ * @return PT7C4339_verifyPolicy The current write verification policy.
+ */
+template<class Bus>
+PT7C4339_verifyPolicy PT7C4339T<Bus>::getVerifyPolicy()
+{
+  return _verifyPolicy;
+}
+
+/**
+ * @brief Sets how register writes are verified.
+ *
+ * - PT7C4339_VERIFY_ALWAYS: every write is followed by a read back of the written registers (default).
+ * - PT7C4339_VERIFY_NEVER: writes are only checked for an I2C acknowledge, halving the bus cost of every setter.
+ * - PT7C4339_VERIFY_DEFERRED: written values are recorded, and checked together by verifyPendingWrites()
+ *   with a single burst read of the affected range.
+ *
+ * @param policy The write verification policy to use.
+ *
+ * @note In deferred mode, writes to the timekeeping registers (0x00-0x06) and the status register are still
+ * verified immediately, as the device changes these registers by itself and a late read back could not be compared.
+ */
+template<class Bus>
+void PT7C4339T<Bus>::setVerifyPolicy( PT7C4339_verifyPolicy policy )
+{
+  _verifyPolicy = policy;
+}
+
+/**
+ * @brief Verifies every write recorded in deferred verification mode with a single burst read.
+ *
+ * This function reads back the range between the lowest and highest register written since the last call,
+ * and compares every written register with the last value written to it. The record is cleared afterwards.
+ *
+ * @param mismatchRegister Optional pointer that receives the address of the first register that did not match,
+ *        or PT7C4339_REG_NONE if every register matched or the read back failed.
+ * @return bool True if every recorded write was verified successfully (or there was nothing to verify), false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::verifyPendingWrites( uint8_t *mismatchRegister )
+{
+  PT7C4339_TRACE( PT7C4339_API_VERIFY_PENDING_WRITES );
+  if( mismatchRegister != nullptr ) *mismatchRegister = PT7C4339_REG_NONE;
+  if( _pendingVerifyMask == 0 ) return true;
+
+  uint8_t first = 0;
+  while( !( _pendingVerifyMask & ( 1UL << first ) ) ) first++;
+
+  uint8_t last = PT7C4339_REGISTER_COUNT - 1;
+  while( !( _pendingVerifyMask & ( 1UL << last ) ) ) last--;
+
+  uint32_t mask = _pendingVerifyMask;
+  _pendingVerifyMask = 0;
+
+  uint8_t readBack[PT7C4339_REGISTER_COUNT];
+  if( !readBus( first, readBack, last - first + 1 ) )
+  {
+    _cacheValid = false;
+    return false;
+  }
+
+  updateCache( first, readBack, last - first + 1 );
+
+  for( uint8_t reg = first; reg <= last; reg++ )
+  {
+    if( ( mask & ( 1UL << reg ) ) && _image[reg] != readBack[reg - first] )
+    {
+      if( mismatchRegister != nullptr ) *mismatchRegister = reg;
+      _lastStatus = PT7C4339_STATUS_VERIFY_MISMATCH;
+      PT7C4339_COUNT_VERIFY_MISMATCH();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Starts collecting register writes into a pending register image instead of sending them.
+ *
+ * Between beginUpdate() and commit(), every setter only stages its changes, and reads of staged registers
+ * return the staged values, so setters can be combined freely. The setters return true if the change was staged;
+ * the result of the actual write is returned by commit(). While a non-blocking operation is in progress, nothing can be staged
+ * and the setters return false. Staging a register drops the deferred verification of its earlier write.
+ */
+template<class Bus>
+void PT7C4339T<Bus>::beginUpdate()
+{
+  _updateActive = true;
+  _stagedMask = 0;
+}
+
+/**
+ * @brief Writes every register staged since beginUpdate() in the fewest auto-increment bursts, then verifies them once.
+ *
+ * Staged registers are merged into contiguous runs. Runs separated only by registers held in the register cache
+ * are joined by rewriting the cached values, so that a change of e.g. the alarm 1 registers and the control
+ * register goes out as one transaction. The written registers are then verified according to the verification policy,
+ * with a single burst read covering every run. Flag clears staged in the status register are not read back, see clearStatusFlags().
+ *
+ * @return bool True if every staged register was written (and verified, if applicable), false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::commit()
+{
+  PT7C4339_TRACE( PT7C4339_API_COMMIT );
+  _updateActive = false;
+
+  uint32_t mask = _stagedMask;
+  _stagedMask = 0;
+
+  if( mask == 0 ) return true;
+
+  uint8_t first = PT7C4339_REG_NONE;
+  uint8_t last = 0;
+  bool selfChanging = false;
+
+  uint8_t reg = 0;
+  while( reg < PT7C4339_REGISTER_COUNT )
+  {
+    if( !( mask & ( 1UL << reg ) ) )
+    {
+      reg++;
+      continue;
+    }
+
+    uint8_t start = reg;
+    uint8_t end = reg;
+    uint8_t next = reg + 1;
+
+    while( next < PT7C4339_REGISTER_COUNT )
+    {
+      uint8_t probe = next;
+      while( probe < PT7C4339_REGISTER_COUNT && !( mask & ( 1UL << probe ) ) && isCached( probe ) ) probe++;
+
+      if( probe < PT7C4339_REGISTER_COUNT && ( mask & ( 1UL << probe ) ) )
+      {
+        end = probe;
+        next = probe + 1;
+      }
+      else break;
+    }
+
+    uint8_t buf[PT7C4339_REGISTER_COUNT];
+    uint8_t length = end - start + 1;
+
+    for( uint8_t i = 0; i < length; i++ )
+    {
+      uint8_t runReg = start + i;
+
+      if( mask & ( 1UL << runReg ) ) buf[i] = _image[runReg];
+      else buf[i] = _cache[runReg - PT7C4339_CACHE_FIRST_REG];
+
+      if( runReg < PT7C4339_CACHE_FIRST_REG ) selfChanging = true;
+    }
+
+    if( !writeBus( start, buf, length ) )
+    {
+      _cacheValid = false;
+      return false;
+    }
+
+    updateCache( start, buf, length );
+
+    if( first == PT7C4339_REG_NONE ) first = start;
+    last = end;
+    reg = end + 1;
+  }
+
+  mask &= ~( 1UL << PT7C4339_REG_STATUS ); // A cleared flag may be set again by the device before the read back
+  if( mask == 0 || _verifyPolicy == PT7C4339_VERIFY_NEVER ) return true;
+
+  if( _verifyPolicy == PT7C4339_VERIFY_DEFERRED && !selfChanging )
+  {
+    _pendingVerifyMask |= mask; // The image already holds the staged values
+
+    return true;
+  }
+
+  first = 0;
+  while( !( mask & ( 1UL << first ) ) ) first++;
+
+  last = PT7C4339_REGISTER_COUNT - 1;
+  while( !( mask & ( 1UL << last ) ) ) last--;
+
+  uint8_t readBack[PT7C4339_REGISTER_COUNT];
+  if( !readBus( first, readBack, last - first + 1 ) )
+  {
+    _cacheValid = false;
+    return false;
+  }
+
+  updateCache( first, readBack, last - first + 1 );
+
+  for( uint8_t i = first; i <= last; i++ )
+  {
+    if( ( mask & ( 1UL << i ) ) && _image[i] != readBack[i - first] )
+    {
+      _lastStatus = PT7C4339_STATUS_VERIFY_MISMATCH;
+      PT7C4339_COUNT_VERIFY_MISMATCH();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Discards every register write staged since beginUpdate().
+ */
+template<class Bus>
+void PT7C4339T<Bus>::cancelUpdate()
+{
+  _updateActive = false;
+  _stagedMask = 0;
+}
+
+/**
+ * @brief Saves the configuration registers 0x07-0x10 (alarms, control, trickle charger) into a compact blob.
+ *
+ * The registers are read with one burst read, or served from the register cache without bus traffic.
+ * Inside an update started with beginUpdate(), the staged values are saved. The status register is stored as 0,
+ * as its flags are state, not configuration. The blob is plain data with a checksum: it can be kept in EEPROM or flash,
+ * and restored with applyConfig() after the oscillator stopped or the device lost its backup supply.
+ *
+ * @return PT7C4339_Config The saved configuration. If the read failed, every byte is 0 and applyConfig() rejects it.
+ */
+template<class Bus>
+PT7C4339_Config PT7C4339T<Bus>::saveConfig()
+{
+  PT7C4339_TRACE( PT7C4339_API_SAVE_CONFIG );
+  PT7C4339_Config config;
+
+  if( !readConfigImage( config.registers ) )
+  {
+    memset( &config, 0, sizeof( config ) );
+    return config;
+  }
+
+  for( uint8_t i = 0; i < PT7C4339_CONFIG_SIZE; i++ )
+  {
+    if( isStaged( PT7C4339_CONFIG_FIRST_REG + i ) ) config.registers[i] = _image[PT7C4339_CONFIG_FIRST_REG + i];
+  }
+
+  config.registers[PT7C4339_REG_STATUS - PT7C4339_CONFIG_FIRST_REG] = 0;
+  config.checksum = configChecksum( config.registers );
+
+  return config;
+}
+
+/**
+ * @brief Restores a configuration saved by saveConfig(), writing only the registers that differ from the device.
+ *
+ * The current registers are read with one burst read, also with the register cache enabled, as the cache can not
+ * see a power loss of the device, and the cache is refilled from the same read. They are compared to the saved ones,
+ * and the span from the first to the last differing register is written with one auto-increment burst.
+ * Unchanged registers inside the span are rewritten with their saved value, and the status register is written
+ * as 0x83, which leaves its flags untouched. The span is then verified according to the verification policy.
+ * A typical restore after a stop flag is one read, one write and one verifying read, instead of a reset() and
+ * a verified write per setter. Inside an update started with beginUpdate(), the registers are only staged for commit().
+ *
+ * @param config The configuration to restore.
+ * @return bool True if the configuration was written (and verified, if applicable), staged, or already matched,
+ *         false if the checksum is wrong (with PT7C4339_STATUS_OK as the last status), the transfer failed,
+ *         or it could not be staged because a non-blocking operation is in progress.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::applyConfig( PT7C4339_Config config )
+{
+  PT7C4339_TRACE( PT7C4339_API_APPLY_CONFIG );
+  if( config.checksum != configChecksum( config.registers ) ) return false;
+
+  const uint8_t statusIndex = PT7C4339_REG_STATUS - PT7C4339_CONFIG_FIRST_REG;
+  config.registers[statusIndex] = 0x83; // Writing 1 leaves OSF, A2F and A1F unchanged
+
+  if( _updateActive )
+  {
+    return writeRegisters( PT7C4339_CONFIG_FIRST_REG, config.registers, statusIndex ) &&
+           writeRegisters( PT7C4339_REG_STATUS + 1, config.registers + statusIndex + 1, PT7C4339_CONFIG_SIZE - statusIndex - 1 );
+  }
+
+  uint8_t current[PT7C4339_CONFIG_SIZE];
+  if( !readBus( PT7C4339_CONFIG_FIRST_REG, current, PT7C4339_CONFIG_SIZE ) ) return false; // Never the cache, the device may have lost power since
+
+  updateCache( PT7C4339_CONFIG_FIRST_REG, current, PT7C4339_CONFIG_SIZE );
+
+  uint8_t first = PT7C4339_CONFIG_SIZE;
+  uint8_t last = 0;
+
+  for( uint8_t i = 0; i < PT7C4339_CONFIG_SIZE; i++ )
+  {
+    if( i == statusIndex || current[i] == config.registers[i] ) continue;
+
+    if( first == PT7C4339_CONFIG_SIZE ) first = i;
+    last = i;
+  }
+
+  if( first == PT7C4339_CONFIG_SIZE ) return true;
+
+  uint8_t REG = PT7C4339_CONFIG_FIRST_REG + first;
+  uint8_t length = last - first + 1;
+
+  if( !writeBus( REG, config.registers + first, length ) )
+  {
+    _cacheValid = false;
+    return false;
+  }
+
+  if( _verifyPolicy == PT7C4339_VERIFY_NEVER )
+  {
+    updateCache( REG, config.registers + first, length );
+    return true;
+  }
+
+  if( _verifyPolicy == PT7C4339_VERIFY_DEFERRED && _asyncStatus != PT7C4339_ASYNC_BUSY ) // The image holds the data of the operation
+  {
+    for( uint8_t i = first; i <= last; i++ )
+    {
+      if( i == statusIndex ) continue;
+
+      _image[PT7C4339_CONFIG_FIRST_REG + i] = config.registers[i];
+      _pendingVerifyMask |= ( 1UL << ( PT7C4339_CONFIG_FIRST_REG + i ) );
+    }
+
+    updateCache( REG, config.registers + first, length );
+    return true;
+  }
+
+  uint8_t readBack[PT7C4339_CONFIG_SIZE];
+  if( !readBus( REG, readBack, length ) )
+  {
+    _cacheValid = false;
+    return false;
+  }
+
+  updateCache( REG, readBack, length );
+
+  for( uint8_t i = first; i <= last; i++ )
+  {
+    if( i != statusIndex && readBack[i - first] != config.registers[i] )
+    {
+      _lastStatus = PT7C4339_STATUS_VERIFY_MISMATCH;
+      PT7C4339_COUNT_VERIFY_MISMATCH();
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Gets the outcome of the latest bus transfer, write verification or BCD check.
+ *
+ * Every method keeps its bool or value result; after a failure, this tells why it failed.
+ * A method that returned false while the status is PT7C4339_STATUS_OK rejected its arguments without any bus traffic.
+ *
+ * @return PT7C4339_status The status of the latest transfer or check, PT7C4339_STATUS_OK if it succeeded.
+ */
+template<class Bus>
+PT7C4339_status PT7C4339T<Bus>::getLastStatus()
+{
+  return _lastStatus;
+}
+
+/**
+ * @brief Gets the number of times a failed transfer is repeated.
+ *
+ * @return uint8_t The retry budget set with setRetryBudget(), 0 by default.
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::getRetryBudget()
+{
+  return _retryBudget;
+}
+
+/**
+ * @brief Sets the number of times a failed transfer is repeated before the method gives up.
+ *
+ * A transfer that timed out recovers the bus with recoverBus() before the next attempt, whatever the budget.
+ * As every transaction of the bus policy gives up after its timeout (PT7C4339_BUS_TIMEOUT_US by default),
+ * a transfer takes at most ( retries + 1 ) times the timeout and the recovery, which bounds every method:
+ * e.g. setAlarm1() with one retry on a stuck bus returns after two timeouts and two recoveries, about 50ms with the defaults.
+ *
+ * @param retries The number of repeated attempts of each transfer (0, the default, makes one attempt).
+ */
+template<class Bus>
+void PT7C4339T<Bus>::setRetryBudget( uint8_t retries )
+{
+  _retryBudget = retries;
+}
+
+/**
+ * @brief Frees a stuck bus and initializes it again with the recover() of the bus policy.
+ *
+ * With Wire, SCL is clocked until the slave holding SDA low releases it, then a STOP is sent and the bus is initialized
+ * like by begin(). The register cache is refilled on its next use, as an interrupted write may have changed the device.
+ *
+ * @return bool True if the bus is idle after the recovery, false if a line is still held low.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::recoverBus()
+{
+  _cacheValid = false;
+
+  return _bus.recover();
+}
+
+#ifdef PT7C4339_ENABLE_STATS
+/**
+ * @brief Retrieves the bus statistics collected for a public method since the last resetStats().
+ *
+ * Every I2C transaction is attributed to the outermost public method that caused it, so e.g. the reads
+ * done by getTime() count towards getTime() and not towards getDateTime().
+ *
+ * @param method The method to retrieve the statistics of.
+ * @return PT7C4339_ApiStats Snapshot of the counters of the method, all 0 for an invalid method or a method without a slot.
+ * A method called while every slot was taken has no slot, which getUntrackedCalls() tells apart from a method never called.
+ */
+template<class Bus>
+PT7C4339_ApiStats PT7C4339T<Bus>::getApiStats( PT7C4339_apiMethod method )
+{
+  PT7C4339_ApiStats stats = {};
+
+  PT7C4339_ApiStats *slot = statsSlot( method, false );
+  if( slot != nullptr ) stats = *slot;
+
+  return stats;
+}
+
+/**
+ * @brief Clears the bus statistics of every method and frees every slot.
+ */
+template<class Bus>
+void PT7C4339T<Bus>::resetStats()
+{
+  memset( _stats, 0, sizeof( _stats ) );
+  memset( _statsSlotMethods, PT7C4339_API_COUNT, sizeof( _statsSlotMethods ) );
+  _statsUntrackedCalls = 0;
+
+  if( _statsMethod != PT7C4339_API_COUNT ) _statsActive = statsSlot( _statsMethod, true );
+}
+
+/**
+ * @brief Reserves one of the PT7C4339_STATS_SLOTS slots of counters for a public method.
+ *
+ * Without it, the slots are taken by the methods in the order they are first called after resetStats(),
+ * and the calls of the methods left without a slot are not counted. Reserve the methods to measure right after resetStats().
+ *
+ * @param method The method to count the calls of.
+ * @return bool True if the method has a slot, false if the method is invalid or every slot is taken.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::trackApiStats( PT7C4339_apiMethod method )
+{
+  return statsSlot( method, true ) != nullptr;
+}
+
+/**
+ * @brief Gets the number of calls not counted since the last resetStats(), because every slot was taken by other methods.
+ *
+ * @return uint32_t The number of public method calls left without a slot, 0 if every call was counted.
+ */
+template<class Bus>
+uint32_t PT7C4339T<Bus>::getUntrackedCalls()
+{
+  return _statsUntrackedCalls;
+}
+
+/**
+ * @brief Finds the slot of counters of a method.
+ *
+ * @param method The method to find the slot of.
+ * @param claim True to take a free slot if the method has none yet.
+ * @return PT7C4339_ApiStats* The counters of the method, nullptr if it has no slot.
+ */
+template<class Bus>
+PT7C4339_ApiStats *PT7C4339T<Bus>::statsSlot( PT7C4339_apiMethod method, bool claim )
+{
+  if( method >= PT7C4339_API_COUNT ) return nullptr;
+
+  for( uint8_t i = 0; i < PT7C4339_STATS_SLOTS; i++ )
+  {
+    if( _statsSlotMethods[i] == method ) return &_stats[i];
+  }
+
+  if( !claim ) return nullptr;
+
+  for( uint8_t i = 0; i < PT7C4339_STATS_SLOTS; i++ )
+  {
+    if( _statsSlotMethods[i] == PT7C4339_API_COUNT )
+    {
+      _statsSlotMethods[i] = method;
+      return &_stats[i];
+    }
+  }
+
+  return nullptr;
+}
+
+/**
+ * @brief Starts attributing bus traffic to a public method, unless a call of another public method is already being traced.
+ *
+ * @param rtc The RTC object the method was called on.
+ * @param method The method that was called.
+ */
+template<class Bus>
+PT7C4339T<Bus>::StatsScope::StatsScope( PT7C4339T *rtc, PT7C4339_apiMethod method )
+{
+  _rtc = rtc;
+  _owner = ( rtc->_statsMethod == PT7C4339_API_COUNT );
+  _start = 0;
+
+  if( _owner )
+  {
+    rtc->_statsMethod = method;
+    rtc->_statsActive = rtc->statsSlot( method, true );
+    if( rtc->_statsActive != nullptr ) rtc->_statsActive->calls++;
+    else rtc->_statsUntrackedCalls++;
+    _start = rtc->_bus.timeMicros();
+  }
+}
+
+/**
+ * @brief Records the duration of the traced call in the latency histogram of its method.
+ */
+template<class Bus>
+PT7C4339T<Bus>::StatsScope::~StatsScope()
+{
+  if( !_owner ) return;
+
+  uint32_t elapsed = _rtc->_bus.timeMicros() - _start;
+
+  uint8_t bucket = 0;
+  while( bucket < PT7C4339_STATS_BUCKETS - 1 && elapsed >= ( 64UL << bucket ) ) bucket++;
+
+  if( _rtc->_statsActive != nullptr )
+  {
+    uint16_t *count = &_rtc->_statsActive->latencyHistogram[bucket];
+    if( *count < 0xFFFF ) ( *count )++;
+  }
+
+  _rtc->_statsMethod = PT7C4339_API_COUNT;
+  _rtc->_statsActive = nullptr;
+}
+
+/**
+ * @brief Counts an I2C transaction towards the method being traced.
+ *
+ * @param bytes The number of bytes on the wire, including the address byte.
+ * @param nack True if the transaction was not acknowledged or returned fewer bytes than requested.
+ */
+template<class Bus>
+void PT7C4339T<Bus>::countTransaction( uint8_t bytes, bool nack )
+{
+  if( _statsActive == nullptr ) return;
+
+  PT7C4339_ApiStats *stats = _statsActive;
+  stats->transactions++;
+  stats->bytes += bytes;
+  if( nack && stats->nacks < 0xFFFF ) stats->nacks++;
+}
+
+/**
+ * @brief Counts a failed write verification towards the method being traced.
+ */
+template<class Bus>
+void PT7C4339T<Bus>::countVerifyMismatch()
+{
+  if( _statsActive == nullptr ) return;
+
+  if( _statsActive->verifyMismatches < 0xFFFF ) _statsActive->verifyMismatches++;
+}
+#endif
+
+/**
+ * @brief Places the RTC behind a channel of an I2C multiplexer.
+ *
+ * From then on, every bus access of this object first selects the channel with PT7C4339_Mux::select(),
+ * which writes nothing while the channel is still selected. Several PT7C4339 objects can share a multiplexer.
+ * Needs a bus policy with multiplexer support, like PT7C4339_WireBus. The channel selects are counted by
+ * PT7C4339_Mux::getWriteCount(), not by the bus statistics of the methods.
+ *
+ * @param mux The multiplexer the RTC is connected to, or nullptr if it is connected to the bus directly.
+ * @param channel The channel of the multiplexer (0-7), ignored if mux is nullptr.
+ * @return bool True if the setting was accepted, false if the channel is invalid.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setMux( PT7C4339_Mux *mux, uint8_t channel )
+{
+  return _bus.setMux( mux, channel );
+}
+
+/**
+ * @brief Gets the multiplexer the RTC is connected to.
+ *
+ * @return PT7C4339_Mux* The multiplexer set with setMux(), or nullptr if the RTC is connected to the bus directly.
+ */
+template<class Bus>
+PT7C4339_Mux *PT7C4339T<Bus>::getMux()
+{
+  return _bus.getMux();
+}
+
+/**
+ * @brief Gets the multiplexer channel the RTC is connected to.
+ *
+ * @return uint8_t The channel set with setMux() (0-7), or PT7C4339_MUX_NO_CHANNEL if the RTC is connected to the bus directly.
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::getMuxChannel()
+{
+  return _bus.getMuxChannel();
+}
+
+/**
+ * @brief Reads the date and time of many RTCs in one sweep, with one burst read each.
+ *
+ * The RTCs are visited grouped by multiplexer, so the channels of every multiplexer are only disconnected once
+ * when the sweep moves on to the next one, and a channel select is only sent when the channel changes.
+ * The results are stored in the order of the devices, whatever order they were read in.
+ *
+ * @param devices Array of count pointers to the RTCs to read.
+ * @param count The number of RTCs.
+ * @param dateTimes Array of count structures that receives the date and time of each RTC, every field is 0 where the read failed.
+ * @return uint8_t The number of RTCs read successfully.
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::readDateTimes( PT7C4339T *const *devices, uint8_t count, PT7C4339_DateTime *dateTimes )
+{
+  uint8_t read = 0;
+
+  for( uint8_t i = 0; i < count; i++ )
+  {
+    bool visited = false;
+    for( uint8_t j = 0; j < i && !visited; j++ )
+    {
+      visited = devices[j]->getMux() == devices[i]->getMux();
+    }
+    if( visited ) continue;
+
+    for( uint8_t k = i; k < count; k++ )
+    {
+      if( devices[k]->getMux() != devices[i]->getMux() ) continue;
+
+      dateTimes[k] = devices[k]->getDateTime();
+      if( dateTimes[k].date.month != 0 ) read++;
+    }
+  }
+
+  return read;
+}
+
+/**
+ * @brief Converts a BCD (Binary-Coded Decimal) value to its decimal equivalent.
+ *
+ * This function takes an 8-bit BCD value and converts it to the corresponding
+ * decimal value. BCD encodes each decimal digit in 4 bits.
+ *
+ * @param bcd The BCD value to convert.
+ * @return uint8_t The decimal representation of the BCD value.
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::bcdToDec( uint8_t bcd )
+{
+  return ( ( ( bcd >> 4 ) * 10 ) + ( bcd & 0x0F ) );
+}
+
+/**
+ * @brief Converts a decimal value to its Binary-Coded Decimal (BCD) representation.
+ *
+ * This function takes an 8-bit unsigned integer representing a decimal value (0-99)
+ * and converts it to its equivalent BCD format. In BCD, each nibble (4 bits) of the byte
+ * represents a decimal digit.
+ *
+ * @param dec The decimal value to convert (expected range: 0-99).
+ * @return uint8_t The BCD representation of the input decimal value.
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::decToBcd( uint8_t dec )
+{
+  return ( ( ( dec / 10 ) << 4) | ( dec % 10 ) );
+}
+
+/**
+ * @brief Checks that a register value read is a valid BCD number in the given range.
+ *
+ * A register holding a digit above 9 or a value out of range (e.g. after a brown-out or a corrupted read)
+ * sets the last status to PT7C4339_STATUS_BCD_RANGE, instead of being decoded into a wrong date or time.
+ *
+ * @param bcd The BCD value to check, with the control bits masked out.
+ * @param min The smallest valid decimal value.
+ * @param max The largest valid decimal value.
+ * @return bool True if the value is valid, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::checkBcd( uint8_t bcd, uint8_t min, uint8_t max )
+{
+  if( ( bcd & 0x0F ) <= 9 && ( bcd >> 4 ) <= 9 && bcdToDec( bcd ) >= min && bcdToDec( bcd ) <= max ) return true;
+
+  _lastStatus = PT7C4339_STATUS_BCD_RANGE;
+  return false;
+}
+
+/**
+ * @brief Reads a single byte from the specified register of the PT7C4339 RTC via I2C.
+ *
+ * This function reads one byte from the specified register using readRegisters().
+ *
+ * @param REG The register address to read from.
+ * @return uint8_t The value read from the specified register, 0 if the read failed.
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::readRegister( uint8_t REG )
+{
+  uint8_t registerData = 0;
+
+  readRegisters( REG, &registerData, 1 );
+
+  return registerData;
+}
+
+/**
+ * @brief Reads consecutive registers of the PT7C4339 RTC.
+ *
+ * Registers staged by an update started with beginUpdate() return their staged values. The status register is
+ * always read from the device, with the flags staged by clearStatusFlags() returned as cleared.
+ * If every other requested register is held in the register cache, the values are served from the cache.
+ * Otherwise the registers are read from the device with readBus(), and the cache is updated with the result.
+ *
+ * @param REG The address of the first register to read.
+ * @param DATA Buffer of at least length bytes that receives the register values.
+ * @param length The number of registers to read.
+ * @return bool True if every requested register was read, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::readRegisters( uint8_t REG, uint8_t *DATA, uint8_t length )
+{
+  if( _cacheEnabled && !_cacheValid ) refreshRegisterCache();
+
+  bool fromBus = false;
+  for( uint8_t i = 0; i < length; i++ )
+  {
+    if( ( !isStaged( REG + i ) || REG + i == PT7C4339_REG_STATUS ) && !isCached( REG + i ) ) fromBus = true;
+  }
+
+  if( fromBus )
+  {
+    if( !readBus( REG, DATA, length ) ) return false;
+
+    updateCache( REG, DATA, length );
+  }
+
+  for( uint8_t i = 0; i < length; i++ )
+  {
+    uint8_t reg = REG + i;
+
+    if( reg == PT7C4339_REG_STATUS && isStaged( reg ) ) DATA[i] &= _image[reg] | ~0x83; // Only the staged clears
+    else if( isStaged( reg ) ) DATA[i] = _image[reg];
+    else if( !fromBus ) DATA[i] = _cache[reg - PT7C4339_CACHE_FIRST_REG];
+  }
+
+  return true;
+}
+
+/**
+ * @brief Reads consecutive registers of the PT7C4339 RTC through the bus policy.
+ *
+ * The bus policy sets the register pointer to REG, then requests length bytes in one go.
+ * The PT7C4339 auto-increments the register pointer after every byte, and the timekeeping registers
+ * are latched for the duration of the transaction, so a burst read of 0x00-0x06 can not tear at a rollover.
+ * The read is counted as a register pointer write and one read transaction in the bus statistics.
+ * A failed read is repeated up to the retry budget, a timed out one after recovering the bus.
+ *
+ * @param REG The address of the first register to read.
+ * @param DATA Buffer of at least length bytes that receives the register values.
+ * @param length The number of registers to read.
+ * @return bool True if every requested byte was received, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::readBus( uint8_t REG, uint8_t *DATA, uint8_t length )
+{
+  for( uint8_t attempt = 0; ; attempt++ )
+  {
+    _lastStatus = _bus.read( REG, DATA, length );
+
+    if( _lastStatus == PT7C4339_STATUS_OK ) break;
+
+    PT7C4339_COUNT_TRANSACTION( 2, true );
+    if( _lastStatus == PT7C4339_STATUS_TIMEOUT ) recoverBus();
+    if( attempt >= _retryBudget ) return false;
+  }
+
+  PT7C4339_COUNT_TRANSACTION( 2, false );
+  PT7C4339_COUNT_TRANSACTION( 1 + length, false );
+
+  return true;
+}
+
+/**
+ * @brief Writes a byte of data to a specified register of the PT7C4339 RTC over I2C.
+ *
+ * This function writes the data byte with writeRegisters(), which reads the register back
+ * to verify that the write was successful.
+ *
+ * @param REG The register address to write to.
+ * @param DATA The data byte to write to the register.
+ * @return bool true if the data was successfully written and verified, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::writeRegister( uint8_t REG, uint8_t DATA )
+{
+  return writeRegisters( REG, &DATA, 1 );
+}
+
+/**
+ * @brief Writes consecutive registers of the PT7C4339 RTC, then verifies them according to the verification policy.
+ *
+ * Inside an update started with beginUpdate(), the data is only staged for commit().
+ * Otherwise this function writes the data bytes with writeBus(). With PT7C4339_VERIFY_ALWAYS, the whole range is then
+ * read back with a single burst read and compared to the written data. With PT7C4339_VERIFY_DEFERRED, the written
+ * values are recorded for verifyPendingWrites(), unless the range holds registers the device changes by itself.
+ * The register cache is updated with the values read back or written, or invalidated if the state of the device is unknown.
+ *
+ * @param REG The address of the first register to write.
+ * @param DATA The data bytes to write.
+ * @param length The number of registers to write (1-17), the range must end at 0x10 at the latest.
+ * @return bool True if every byte was acknowledged and, if verified immediately, the read back data matches,
+ *         false otherwise or if the range does not fit in the register map.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::writeRegisters( uint8_t REG, const uint8_t *DATA, uint8_t length )
+{
+  if( length == 0 || REG + length > PT7C4339_REGISTER_COUNT ) return false; // A range past 0x10 would wrap into the timekeeping registers
+
+  if( _updateActive )
+  {
+    if( _asyncStatus == PT7C4339_ASYNC_BUSY ) return false; // The image holds the data of the operation
+
+    for( uint8_t i = 0; i < length; i++ )
+    {
+      _image[REG + i] = DATA[i];
+      _stagedMask |= ( 1UL << ( REG + i ) );
+      _pendingVerifyMask &= ~( 1UL << ( REG + i ) ); // Its value to verify is overwritten, and the register is about to be rewritten
+    }
+
+    return true;
+  }
+
+  if( !writeBus( REG, DATA, length ) )
+  {
+    _cacheValid = false;
+    return false;
+  }
+
+  if( deferVerify( REG, DATA, length ) )
+  {
+    updateCache( REG, DATA, length );
+    return true;
+  }
+
+  uint8_t readBack[PT7C4339_REGISTER_COUNT];
+
+  if( !readBus( REG, readBack, length ) )
+  {
+    _cacheValid = false;
+    return false;
+  }
+
+  updateCache( REG, readBack, length );
+
+  if( memcmp( DATA, readBack, length ) != 0 )
+  {
+    _lastStatus = PT7C4339_STATUS_VERIFY_MISMATCH;
+    PT7C4339_COUNT_VERIFY_MISMATCH();
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Decides if a write just sent needs an immediate read back under the verification policy.
+ *
+ * With PT7C4339_VERIFY_NEVER, no write is read back. With PT7C4339_VERIFY_DEFERRED, the written values are recorded
+ * for verifyPendingWrites(), unless the range holds registers the device changes by itself (timekeeping, status),
+ * or a blocking write is sent while a non-blocking operation holds its data in the register image.
+ *
+ * @param REG The address of the first register written.
+ * @param DATA The data bytes written.
+ * @param length The number of registers written.
+ * @return bool True if the write must not be read back now, false if it must be verified immediately.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::deferVerify( uint8_t REG, const uint8_t *DATA, uint8_t length )
+{
+  if( REG + length > PT7C4339_REGISTER_COUNT ) return false; // Verified immediately, the pending values only cover 0x00-0x10
+
+  uint8_t last = REG + length - 1;
+  bool selfChanging = ( REG < PT7C4339_CACHE_FIRST_REG ) || ( REG <= PT7C4339_REG_STATUS && last >= PT7C4339_REG_STATUS );
+
+  if( _verifyPolicy == PT7C4339_VERIFY_NEVER ) return true;
+  if( _verifyPolicy == PT7C4339_VERIFY_ALWAYS || selfChanging ) return false;
+  if( _asyncStatus == PT7C4339_ASYNC_BUSY && DATA != _image + REG ) return false;
+
+  for( uint8_t i = 0; i < length; i++ )
+  {
+    _image[REG + i] = DATA[i];
+    _pendingVerifyMask |= ( 1UL << ( REG + i ) );
+  }
+
+  return true;
+}
+
+/**
+ * @brief Writes consecutive registers of the PT7C4339 RTC with auto-increment through the bus policy.
+ *
+ * The bus policy sends the register address followed by the data bytes, relying on the
+ * auto-incrementing register pointer of the PT7C4339. The write is counted as one transaction in the bus statistics.
+ * A write starting in the timekeeping registers makes the software clock read the RTC again.
+ * A failed write is repeated up to the retry budget, a timed out one after recovering the bus. Repeating it is safe,
+ * as it writes the same values from the same register again.
+ *
+ * @param REG The address of the first register to write.
+ * @param DATA The data bytes to write.
+ * @param length The number of registers to write.
+ * @return bool True if the write was acknowledged, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::writeBus( uint8_t REG, const uint8_t *DATA, uint8_t length )
+{
+  if( REG <= PT7C4339_REG_YEARS ) _softClockSynced = false;
+
+  for( uint8_t attempt = 0; ; attempt++ )
+  {
+    _lastStatus = _bus.write( REG, DATA, length );
+    PT7C4339_COUNT_TRANSACTION( 2 + length, _lastStatus != PT7C4339_STATUS_OK );
+
+    if( _lastStatus == PT7C4339_STATUS_OK ) return true;
+
+    if( _lastStatus == PT7C4339_STATUS_TIMEOUT ) recoverBus();
+    if( attempt >= _retryBudget ) return false;
+  }
+}
+
+/**
+ * @brief Reads the current values of the configuration registers 0x07-0x10.
+ *
+ * With the register cache enabled, the cache is refilled if needed and copied without further bus traffic,
+ * otherwise the registers are read with one burst read. The status register value may be stale.
+ *
+ * @param image Buffer of PT7C4339_CONFIG_SIZE bytes that receives the register values.
+ * @return bool True if the registers were read, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::readConfigImage( uint8_t *image )
+{
+  if( _cacheEnabled && !_cacheValid && !refreshRegisterCache() ) return false;
+
+  if( _cacheEnabled ) memcpy( image, _cache + ( PT7C4339_CONFIG_FIRST_REG - PT7C4339_CACHE_FIRST_REG ), PT7C4339_CONFIG_SIZE );
+  else if( !readBus( PT7C4339_CONFIG_FIRST_REG, image, PT7C4339_CONFIG_SIZE ) ) return false;
+
+  return true;
+}
+
+/**
+ * @brief Calculates the checksum of a saved configuration.
+ *
+ * @param registers The PT7C4339_CONFIG_SIZE register values of the configuration.
+ * @return uint8_t PT7C4339_CONFIG_CHECKSUM_SEED XOR every register value.
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::configChecksum( const uint8_t *registers )
+{
+  uint8_t checksum = PT7C4339_CONFIG_CHECKSUM_SEED;
+
+  for( uint8_t i = 0; i < PT7C4339_CONFIG_SIZE; i++ ) checksum ^= registers[i];
+
+  return checksum;
+}
+
+/**
+ * @brief Checks if a register can be served from the register cache.
+ *
+ * @param REG The register address to check.
+ * @return bool True if the cache is valid and holds the register, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::isCached( uint8_t REG )
+{
+  return _cacheEnabled && _cacheValid && REG >= PT7C4339_CACHE_FIRST_REG && REG <= PT7C4339_CACHE_LAST_REG && REG != PT7C4339_REG_STATUS;
+}
+
+/**
+ * @brief Checks if a register has a value staged by an update started with beginUpdate().
+ *
+ * @param REG The register address to check.
+ * @return bool True if the register is staged, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::isStaged( uint8_t REG )
+{
+  return _updateActive && REG < PT7C4339_REGISTER_COUNT && ( _stagedMask & ( 1UL << REG ) );
+}
+
+/**
+ * @brief Copies register values known to be on the device into the register cache.
+ *
+ * @param REG The address of the first register.
+ * @param DATA The register values.
+ * @param length The number of registers.
+ */
+template<class Bus>
+void PT7C4339T<Bus>::updateCache( uint8_t REG, const uint8_t *DATA, uint8_t length )
+{
+  if( !_cacheEnabled || !_cacheValid ) return;
+
+  for( uint8_t i = 0; i < length; i++ )
+  {
+    uint8_t reg = REG + i;
+    if( reg >= PT7C4339_CACHE_FIRST_REG && reg <= PT7C4339_CACHE_LAST_REG ) _cache[reg - PT7C4339_CACHE_FIRST_REG] = DATA[i];
+  }
+}
+
+/**
+ * @brief Retrieves the current date and time from the PT7C4339 RTC in a single transaction.
+ *
+ * This function reads the seconds, minutes, hours, weekday, date, month/century and year registers
+ * with one burst read, and decodes them into a PT7C4339_DateTime structure. As all seven registers
+ * come from the same transaction, the returned date and time always belong to the same second.
+ *
+ * @return PT7C4339_DateTime Structure containing the current date and time.
+ *         If the read fails or a register holds an invalid value, every field is 0 and getLastStatus() tells why.
+ */
+template<class Bus>
+PT7C4339_DateTime PT7C4339T<Bus>::getDateTime()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_DATE_TIME );
+  PT7C4339_DateTime dateTime = {};
+  uint8_t buf[7];
+
+  if( !readRegisters( PT7C4339_REG_SECONDS, buf, 7 ) ) return dateTime;
+
+  return decodeDateTime( buf );
+}
+
+/**
+ * @brief Decodes the timekeeping registers 0x00-0x06 into a PT7C4339_DateTime structure.
+ *
+ * @param buf The values of the seven timekeeping registers, seconds first.
+ * @return PT7C4339_DateTime The decoded date and time, the century bit of the month register selects 1900 or 2000.
+ *         Every field is 0 if a register holds an invalid BCD value or a value out of range.
+ */
+template<class Bus>
+PT7C4339_DateTime PT7C4339T<Bus>::decodeDateTime( const uint8_t *buf )
+{
+  PT7C4339_DateTime dateTime = {};
+
+  if( !decodeTime( buf, &dateTime.time ) || !decodeDate( buf + 3, &dateTime.date ) ) dateTime = PT7C4339_DateTime();
+
+  return dateTime;
+}
+
+/**
+ * @brief Decodes the seconds, minutes and hours registers 0x00-0x02.
+ *
+ * @param buf The values of the three time registers, seconds first.
+ * @param time Receives the decoded time, left unchanged if a register is invalid.
+ * @return bool True if every register holds a valid BCD value in range, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::decodeTime( const uint8_t *buf, PT7C4339_Time *time )
+{
+  if( !checkBcd( buf[0] & 0x7F, 0, 59 ) || !checkBcd( buf[1] & 0x7F, 0, 59 ) || !checkBcd( buf[2] & 0x3F, 0, 23 ) ) return false;
+
+  time->second = bcdToDec( buf[0] & 0x7F );
+  time->minute = bcdToDec( buf[1] & 0x7F );
+  time->hour = bcdToDec( buf[2] & 0x3F );
+
+  return true;
+}
+
+/**
+ * @brief Decodes the weekday, date, month/century and year registers 0x03-0x06.
+ *
+ * @param buf The values of the four date registers, weekday first.
+ * @param date Receives the decoded date, the century bit of the month register selects 1900 or 2000.
+ *        Left unchanged if a register is invalid.
+ * @return bool True if every register holds a valid BCD value in range, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::decodeDate( const uint8_t *buf, PT7C4339_Date *date )
+{
+  if( !checkBcd( buf[0] & 0x07, 1, 7 ) || !checkBcd( buf[1] & 0x3F, 1, 31 ) || !checkBcd( buf[2] & 0x1F, 1, 12 )
+    || !checkBcd( buf[3], 0, 99 ) ) return false;
+
+  date->weekDay = static_cast<PT7C4339_daysOfWeek>( buf[0] & 0x07 );
+  date->day = bcdToDec( buf[1] & 0x3F );
+  date->month = bcdToDec( buf[2] & 0x1F );
+  date->year = bcdToDec( buf[3] );
+
+  if( buf[2] & 0x80 ) date->year += 2000;
+  else date->year += 1900;
+
+  return true;
+}
+
+/**
+ * @brief Sets the current date and time of the PT7C4339 RTC in a single transaction.
+ *
+ * Validates every field on the host, calculates the weekday and the century bit, then writes
+ * the seconds, minutes, hours, weekday, date, month/century and year registers with one
+ * auto-increment write, verified by one burst read. The values are only written if all of them are valid:
+ * - year:   1900-2099
+ * - month:  1-12
+ * - day:    1 to the length of the month
+ * - hour:   0-23
+ * - minute: 0-59
+ * - second: 0-59
+ *
+ * @param dateTime A PT7C4339_DateTime struct containing the date and time to set.
+ * @return bool True if the date and time were successfully set, false otherwise.
+ *
+ * @note The weekDay field of the input parameter is ignored. The correct weekday is automatically
+ * calculated and set based on the provided year, month, and day.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setDateTime( PT7C4339_DateTime dateTime )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_DATE_TIME );
+  bool setSuccess = false;
+
+  PT7C4339_Date date = dateTime.date;
+  PT7C4339_Time time = dateTime.time;
+
+  if( PT7C4339_isValidDateTime( dateTime ) )
+  {
+    uint8_t buf[7];
+
+    buf[0] = decToBcd( time.second );
+    buf[1] = decToBcd( time.minute );
+    buf[2] = decToBcd( time.hour );
+    buf[3] = calculateWeekDay( date.year, date.month, date.day );
+    buf[4] = decToBcd( date.day );
+    buf[5] = ( ( date.year > 1999 ) << 7 ) | decToBcd( date.month );
+    buf[6] = decToBcd( date.year % 100 );
+
+    setSuccess = writeRegisters( PT7C4339_REG_SECONDS, buf, 7 );
+  }
+
+  return setSuccess;
+}
+
+/**
+ * @brief Retrieves the current date and time as a Unix timestamp, with a single burst read.
+ *
+ * @return uint32_t Seconds since 1970-01-01 00:00:00, 0 if the read failed or the RTC holds a date before 1970.
+ */
+template<class Bus>
+uint32_t PT7C4339T<Bus>::getEpoch()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_EPOCH );
+  PT7C4339_DateTime dateTime = getDateTime();
+
+  if( dateTime.date.year < 1970 ) return 0;
+
+  return PT7C4339_dateTimeToEpoch( dateTime );
+}
+
+/**
+ * @brief Sets the date and time from a Unix timestamp, with a single burst write.
+ *
+ * @param epoch Seconds since 1970-01-01 00:00:00, at most PT7C4339_EPOCH_MAX (2099-12-31 23:59:59).
+ * @return bool True if the date and time was set successfully, false if the timestamp is out of range or the write failed.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setEpoch( uint32_t epoch )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_EPOCH );
+  if( epoch > PT7C4339_EPOCH_MAX ) return false;
+
+  return setDateTime( PT7C4339_epochToDateTime( epoch ) );
+}
+
+/**
+ * @brief Retrieves the current time from the PT7C4339 RTC module.
+ *
+ * This function reads the seconds, minutes and hours registers 0x00-0x02 with one burst read
+ * and returns them encapsulated in a PT7C4339_Time structure. Only these registers are checked,
+ * so an invalid date does not hide a valid time.
+ *
+ * @return PT7C4339_Time Structure containing the current time (hours, minutes, seconds).
+ *         If the read fails or a register holds an invalid value, every field is 0 and getLastStatus() tells why.
+ */
+template<class Bus>
+PT7C4339_Time PT7C4339T<Bus>::getTime()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_TIME );
+  PT7C4339_Time time = {};
+  uint8_t buf[3];
+
+  if( !readRegisters( PT7C4339_REG_SECONDS, buf, 3 ) ) return time;
+
+  decodeTime( buf, &time );
+  return time;
+}
+
+/**
+ * @brief Sets the current time of the PT7C4339 RTC.
+ *
+ * Validates the provided time values (hour, minute, second) and sets them if they are within valid ranges.
+ * The seconds, minutes and hours registers are written in a single transaction.
+ * The time is only set if all values are valid:
+ * - hour:   0-23
+ * - minute: 0-59
+ * - second: 0-59
+ *
+ * @param time A PT7C4339_Time struct containing the hour, minute, and second to set.
+ * @return bool True if the time was successfully set, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setTime( PT7C4339_Time time )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_TIME );
+  bool setSuccess = false;
+
+  if( time.hour < 24 && time.minute < 60 && time.second < 60 )
+  {
+    uint8_t buf[3] = { decToBcd( time.second ), decToBcd( time.minute ), decToBcd( time.hour ) };
+
+    setSuccess = writeRegisters( PT7C4339_REG_SECONDS, buf, 3 );
+  }
+  else setSuccess = false;
+
+  return setSuccess;
+}
+
+/**
+ * @brief Retrieves the current date from the PT7C4339 RTC.
+ *
+ * This function reads the weekday, date, month/century and year registers 0x03-0x06 with one burst read
+ * and returns them as a PT7C4339_Date structure. Only these registers are checked,
+ * so an invalid time does not hide a valid date.
+ *
+ * @return PT7C4339_Date Structure containing the current date and weekday.
+ *         If the read fails or a register holds an invalid value, every field is 0 and getLastStatus() tells why.
+ */
+template<class Bus>
+PT7C4339_Date PT7C4339T<Bus>::getDate()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_DATE );
+  PT7C4339_Date date = {};
+  uint8_t buf[4];
+
+  if( !readRegisters( PT7C4339_REG_DAYS_OF_WEEK, buf, 4 ) ) return date;
+
+  decodeDate( buf, &date );
+  return date;
+}
+
+/**
+ * @brief Sets the date of the PT7C4339 RTC.
+ *
+ * This function sets the year, month, and day of the PT7C4339 real-time clock
+ * using the values provided in the PT7C4339_Date structure.
+ * The date is only set if all values are valid:
+ * - year:  1900-2099
+ * - month: 1-12
+ * - day:   1 to the length of the month
+ *
+ * @param date The PT7C4339_Date structure containing the year, month, and day to set.
+ * @return true if all date components (year, month, day) were set successfully; false otherwise.
+ *
+ * @note The weekDay field of the input parameter is ignored. The correct weekday is automatically 
+ * calculated and set based on the provided year, month, and day.
+ * 
+ * @note The weekday, date, month and year registers are written in a single transaction,
+ * so the stored date is never a mix of the old and new values.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setDate( PT7C4339_Date date )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_DATE );
+  bool setSuccess = false;
+
+  if( date.year > 1899 && date.year < 2100 && date.month <= 12 && date.month > 0
+    && date.day > 0 && date.day <= PT7C4339_daysInMonth( date.year, date.month ) )
+  {
+    setSuccess = writeDate( date.year, date.month, date.day );
+  }
+
+  return setSuccess;
+}
+
+/**
+ * @brief Writes the weekday, date, month/century and year registers of the PT7C4339 RTC.
+ *
+ * This function calculates the weekday and the century bit for the given date, and writes
+ * registers 0x03-0x06 with a single auto-increment write. The date is not validated.
+ *
+ * @param year The full year (1900-2099).
+ * @param month The month (1-12).
+ * @param day The day of the month (1-31).
+ * @return bool True if the registers were successfully written, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::writeDate( uint16_t year, uint8_t month, uint8_t day )
+{
+  uint8_t buf[4];
+
+  buf[0] = calculateWeekDay( year, month, day );
+  buf[1] = decToBcd( day );
+  buf[2] = ( ( year > 1999 ) << 7 ) | decToBcd( month );
+  buf[3] = decToBcd( year % 100 );
+
+  return writeRegisters( PT7C4339_REG_DAYS_OF_WEEK, buf, 4 );
+}
+
+/**
+ * @brief Calculates the day of the week for a given date.
+ *
+ * This function determines the day of the week (e.g., Monday, Tuesday, etc.)
+ * for the specified year, month, and day in constant time, by counting the days since 1970-01-01
+ * with PT7C4339_daysFromCivil().
+ *
+ * @param year  The full year (1900-2099).
+ * @param month The month (1 = January, 12 = December).
+ * @param day  The day of the month (1-31).
+ * @return PT7C4339_daysOfWeek The calculated day of the week as an enum value, where 1 = Monday ... 7 = Sunday.
+ *
+ * @note The function assumes the Gregorian calendar and supports years before and after 2000.
+ */
+template<class Bus>
+PT7C4339_daysOfWeek PT7C4339T<Bus>::calculateWeekDay( uint16_t year, uint8_t month, uint8_t day )
+{
+  return PT7C4339_weekDayFromDays( PT7C4339_daysFromCivil( year, month, day ) );
+}
+
+/**
+ * @brief Reads the value of a specific bit from a register of the PT7C4339 RTC.
+ *
+ * This function reads the value of the specified bit (BIT) from the given register (REG)
+ * of the PT7C4339 RTC. It returns true if the bit is set (1), or false if the bit is clear (0).
+ *
+ * @param REG The address of the register to read from.
+ * @param BIT The bit position within the register to read (0-7).
+ * @return bool true if the specified bit is set, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::readBit( uint8_t REG, uint8_t BIT )
+{
+  uint8_t registerData = readRegister( REG );
+  bool bitValue = ( registerData >> BIT ) & 0x01;
+
+  return bitValue;
+}
+
+
+/**
+ * @brief Sets or clears a specific bit in a register of the PT7C4339 RTC.
+ *
+ * This function reads the current value of the specified register, modifies the
+ * specified bit according to the provided value, and writes the updated value
+ * back to the register.
+ *
+ * @param REG The address of the register to modify.
+ * @param BIT The bit position (0-7) within the register to set or clear.
+ * @param value If true, the bit is set; if false, the bit is cleared.
+ * @return true if the register write operation was successful, false if the read or the write failed.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::writeBit( uint8_t REG, uint8_t BIT, bool value )
+{
+  uint8_t registerData;
+  if( !readRegisters( REG, &registerData, 1 ) ) return false; // Writing back a failed read would clear every other bit
+
+  if( value == true ) registerData |= ( 1 << BIT );
+  else registerData &= ~( 1 << BIT );
+
+  bool writeSuccess = writeRegister( REG, registerData );
+
+  return writeSuccess;
+}
+
+/**
+ * @brief Clears flags of the status register without reading it first.
+ *
+ * OSF, A2F and A1F can only be cleared, and writing 1 leaves them unchanged, so the status register is written
+ * as 0x83 with only the given flags cleared. A flag the device sets between a read and the write is never lost,
+ * also not inside an update started with beginUpdate(), where the clears are merged into the staged value
+ * and written by commit(). The write is never read back under any verification policy: a flag that reads back set
+ * may have been set again by the device, e.g. by alarm 1 firing every second, so it proves nothing about the write.
+ *
+ * @param flags The flags to clear: 0x80 (OSF), PT7C4339_ALARM2_EVENT (A2F) and/or PT7C4339_ALARM1_EVENT (A1F).
+ * @return bool True if the flags were cleared (or staged), false if the write failed.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::clearStatusFlags( uint8_t flags )
+{
+  uint8_t clear = 0x83 & ~flags;
+
+  if( _updateActive )
+  {
+    if( isStaged( PT7C4339_REG_STATUS ) ) clear &= _image[PT7C4339_REG_STATUS];
+
+    return writeRegister( PT7C4339_REG_STATUS, clear );
+  }
+
+  return writeBus( PT7C4339_REG_STATUS, &clear, 1 );
+}
+
+/**
+ * @brief Retrieves the current seconds value from the PT7C4339 RTC.
+ *
+ * This function reads the seconds register from the PT7C4339 real-time clock (RTC),
+ * masks out the unused bit, converts the value from BCD to decimal, and returns it.
+ *
+ * @return uint8_t The current seconds (0-59).
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::getSecond()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_SECOND );
+  uint8_t seconds = readRegister( PT7C4339_REG_SECONDS ) & 0x7F;
+  if( !checkBcd( seconds, 0, 59 ) ) return 0;
+  seconds = bcdToDec( seconds );
+
+  return seconds;
+}
+
+/**
+ * @brief Retrieves the current minutes value from the PT7C4339 RTC.
+ *
+ * This function reads the minutes register from the PT7C4339 real-time clock (RTC),
+ * masks out the unused bit, converts the
+ * value from BCD to decimal, and returns the result.
+ *
+ * @return uint8_t The current minutes (0-59).
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::getMinute()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_MINUTE );
+  uint8_t minutes = readRegister( PT7C4339_REG_MINUTES ) & 0x7F;
+  if( !checkBcd( minutes, 0, 59 ) ) return 0;
+  minutes = bcdToDec( minutes );
+
+  return minutes;
+}
+
+/**
+ * @brief Retrieves the current hour value from the PT7C4339 RTC.
+ *
+ * This function reads the hour register from the PT7C4339 real-time clock,
+ * masks out the control and unused bits, converts the value from BCD to
+ * decimal format, and returns the hour in 24-hour format.
+ *
+ * @return uint8_t The current hour (0-23).
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::getHour()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_HOUR );
+  uint8_t hours = readRegister( PT7C4339_REG_HOURS ) & 0x3F;
+  if( !checkBcd( hours, 0, 23 ) ) return 0;
+  hours = bcdToDec( hours );
+
+  return hours;
+}
+
+/**
+ * @brief Retrieves the current day of the week from the PT7C4339 RTC.
+ *
+ * This function reads the day of the week register from the PT7C4339 real-time clock,
+ * masks the relevant bits, and returns the value as a PT7C4339_daysOfWeek enumeration.
+ *
+ * @return PT7C4339_daysOfWeek The current day of the week as an enum value where 1 = Monday ... 7 = Sunday.
+ */
+template<class Bus>
+PT7C4339_daysOfWeek PT7C4339T<Bus>::getWeekDay()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_WEEK_DAY );
+  uint8_t weekDay = readRegister( PT7C4339_REG_DAYS_OF_WEEK );
+  weekDay = ( weekDay & 0x07 );
+  if( !checkBcd( weekDay, 1, 7 ) ) weekDay = 0;
+
+  return static_cast<PT7C4339_daysOfWeek>( weekDay );
+}
+
+/**
+ * @brief Retrieves the current day of the month from the PT7C4339 RTC.
+ *
+ * This function reads the date register from the PT7C4339 real-time clock,
+ * masks the relevant bits, converts it to decimal, and returns it.
+ *
+ * @return uint8_t The current day of the month (1-31).
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::getDay()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_DAY );
+  uint8_t day = readRegister( PT7C4339_REG_DATES ) & 0x3F;
+  if( !checkBcd( day, 1, 31 ) ) return 0;
+  day = bcdToDec( day );
+
+  return day;
+}
+
+/**
+ * @brief Retrieves the current month from the PT7C4339 RTC.
+ *
+ * This function reads the month register from the PT7C4339 real-time clock,
+ * masks out unused and control bits, converts the value from BCD to decimal, and returns it.
+ *
+ * @return uint8_t The current month (1 = January, 12 = December).
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::getMonth()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_MONTH );
+  uint8_t month = readRegister( PT7C4339_REG_MONTHS );
+  month &= 0x1F;
+  if( !checkBcd( month, 1, 12 ) ) return 0;
+  month = bcdToDec( month );
+
+  return month;
+}
+
+/**
+ * @brief Retrieves the current year from the PT7C4339 RTC.
+ *
+ * This function reads the month and year registers from the PT7C4339 real-time clock (RTC) with one burst read,
+ * converts the year from BCD to decimal, and determines the century based on the highest bit
+ * of the month register, which is the century bit.
+ *
+ * @return uint16_t The full year (e.g., 2024), 0 if the read failed or the year register is invalid.
+ */
+template<class Bus>
+uint16_t PT7C4339T<Bus>::getYear()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_YEAR );
+  uint8_t buf[2];
+  if( !readRegisters( PT7C4339_REG_MONTHS, buf, 2 ) ) return 0;
+  if( !checkBcd( buf[1], 0, 99 ) ) return 0;
+
+  uint16_t year = bcdToDec( buf[1] );
+
+  if( buf[0] & 0x80 ) year += 2000;
+  else year += 1900;
+
+  return year;
+}
+
+/**
+ * @brief Sets the seconds value of the PT7C4339 RTC.
+ *
+ * This function sets the seconds register of the PT7C4339 real-time clock (RTC) to the specified value.
+ * The input value must be in the range [0, 59]. The value is converted from decimal to BCD format before being written
+ * to the seconds register. The function returns true if the operation is successful, false otherwise.
+ *
+ * @param seconds The seconds value to set (0-59).
+ * @return bool True if the seconds register was successfully updated, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setSecond( uint8_t seconds )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_SECOND );
+  bool setSuccess;
+
+  if( seconds < 60 )
+  {
+    seconds = decToBcd( seconds );
+
+    if( writeRegister( PT7C4339_REG_SECONDS, seconds ) ) setSuccess = true;
+    else setSuccess = false;
+  }
+  else setSuccess = false;
+
+  return setSuccess;
+}
+
+/**
+ * @brief Sets the minutes value of the PT7C4339 RTC.
+ *
+ * This function sets the minutes register of the PT7C4339 real-time clock (RTC) to the specified value.
+ * The input value must be in the range [0, 59]. The value is converted from decimal to BCD format before being written
+ * to the minutes register. The function returns true if the operation is successful, false otherwise.
+ *
+ * @param minutes The seconds value to set (0-59).
+ * @return bool True if the minutes register was successfully updated, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setMinute( uint8_t minutes )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_MINUTE );
+  bool setSuccess;
+
+  if( minutes < 60 )
+  {
+    minutes = decToBcd( minutes );
+
+    if( writeRegister( PT7C4339_REG_MINUTES, minutes ) ) setSuccess = true;
+    else setSuccess = false;
+  }
+  else setSuccess = false;
+
+  return setSuccess;
+}
+
+/**
+ * @brief Sets the hours value of the PT7C4339 RTC.
+ *
+ * This function sets the hours register of the PT7C4339 real-time clock (RTC) to the specified value.
+ * The input value must be in the range [0, 23]. The value is converted from decimal to BCD format before being written
+ * to the hours register. The function returns true if the operation is successful, false otherwise.
+ *
+ * @param hours The seconds value to set (0-23).
+ * @return bool True if the hours register was successfully updated, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setHour( uint8_t hours )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_HOUR );
+  bool setSuccess;
+
+  if( hours < 24 )
+  {
+    hours = decToBcd( hours );
+
+    if( writeRegister( PT7C4339_REG_HOURS, hours ) ) setSuccess = true;
+    else setSuccess = false;
+  }
+  else setSuccess = false;
+
+  return setSuccess;
+}
+
+/**
+ * @brief Sets the correct weekday value in the PT7C4339 RTC.
+ *
+ * This function calculates the correct weekday based on the current date (year, month, day)
+ * and writes it to the weekday register of the PT7C4339 RTC. The stored weekday is not checked,
+ * so an invalid one can be repaired; nothing is written if the date cannot be read or is invalid.
+ *
+ * @return bool True if the weekday was successfully set, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setCorrectWeekDay()
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_CORRECT_WEEK_DAY );
+  bool setSuccess;
+
+  PT7C4339_Date date;
+  uint8_t buf[4];
+
+  if( !readRegisters( PT7C4339_REG_DAYS_OF_WEEK, buf, 4 ) ) return false;
+
+  buf[0] = PT7C4339_MONDAY; // The stored weekday is replaced, so an invalid one must not stop the decode
+  if( !decodeDate( buf, &date ) ) return false;
+
+  PT7C4339_daysOfWeek calculatedWeekDay = calculateWeekDay( date.year, date.month, date.day );
+
+  if( writeRegister( PT7C4339_REG_DAYS_OF_WEEK, calculatedWeekDay ) ) setSuccess = true;
+  else setSuccess = false;
+
+  return setSuccess;
+}
+
+/**
+ * @brief Sets the day of the month in the PT7C4339 RTC.
+ *
+ * This function sets the day of the month register of the PT7C4339 RTC to the specified value.
+ * The input value must be in the range [1, 31]. The function checks if the day is valid for the current month
+ * and year (including leap years). The weekday is updated in the same transaction.
+ *
+ * @param day The day of the month to set (1-31).
+ * @return bool True if the day register was successfully updated, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setDay( uint8_t day )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_DAY );
+  bool setSuccess;
+
+  PT7C4339_Date date = getDate();
+
+  // A failed read returns month 0, which has no days, so the stored date is never written back
+  if( day <= PT7C4339_daysInMonth( date.year, date.month ) && day > 0 )
+  {
+    setSuccess = writeDate( date.year, date.month, day );
+  }
+  else setSuccess = false;
+
+  return setSuccess;
+}
+
+/**
+ * @brief Sets the month value in the PT7C4339 RTC.
+ *
+ * This function attempts to set the month register of the PT7C4339 RTC.
+ * It validates the input month (must be between 1 and 12), preserves the century bit,
+ * and writes the new value to the device. The weekday is updated in the same transaction.
+ * Nothing is written if the current date cannot be read or if the current day does not exist in the new month.
+ *
+ * @param month The month to set (1 = January, 12 = December).
+ * @return bool True if the month was successfully set, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setMonth( uint8_t month )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_MONTH );
+  bool setSuccess;
+
+  PT7C4339_Date date = getDate();
+
+  // date.month is 0 if the read failed, and the current day may not exist in the new month
+  if( month <= 12 && month > 0 && date.month > 0 && date.day <= PT7C4339_daysInMonth( date.year, month ) )
+  {
+    setSuccess = writeDate( date.year, month, date.day );
+  }
+  else setSuccess = false;
+
+  return setSuccess;
+}
+
+/**
+ * @brief Sets the year value in the PT7C4339 RTC.
+ *
+ * This function attempts to set the year register of the PT7C4339 RTC.
+ * It checks if the year is within the valid range [1900-2099],
+ * sets the corresponding century bit in the month register,
+ * and writes the new year to the year register. The weekday is updated in the same transaction.
+ * Nothing is written if the current date cannot be read or if it is February 29th and the new year is not a leap year.
+ *
+ * @param year The year to set (1900-2099).
+ * @return bool True if the year was successfully set, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setYear( uint16_t year )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_YEAR );
+  bool setSuccess;
+
+  PT7C4339_Date date = getDate();
+
+  // date.month is 0 if the read failed, and February 29th does not exist in every year
+  if( year > 1899 && year < 2100 && date.month > 0 && date.day <= PT7C4339_daysInMonth( year, date.month ) )
+  {
+    setSuccess = writeDate( year, date.month, date.day );
+  }
+  else setSuccess = false;
+  
+  return setSuccess;
+}
+
+/**
+ * @brief Starts the software clock, which answers now() from the MCU timer instead of the bus.
+ *
+ * This function switches the INT/SQW output to a 1Hz square wave with a single control register write.
+ * handleSqwEdge() must then be called from the falling edge interrupt of the pin connected to INT/SQW,
+ * and serviceSoftClock() from the main loop. The first call of serviceSoftClock() after an edge reads the date and time
+ * once; from then on, every edge advances the software clock by one second and latches _bus.timeMicros(),
+ * so now() needs no I2C traffic. The clock is read again every resyncInterval edges, and after every write of the
+ * timekeeping registers through this library.
+ *
+ * @param resyncInterval Number of SQW edges (seconds) between two reads of the RTC, at least 1. Default is PT7C4339_SOFT_CLOCK_DEFAULT_RESYNC.
+ * @return bool True if the square wave output was configured, false otherwise.
+ *
+ * @note The INT/SQW output can not signal alarms while the software clock is running.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::beginSoftClock( uint16_t resyncInterval )
+{
+  PT7C4339_TRACE( PT7C4339_API_BEGIN_SOFT_CLOCK );
+
+  _bus.enterCritical();
+  _softClockEnabled = false;
+  _softClockSynced = false;
+  _sqwEdges = 0;
+  _sqwLatch = _bus.timeMicros();
+  _bus.exitCritical();
+
+  _softResyncInterval = resyncInterval > 0 ? resyncInterval : 1;
+
+  uint8_t control;
+  if( !readRegisters( PT7C4339_REG_CONTROL, &control, 1 ) ) return false;
+  control &= 0xE3; // RS2, RS1 = 0 (1Hz), INTCN = 0 (square wave)
+
+  if( !writeRegister( PT7C4339_REG_CONTROL, control ) ) return false;
+
+  _softClockEnabled = true;
+  return true;
+}
+
+/**
+ * @brief Stops the software clock. now() returns all 0 afterwards, the square wave output is left running.
+ */
+template<class Bus>
+void PT7C4339T<Bus>::endSoftClock()
+{
+  _softClockEnabled = false;
+  _softClockSynced = false;
+}
+
+/**
+ * @brief Counts a falling edge of the 1Hz square wave and latches its time. Call it from the interrupt of the INT/SQW pin.
+ *
+ * The PT7C4339 increments the seconds register on the falling edge of the 1Hz square wave,
+ * so the latched time is the start of the current second.
+ */
+template<class Bus>
+void PT7C4339T<Bus>::handleSqwEdge()
+{
+  _sqwLatch = _bus.timeMicros();
+  _sqwEdges = _sqwEdges + 1;
+}
+
+/**
+ * @brief Reads the RTC for the software clock when it is not synchronized yet, or its resync interval has passed.
+ *
+ * The RTC is only read at least PT7C4339_SOFT_CLOCK_GUARD_US after and before an SQW edge, and the read is discarded
+ * if an edge arrived during it, so the date and time read always belongs to the latest edge.
+ * If no edge arrived for PT7C4339_SOFT_CLOCK_TIMEOUT_US, the clock loses sync until the edges return.
+ *
+ * @return bool True if the software clock is synchronized after the call, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::serviceSoftClock()
+{
+  PT7C4339_TRACE( PT7C4339_API_SERVICE_SOFT_CLOCK );
+
+  if( !_softClockEnabled ) return false;
+
+  _bus.enterCritical();
+  uint32_t edges = _sqwEdges;
+  uint32_t latch = _sqwLatch;
+  _bus.exitCritical();
+
+  uint32_t sinceEdge = _bus.timeMicros() - latch;
+
+  if( sinceEdge >= PT7C4339_SOFT_CLOCK_TIMEOUT_US )
+  {
+    _softClockSynced = false;
+    return false;
+  }
+
+  if( _softClockSynced && edges - _softSyncEdges < _softResyncInterval ) return true;
+  if( edges == 0 ) return _softClockSynced;
+  if( sinceEdge < PT7C4339_SOFT_CLOCK_GUARD_US || sinceEdge > 1000000UL - PT7C4339_SOFT_CLOCK_GUARD_US ) return _softClockSynced;
+
+  uint8_t buf[7];
+  bool read = readRegisters( PT7C4339_REG_SECONDS, buf, 7 );
+
+  _bus.enterCritical();
+  bool edgeDuringRead = ( _sqwEdges != edges );
+  _bus.exitCritical();
+
+  if( !read || edgeDuringRead ) return _softClockSynced;
+
+  PT7C4339_DateTime dateTime = decodeDateTime( buf );
+  if( dateTime.date.month == 0 ) return _softClockSynced;
+
+  _softNow = dateTime;
+  _softNowEdges = edges;
+  _softSyncEdges = edges;
+  _softClockSynced = true;
+
+  return true;
+}
+
+/**
+ * @brief Checks if the software clock is synchronized, i.e. now() returns a valid date and time.
+ *
+ * @return bool True if the software clock is synchronized, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::isSoftClockSynced()
+{
+  return _softClockEnabled && _softClockSynced;
+}
+
+/**
+ * @brief Retrieves the current date and time with microsecond resolution from the software clock, without any I2C traffic.
+ *
+ * The date and time is advanced by the number of SQW edges since the last call, and the fraction of the second is
+ * the time elapsed since the latest edge, measured with _bus.timeMicros(). If an edge is late, the fraction stops at 999999.
+ * Call it from the main loop, not from an interrupt.
+ *
+ * @return PT7C4339_Timestamp The current date and time with microseconds.
+ *         If the software clock is not synchronized, every field is 0.
+ */
+template<class Bus>
+PT7C4339_Timestamp PT7C4339T<Bus>::now()
+{
+  PT7C4339_Timestamp timestamp = {};
+
+  if( !_softClockEnabled || !_softClockSynced ) return timestamp;
+
+  _bus.enterCritical();
+  uint32_t edges = _sqwEdges;
+  uint32_t latch = _sqwLatch;
+  _bus.exitCritical();
+
+  if( edges != _softNowEdges )
+  {
+    _softNow = PT7C4339_addSeconds( _softNow, static_cast<int32_t>( edges - _softNowEdges ) );
+    _softNowEdges = edges;
+  }
+
+  uint32_t fraction = _bus.timeMicros() - latch;
+  if( fraction > 999999UL ) fraction = 999999UL;
+
+  timestamp.dateTime = _softNow;
+  timestamp.microsecond = fraction;
+
+  return timestamp;
+}
+
+/**
+ * @brief Starts reading the current date and time without blocking.
+ *
+ * The seven timekeeping registers are read by poll() in steps of at most PT7C4339_ASYNC_STEP_BYTES bytes.
+ * When poll() returns PT7C4339_ASYNC_DONE, the result is available from getAsyncDateTime().
+ *
+ * @return bool True if the operation was started, false if another operation is in progress or an update is being staged.
+ *
+ * @note With the default PT7C4339_ASYNC_STEP_BYTES of 8, the registers are read in one step, so they come from the same transaction
+ * and can not tear at a rollover. With a smaller step, prefer the blocking getDateTime().
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::startReadDateTime()
+{
+  return startAsync( PT7C4339_ASYNC_READ_DATE_TIME );
+}
+
+/**
+ * @brief Starts setting the whole configuration of alarm 1 without blocking.
+ *
+ * The configuration is validated and encoded immediately, like by setAlarm1(). poll() then writes registers 0x07-0x0A
+ * and reads them back according to the verification policy, one bus step per call.
+ *
+ * @param config The alarm 1 configuration to set.
+ * @return bool True if the operation was started, false if the configuration is invalid, another operation is in progress
+ *         or an update is being staged.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::startSetAlarm1( PT7C4339_Alarm1Config config )
+{
+  uint8_t buf[4];
+  if( !encodeAlarm1( config, buf ) || !startAsync( PT7C4339_ASYNC_SET_ALARM1 ) ) return false;
+
+  memcpy( _image + PT7C4339_REG_A1_SECONDS, buf, 4 );
+  _pendingVerifyMask &= ~( 0x0FUL << PT7C4339_REG_A1_SECONDS ); // Superseded by the operation
+
+  return true;
+}
+
+/**
+ * @brief Starts restoring all registers to their default power-on values without blocking.
+ *
+ * Like reset(), poll() stops the oscillator with a single write of the control register, waits PT7C4339_RESET_STOP_US
+ * without blocking, then writes the power-on image to registers 0x00-0x10 and reads it back
+ * according to the verification policy, one bus step per call.
+ *
+ * @return bool True if the operation was started, false if another operation is in progress or an update is being staged.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::startReset()
+{
+  if( !startAsync( PT7C4339_ASYNC_RESET ) ) return false;
+
+  memcpy( _image, resetImage, PT7C4339_REGISTER_COUNT );
+  _pendingVerifyMask = 0; // Superseded by the operation
+
+  return true;
+}
+
+/**
+ * @brief Advances the non-blocking operation in progress by at most one bus step.
+ *
+ * A step is one burst of at most PT7C4339_ASYNC_STEP_BYTES bytes, written in one transaction or read with a register pointer write
+ * and one request, or a check of a wait. Call it from the main loop until it returns something other than PT7C4339_ASYNC_BUSY.
+ * Once the operation finished, it keeps returning the result without any I2C traffic until the next operation is started.
+ * Blocking methods may be called between two steps.
+ *
+ * @return PT7C4339_asyncStatus
+ *         - PT7C4339_ASYNC_IDLE: No operation was started
+ *         - PT7C4339_ASYNC_BUSY: The operation is in progress
+ *         - PT7C4339_ASYNC_DONE: The operation finished successfully
+ *         - PT7C4339_ASYNC_ERROR_BUS: A transaction failed, the operation was aborted
+ *         - PT7C4339_ASYNC_ERROR_VERIFY: The registers read back differ from the ones written
+ *         - PT7C4339_ASYNC_ERROR_RANGE: The date and time read holds an invalid value
+ */
+template<class Bus>
+PT7C4339_asyncStatus PT7C4339T<Bus>::poll()
+{
+  if( _asyncStatus != PT7C4339_ASYNC_BUSY ) return _asyncStatus;
+
+  PT7C4339_TRACE( PT7C4339_API_POLL );
+  PT7C4339_asyncStatus status = PT7C4339_ASYNC_ERROR_BUS;
+
+  switch( _asyncOperation )
+  {
+    case PT7C4339_ASYNC_READ_DATE_TIME:
+      status = asyncTransfer( true, PT7C4339_REG_SECONDS, 7, false );
+      if( status == PT7C4339_ASYNC_DONE )
+      {
+        _asyncDateTime = decodeDateTime( _image );
+        if( _asyncDateTime.date.month == 0 ) status = PT7C4339_ASYNC_ERROR_RANGE;
+      }
+      break;
+
+    case PT7C4339_ASYNC_SET_ALARM1:
+      status = asyncWriteVerified( PT7C4339_REG_A1_SECONDS, 4, 0 );
+      break;
+
+    case PT7C4339_ASYNC_RESET:
+      if( _asyncStep == 0 )
+      {
+        _image[PT7C4339_REG_CONTROL] |= 0x80; // /EOSC = 1, stop the oscillator
+        status = asyncTransfer( false, PT7C4339_REG_CONTROL, 1, false );
+        _image[PT7C4339_REG_CONTROL] = resetImage[PT7C4339_REG_CONTROL];
+
+        if( status == PT7C4339_ASYNC_DONE )
+        {
+          _asyncWaitStart = _bus.timeMicros();
+          _asyncStep = 1;
+          status = PT7C4339_ASYNC_BUSY;
+        }
+      }
+      else if( _asyncStep == 1 )
+      {
+        if( _bus.timeMicros() - _asyncWaitStart >= PT7C4339_RESET_STOP_US ) _asyncStep = 2;
+        status = PT7C4339_ASYNC_BUSY;
+      }
+      else status = asyncWriteVerified( PT7C4339_REG_SECONDS, PT7C4339_REGISTER_COUNT, 2 );
+      break;
+
+    default:
+      break;
+  }
+
+  _asyncStatus = status;
+  return status;
+}
+
+/**
+ * @brief Retrieves the non-blocking operation started last.
+ *
+ * @return PT7C4339_asyncOperation The operation started last, PT7C4339_ASYNC_NONE if none was started.
+ */
+template<class Bus>
+PT7C4339_asyncOperation PT7C4339T<Bus>::getAsyncOperation()
+{
+  return _asyncOperation;
+}
+
+/**
+ * @brief Retrieves the date and time read by the last successful startReadDateTime().
+ *
+ * @return PT7C4339_DateTime The date and time read, every field is 0 if none was read yet.
+ */
+template<class Bus>
+PT7C4339_DateTime PT7C4339T<Bus>::getAsyncDateTime()
+{
+  return _asyncDateTime;
+}
+
+/**
+ * @brief Starts a non-blocking operation whose data is already prepared, without any I2C traffic.
+ *
+ * @param operation The operation to start.
+ * @return bool True if the operation was started, false if another operation is in progress or an update is being staged.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::startAsync( PT7C4339_asyncOperation operation )
+{
+  if( _asyncStatus == PT7C4339_ASYNC_BUSY || _updateActive ) return false;
+
+  _asyncOperation = operation;
+  _asyncStatus = PT7C4339_ASYNC_BUSY;
+  _asyncStep = 0;
+  _asyncOffset = 0;
+
+  return true;
+}
+
+/**
+ * @brief Moves the next part of a burst of a non-blocking operation, at most PT7C4339_ASYNC_STEP_BYTES bytes.
+ *
+ * The data is written from, or read into, the register image at the same addresses. Every part sets the register pointer itself,
+ * so blocking calls between two steps do not disturb the transfer. The register cache is updated with the bytes moved,
+ * or invalidated if the transaction failed.
+ *
+ * @param read True to read the registers, false to write them.
+ * @param REG The address of the first register of the burst.
+ * @param length The number of registers in the burst.
+ * @param verify True to compare the registers read with the image instead of storing them.
+ * @return PT7C4339_asyncStatus PT7C4339_ASYNC_BUSY if parts of the burst are left, PT7C4339_ASYNC_DONE if the burst is complete,
+ *         PT7C4339_ASYNC_ERROR_BUS if the transaction failed, PT7C4339_ASYNC_ERROR_VERIFY if the registers read differ.
+ */
+template<class Bus>
+PT7C4339_asyncStatus PT7C4339T<Bus>::asyncTransfer( bool read, uint8_t REG, uint8_t length, bool verify )
+{
+  uint8_t chunk = length - _asyncOffset;
+  if( chunk > PT7C4339_ASYNC_STEP_BYTES ) chunk = PT7C4339_ASYNC_STEP_BYTES;
+
+  uint8_t reg = REG + _asyncOffset;
+  uint8_t readBack[PT7C4339_ASYNC_STEP_BYTES];
+  uint8_t *data = verify ? readBack : _image + reg;
+
+  bool success = read ? readBus( reg, data, chunk ) : writeBus( reg, data, chunk );
+
+  if( !success )
+  {
+    _cacheValid = false;
+    return PT7C4339_ASYNC_ERROR_BUS;
+  }
+
+  updateCache( reg, data, chunk );
+
+  if( verify && memcmp( readBack, _image + reg, chunk ) != 0 )
+  {
+    _lastStatus = PT7C4339_STATUS_VERIFY_MISMATCH;
+    PT7C4339_COUNT_VERIFY_MISMATCH();
+    return PT7C4339_ASYNC_ERROR_VERIFY;
+  }
+
+  _asyncOffset += chunk;
+  if( _asyncOffset < length ) return PT7C4339_ASYNC_BUSY;
+
+  _asyncOffset = 0;
+  return PT7C4339_ASYNC_DONE;
+}
+
+/**
+ * @brief Writes the prepared data of a non-blocking operation, then verifies it according to the verification policy.
+ *
+ * The write takes step writeStep of the operation, the read back step writeStep + 1.
+ *
+ * @param REG The address of the first register to write.
+ * @param length The number of registers to write from the prepared data.
+ * @param writeStep The step of the operation that writes the data.
+ * @return PT7C4339_asyncStatus PT7C4339_ASYNC_BUSY until the write and its verification are complete, then the result.
+ */
+template<class Bus>
+PT7C4339_asyncStatus PT7C4339T<Bus>::asyncWriteVerified( uint8_t REG, uint8_t length, uint8_t writeStep )
+{
+  PT7C4339_asyncStatus status;
+
+  if( _asyncStep == writeStep )
+  {
+    status = asyncTransfer( false, REG, length, false );
+    if( status != PT7C4339_ASYNC_DONE ) return status;
+
+    if( deferVerify( REG, _image + REG, length ) ) return PT7C4339_ASYNC_DONE;
+
+    _asyncStep++;
+    return PT7C4339_ASYNC_BUSY;
+  }
+
+  return asyncTransfer( true, REG, length, true );
+}
+
+/**
+ * @brief Checks if the oscillator is enabled on the PT7C4339 RTC.
+ *
+ * Reads the /EOSC (Enable oscillator) bit from the control register.
+ *
+ * @return bool True if the oscillator is enabled, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::isOscillatorEnabled()
+{
+  PT7C4339_TRACE( PT7C4339_API_IS_OSCILLATOR_ENABLED );
+  return !readBit( PT7C4339_REG_CONTROL, 7 );
+}
+
+/**
+ * @brief Enables or disables the oscillator of the PT7C4339 RTC.
+ *
+ * This function sets or clears the /EOSC (Enable oscillator) bit in the control register.
+ *
+ * @param enable Set to true to enable the oscillator, false to disable it.
+ * @return bool True if the operation was successful, false otherwise.
+ * 
+ * @note Disabling the oscillator will set the Oscillator Stop Flag. After enabling the oscillator,
+ * the flag should be cleared by calling clearRtcStopFlag().
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::enableOscillator( bool enable )
+{
+  PT7C4339_TRACE( PT7C4339_API_ENABLE_OSCILLATOR );
+  return writeBit( PT7C4339_REG_CONTROL, 7, !enable );
+}
+
+/**
+ * @brief Checks if Interrupts/alarms or square wave output is enabled when the PT7C4339 RTC is operating on battery.
+ *
+ * Reads the BBSQI (Battery-Backed Square-Wave and Interrupt Enable) bit from the control register.
+ *
+ * @return bool True if operation on battery is enabled, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::isIntFromBatteryEnabled()
+{
+  PT7C4339_TRACE( PT7C4339_API_IS_INT_FROM_BATTERY_ENABLED );
+  return readBit( PT7C4339_REG_CONTROL, 5 );
+}
+
+/**
+ * @brief Enables or disables the Interrupts/alarms or square wave output when the PT7C4339 RTC is operating on battery.
+ *
+ * This function sets or clears the BBSQI (Battery-Backed Square-Wave and Interrupt Enable) bit in the control register.
+ *
+ * @param enable Set to true to enable the oscillator, false to disable it.
+ * @return bool True if the operation was successful, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::enableIntFromBattery( bool enable )
+{
+  PT7C4339_TRACE( PT7C4339_API_ENABLE_INT_FROM_BATTERY );
+  return writeBit( PT7C4339_REG_CONTROL, 5, enable );
+}
+
+/**
+ * @brief Retrieves the current square wave frequency setting from the PT7C4339 RTC.
+ *
+ * This function reads the square wave frequency bits (RS2, RS1) from the control register
+ * and returns it as an enum value.
+ *
+ * @return PT7C4339_sqwFrequency The current square wave frequency setting.
+ */
+template<class Bus>
+PT7C4339_sqwFrequency PT7C4339T<Bus>::getSqwFrequency()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_SQW_FREQUENCY );
+  PT7C4339_sqwFrequency freq = static_cast<PT7C4339_sqwFrequency>( ( readRegister( PT7C4339_REG_CONTROL ) >> 3 ) & 0x03 );
+
+  return freq;
+}
+
+/**
+ * @brief Sets the square wave frequency of the PT7C4339 RTC.
+ *
+ * This function sets the square wave frequency by writing the
+ * square wave frequency bits (RS2, RS1) bits to the control register.
+ * The input frequency must be one of the defined PT7C4339_sqwFrequency enum values.
+ *
+ * @param frequency PT7C4339_sqwFrequency The desired square wave frequency to set.
+ * @return bool True if the operation was successful, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setSqwFrequency( PT7C4339_sqwFrequency frequency )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_SQW_FREQUENCY );
+  bool setSuccess;
+
+  uint8_t buf;
+  if( !readRegisters( PT7C4339_REG_CONTROL, &buf, 1 ) ) return false;
+  buf &= 0xE7;
+
+  if( writeRegister( PT7C4339_REG_CONTROL, buf | ( frequency << 3 ) ) ) setSuccess = true;
+  else setSuccess = false;
+
+  return setSuccess;
+}
+
+/**
+ * @brief Checks if the oscillator of the PT7C4339 RTC was stopped.
+ *
+ * This function reads the OSF (Oscillator Stop Flag) from the status register.
+ *
+ * @return bool True if the oscillator was stopped, false otherwise.
+ * 
+ * @note The Oscillator Stop Flag is set when the oscillator stops, or if some other factor
+ * causes the timekeeping to be inaccurate. If it is set, the accuracy of the kept time can not be guaranteed.
+ * The flag can be cleared by calling clearRtcStopFlag().
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::getRtcStopFlag()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_RTC_STOP_FLAG );
+  return readBit( PT7C4339_REG_STATUS, 7 );
+}
+
+/**
+ * @brief Clears the Oscillator Stop Flag of the PT7C4339 RTC.
+ *
+ * This function clears the OSF (Oscillator Stop Flag) in the status register with clearStatusFlags(),
+ * without touching the alarm flags.
+ *
+ * @return bool True if the operation was successful, false otherwise.
+ * 
+ * @note The Oscillator Stop Flag is set when the oscillator stops, or if some other factor
+ * causes the timekeeping to be inaccurate. If it is set, the accuracy of the kept time can not be guaranteed.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::clearRtcStopFlag()
+{
+  PT7C4339_TRACE( PT7C4339_API_CLEAR_RTC_STOP_FLAG );
+  return clearStatusFlags( 0x80 );
+}
+
+/**
+ * @brief Checks the wether the output of the PT7C4339 RTC is configured for Interrupt/alarm or square wave mode.
+ *
+ * This function reads the INTCN (Interrupt output pin select) bit in the control register.
+ *
+ * @return bool True if the output is set to Interrupt/alarm mode, false if set to square wave mode.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::getIntOrSqwFlag()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_INT_OR_SQW_FLAG );
+  return readBit( PT7C4339_REG_CONTROL, 2 );
+}
+
+/**
+ * @brief Sets the output of the PT7C4339 RTC to either Interrupt/alarm or square wave mode.
+ *
+ * This function configures the INTCN (Interrupt output pin select) bit in the control register.
+ *
+ * @param setting true to enable interrupt/alarm mode, false for square wave mode.
+ * @return bool True if the operation was successful, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setIntOrSqwFlag( bool setting )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_INT_OR_SQW_FLAG );
+  return writeBit( PT7C4339_REG_CONTROL, 2, setting );
+}
+
+/**
+ * @brief Checks if the trickle charger is enabled on the PT7C4339 RTC.
+ *
+ * This function reads bits 4-7 of the trickle charger register and interprets them
+ * as the trickle charger enable state.
+ *
+ * @return PT7C4339_trickleChargerEnabled The current trickle charger enable state.
+ */
+template<class Bus>
+PT7C4339_trickleChargerEnabled PT7C4339T<Bus>::getTrickleChargerEnabled()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_TRICKLE_CHARGER_ENABLED );
+  PT7C4339_trickleChargerEnabled enabled = static_cast<PT7C4339_trickleChargerEnabled>( ( readRegister( PT7C4339_REG_TRICKLE_CHARGER ) >> 4 ) & 0x0F );
+
+  if( ( enabled != PT7C4339_TRICKLE_DISABLE ) && ( enabled != PT7C4339_TRICKLE_ENABLE ) ) enabled = PT7C4339_TRICKLE_DISABLE;
+
+  return enabled;
+}
+
+/**
+ * @brief Checks the trickle charger diode setting of the PT7C4339 RTC.
+ *
+ * This function reads bits 2-3 of the trickle charger register and interprets them
+ * as the trickle charger diode setting.
+ *
+ * @return trickleChargerDiode The current trickle charger diode setting.
+ */
+template<class Bus>
+PT7C4339_trickleChargerDiode PT7C4339T<Bus>::getTrickleChargerDiode()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_TRICKLE_CHARGER_DIODE );
+  PT7C4339_trickleChargerDiode diode = static_cast<PT7C4339_trickleChargerDiode>( ( readRegister( PT7C4339_REG_TRICKLE_CHARGER ) >> 2 ) & 0x03 );
+
+  if( ( diode != PT7C4339_DIODE_DISABLE ) && ( diode != PT7C4339_DIODE_ENABLE ) ) diode = PT7C4339_DIODE_DISABLE;
+
+  return diode;
+}
+
+/**
+ * @brief Checks the trickle charger resistor setting of the PT7C4339 RTC.
+ *
+ * This function reads bits 0-1 of the trickle charger register and interprets them
+ * as the trickle charger resistor setting.
+ *
+ * @return PT7C4339_trickleChargerResistor The current trickle charger resistor setting.
+ */
+template<class Bus>
+PT7C4339_trickleChargerResistor PT7C4339T<Bus>::getTrickleChargerResistor()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_TRICKLE_CHARGER_RESISTOR );
+  PT7C4339_trickleChargerResistor resistor = static_cast<PT7C4339_trickleChargerResistor>( readRegister( PT7C4339_REG_TRICKLE_CHARGER ) & 0x03 );
+
+  return resistor;
+}
+
+/**
+ * @brief Configures the trickle charger settings of the PT7C4339 RTC.
+ *
+ * This function sets the trickle charger configuration by writing to the
+ * trickle charger register. The configuration includes enabling or
+ * disabling the trickle charger, enabling or disabling the diode, 
+ * and choosing the resistor value.
+ *
+ * @param enable PT7C4339_trickleChargerEnabled Specifies whether the trickle charger is enabled or disabled.
+ * @param diode trickleChargerDiode Selects the diode configuration for the trickle charger.
+ * @param resistor PT7C4339_trickleChargerResistor Selects the resistor value for the trickle charger.
+ * @return true if the configuration was successfully written to the register, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setTrickleChargerConfig( PT7C4339_trickleChargerEnabled enable, PT7C4339_trickleChargerDiode diode, PT7C4339_trickleChargerResistor resistor )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_TRICKLE_CHARGER_CONFIG );
+  bool setSuccess;
+
+  if( writeRegister( PT7C4339_REG_TRICKLE_CHARGER, ( enable << 4 ) | ( diode << 2 ) | resistor ) ) setSuccess = true;
+  else setSuccess = false;
+
+  return setSuccess;
+}
+
+/**
+ * @brief Resets all registers of the PT7C4339 RTC to their first power-on state.
+ *
+ * The oscillator is stopped first with a single write of the control register, so the countdown chain is held
+ * while the timekeeping registers are written. After 1ms, the whole power-on image of registers 0x00-0x10 is written
+ * with one auto-increment burst (split by the bus policy if it does not fit in its buffer), and read back with one
+ * burst read unless the verification policy is PT7C4339_VERIFY_NEVER. The image restarts the oscillator.
+ * Inside an update started with beginUpdate(), the image is only staged.
+ *
+ * @return bool True if every register was written and verified, false otherwise.
+ * 
+ * @note The Oscillator Stop Flag is set by this function. It should be cleared by calling clearRtcStopFlag().
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::reset()
+{
+  PT7C4339_TRACE( PT7C4339_API_RESET );
+  if( _updateActive ) return writeRegisters( PT7C4339_REG_SECONDS, resetImage, PT7C4339_REGISTER_COUNT );
+
+  uint8_t control = resetImage[PT7C4339_REG_CONTROL] | 0x80; // /EOSC = 1, stop the oscillator
+  if( !writeBus( PT7C4339_REG_CONTROL, &control, 1 ) )
+  {
+    _cacheValid = false;
+    return false;
+  }
+
+  updateCache( PT7C4339_REG_CONTROL, &control, 1 );
+  _bus.sleepMillis( 1 );
+
+  return writeRegisters( PT7C4339_REG_SECONDS, resetImage, PT7C4339_REGISTER_COUNT );
+}
+
+/**
+ * @brief Retrieves the whole configuration of alarm 1 with a single burst read of registers 0x07-0x0A.
+ *
+ * The mask bits and the day/date bit are decoded into the match rate, the BCD fields into the match time and day/date.
+ * The day/date is returned like by getA1DayDate(): 'weekDay' is set if the alarm matches the day of the week, 'day' otherwise.
+ *
+ * @return PT7C4339_Alarm1Config The alarm 1 configuration. If the read fails, every field is 0.
+ */
+template<class Bus>
+PT7C4339_Alarm1Config PT7C4339T<Bus>::getAlarm1()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_ALARM1 );
+  PT7C4339_Alarm1Config config = {};
+  uint8_t buf[4];
+
+  if( !readRegisters( PT7C4339_REG_A1_SECONDS, buf, 4 ) ) return config;
+
+  config.rate = static_cast<PT7C4339_A1_rate>( ( ( buf[3] >> 6 ) & 0x01 ) << 4 | ( buf[3] >> 7 ) << 3 | ( buf[2] >> 7 ) << 2 | ( buf[1] >> 7 ) << 1 | ( buf[0] >> 7 ) );
+  config.time.second = bcdToDec( buf[0] & 0x7F );
+  config.time.minute = bcdToDec( buf[1] & 0x7F );
+  config.time.hour = bcdToDec( buf[2] & 0x3F );
+  config.dayDate = decodeAlarmDayDate( buf[3] );
+
+  return config;
+}
+
+/**
+ * @brief Sets the whole configuration of alarm 1 with a single burst write of registers 0x07-0x0A.
+ *
+ * The match rate selects the mask bits and whether 'dayDate.day' (day of the month) or 'dayDate.weekDay' (day of the week)
+ * is written to the day/date register. The day/date must be valid if the rate matches on it, and is written as given otherwise.
+ *
+ * @param config The alarm 1 configuration to set.
+ * @return bool True if the configuration is valid and was written successfully, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setAlarm1( PT7C4339_Alarm1Config config )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_ALARM1 );
+  uint8_t buf[4];
+
+  if( !encodeAlarm1( config, buf ) ) return false;
+
+  return writeRegisters( PT7C4339_REG_A1_SECONDS, buf, 4 );
+}
+
+/**
+ * @brief Validates an alarm 1 configuration and encodes it into the values of registers 0x07-0x0A.
+ *
+ * @param config The alarm 1 configuration to encode.
+ * @param buf Buffer of at least 4 bytes that receives the register values.
+ * @return bool True if the configuration is valid, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::encodeAlarm1( PT7C4339_Alarm1Config config, uint8_t *buf )
+{
+  if( config.time.hour >= 24 || config.time.minute >= 60 || config.time.second >= 60 ) return false;
+
+  bool byWeekDay = config.rate & 0x10;
+  bool dayMatched = !( config.rate & 0x08 );
+  uint8_t dayDate;
+
+  if( !encodeAlarmDayDate( config.dayDate, byWeekDay, dayMatched, &dayDate ) ) return false;
+
+  buf[0] = ( ( config.rate & 0x01 ) << 7 ) | decToBcd( config.time.second );
+  buf[1] = ( ( ( config.rate >> 1 ) & 0x01 ) << 7 ) | decToBcd( config.time.minute );
+  buf[2] = ( ( ( config.rate >> 2 ) & 0x01 ) << 7 ) | decToBcd( config.time.hour );
+  buf[3] = ( ( ( config.rate >> 3 ) & 0x01 ) << 7 ) | ( byWeekDay << 6 ) | dayDate;
+
+  return true;
+}
+
+/**
+ * @brief Checks if a match with alarm 1 can trigger the INT/SQW output on the PT7C4339 RTC.
+ *
+ * This function reads bit 0 of the control register and returns it.
+ *
+ * @return bool True if enabled, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::isA1IntEnabled()
+{
+  PT7C4339_TRACE( PT7C4339_API_IS_A1_INT_ENABLED );
+  return readBit( PT7C4339_REG_CONTROL, 0 );
+}
+
+/**
+ * @brief Enables or disables triggering the INT/SQW output by alarm 1 on the PT7C4339 RTC.
+ *
+ * This function writes to bit 0 of the control register.
+ *
+ * @param enable true to enable, false to disable.
+ * @return bool True if the operation was successful, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::enableA1Int( bool enable )
+{
+  PT7C4339_TRACE( PT7C4339_API_ENABLE_A1_INT );
+  return writeBit( PT7C4339_REG_CONTROL, 0, enable );
+}
+
+/**
+ * @brief Checks if there was a match with alarm 1 on the PT7C4339 RTC.
+ *
+ * This function reads bit 0 of the status register and returns it.
+ *
+ * @return bool True if a match has happened, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::getA1Flag()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_A1_FLAG );
+  return readBit( PT7C4339_REG_STATUS, 0 );
+}
+
+/**
+ * @brief Clears the alarm 1 matched flag on the PT7C4339 RTC.
+ *
+ * This function clears bit 0 of the status register with clearStatusFlags(), without touching the other flags.
+ *
+ * @return bool True if the operation was successful, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::clearA1Flag()
+{
+  PT7C4339_TRACE( PT7C4339_API_CLEAR_A1_FLAG );
+  return clearStatusFlags( PT7C4339_ALARM1_EVENT );
+}
+
+/**
+ * @brief Retrieves the match rate of alarm 1 from the PT7C4339 RTC.
+ *
+ * This function reads the alarm 1 registers with one burst read and returns the mask bits and the day/date bit as a match rate.
+ *
+ * @return PT7C4339_A1_rate The current match rate of alarm 1.
+ */
+template<class Bus>
+PT7C4339_A1_rate PT7C4339T<Bus>::getA1Rate()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_A1_RATE );
+  return getAlarm1().rate;
+}
+
+/**
+ * @brief Sets the match rate of alarm 1 on the PT7C4339 RTC.
+ *
+ * This function sets the alarm 1 mask bits and day/date bit based on the provided match rate,
+ * reading and writing registers 0x07-0x0A in one burst each, and leaves the match time and day/date values unchanged.
+ *
+ * @param rate PT7C4339_A1_rate The chosen match rate.
+ * @return bool True if the write was successful, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setA1Rate( PT7C4339_A1_rate rate )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_A1_RATE );
+  uint8_t buf[4];
+
+  if( !readRegisters( PT7C4339_REG_A1_SECONDS, buf, 4 ) ) return false;
+
+  buf[0] = ( buf[0] & 0x7F ) | ( ( rate & 0x01 ) << 7 );
+  buf[1] = ( buf[1] & 0x7F ) | ( ( ( rate >> 1 ) & 0x01 ) << 7 );
+  buf[2] = ( buf[2] & 0x7F ) | ( ( ( rate >> 2 ) & 0x01 ) << 7 );
+  buf[3] = ( buf[3] & 0x3F ) | ( ( ( rate >> 3 ) & 0x01 ) << 7 ) | ( ( ( rate >> 4 ) & 0x01 ) << 6 );
+
+  return writeRegisters( PT7C4339_REG_A1_SECONDS, buf, 4 );
+}
+
+/**
+ * @brief Retrieves the alarm 1 match time from the PT7C4339 RTC.
+ *
+ * This function reads the alarm 1 registers with one burst read
+ * and returns the match time encapsulated in a PT7C4339_Time structure.
+ *
+ * @return PT7C4339_Time Structure containing the alarm 1 match time (hours, minutes, seconds).
+ */
+template<class Bus>
+PT7C4339_Time PT7C4339T<Bus>::getA1Time()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_A1_TIME );
+  return getAlarm1().time;
+}
+
+/**
+ * @brief Sets the alarm 1 match time of the PT7C4339 RTC.
+ *
+ * This function sets the alarm 1 match seconds, minutes, and hour of the RTC,
+ * reading and writing registers 0x07-0x09 in one burst each to keep the mask bits.
+ *
+ * @param time A PT7C4339_Time struct containing the hour, minute, and second to set.
+ * @return bool True if the write was successful, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setA1Time( PT7C4339_Time time )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_A1_TIME );
+  if( time.hour >= 24 || time.minute >= 60 || time.second >= 60 ) return false;
+
+  uint8_t buf[3];
+  if( !readRegisters( PT7C4339_REG_A1_SECONDS, buf, 3 ) ) return false;
+
+  buf[0] = ( buf[0] & 0x80 ) | decToBcd( time.second );
+  buf[1] = ( buf[1] & 0x80 ) | decToBcd( time.minute );
+  buf[2] = ( buf[2] & 0x80 ) | decToBcd( time.hour );
+
+  return writeRegisters( PT7C4339_REG_A1_SECONDS, buf, 3 );
+}
+
+/**
+ * @brief Retrieves the alarm 1 date information from the PT7C4339 RTC.
+ *
+ * This function reads the alarm 1 date register and determines whether the alarm is set
+ * by day of the month or by day of the week. It then populates a PT7C4339_Date structure
+ * with the corresponding values. The year and month fields are set to 0, as the alarm
+ * register does not store this information.
+ *
+ * @return PT7C4339_Date Structure containing the alarm 1 date or weekday information.
+ *         - If the alarm is set by weekday, 'weekDay' is set and 'day' is 0.
+ *         - If the alarm is set by day, 'day' is set and 'weekDay' is PT7C4339_WEEKDAY_UNKNOWN.
+ */
+template<class Bus>
+PT7C4339_Date PT7C4339T<Bus>::getA1DayDate()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_A1_DAY_DATE );
+  return decodeAlarmDayDate( readRegister( PT7C4339_REG_A1_DAY_DATE ) );
+}
+
+/**
+ * @brief Sets the alarm 1 day/date register for the PT7C4339 RTC.
+ *
+ * This function configures the alarm 1 day/date register based on the provided date.
+ * It supports setting either a specific day of the month or a specific weekday.
+ * - If `date.day` is 0 and `date.weekDay` is valid, the alarm is set for the specified weekday.
+ * - If `date.day` is valid and `date.weekDay` is PT7C4339_WEEKDAY_UNKNOWN, the alarm is set for the specified day of the month.
+ *
+ * @param date The PT7C4339_Date structure containing the day and/or weekday to set for the alarm.
+ * @return true if the register was successfully written, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setA1DayDate( PT7C4339_Date date )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_A1_DAY_DATE );
+  uint8_t value;
+
+  bool byWeekDay = ( date.day == 0 );
+  if( byWeekDay == ( date.weekDay == PT7C4339_WEEKDAY_UNKNOWN ) ) return false;
+  if( !encodeAlarmDayDate( date, byWeekDay, true, &value ) ) return false;
+
+  uint8_t current;
+  if( !readRegisters( PT7C4339_REG_A1_DAY_DATE, &current, 1 ) ) return false;
+
+  uint8_t maskBit = current & 0x80;
+
+  return writeRegister( PT7C4339_REG_A1_DAY_DATE, maskBit | ( byWeekDay << 6 ) | value );
+}
+
+/**
+ * @brief Retrieves the whole configuration of alarm 2 with a single burst read of registers 0x0B-0x0D.
+ *
+ * The mask bits and the day/date bit are decoded into the match rate, the BCD fields into the match time and day/date.
+ * The day/date is returned like by getA2DayDate(): 'weekDay' is set if the alarm matches the day of the week, 'day' otherwise.
+ *
+ * @return PT7C4339_Alarm2Config The alarm 2 configuration, with seconds always 0. If the read fails, every field is 0.
+ */
+template<class Bus>
+PT7C4339_Alarm2Config PT7C4339T<Bus>::getAlarm2()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_ALARM2 );
+  PT7C4339_Alarm2Config config = {};
+  uint8_t buf[3];
+
+  if( !readRegisters( PT7C4339_REG_A2_MINUTES, buf, 3 ) ) return config;
+
+  config.rate = static_cast<PT7C4339_A2_rate>( ( ( buf[2] >> 6 ) & 0x01 ) << 3 | ( buf[2] >> 7 ) << 2 | ( buf[1] >> 7 ) << 1 | ( buf[0] >> 7 ) );
+  config.time.second = 0;
+  config.time.minute = bcdToDec( buf[0] & 0x7F );
+  config.time.hour = bcdToDec( buf[1] & 0x3F );
+  config.dayDate = decodeAlarmDayDate( buf[2] );
+
+  return config;
+}
+
+/**
+ * @brief Sets the whole configuration of alarm 2 with a single burst write of registers 0x0B-0x0D.
+ *
+ * The match rate selects the mask bits and whether 'dayDate.day' (day of the month) or 'dayDate.weekDay' (day of the week)
+ * is written to the day/date register. The day/date must be valid if the rate matches on it, and is written as given otherwise.
+ *
+ * @param config The alarm 2 configuration to set. Seconds are ignored.
+ * @return bool True if the configuration is valid and was written successfully, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setAlarm2( PT7C4339_Alarm2Config config )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_ALARM2 );
+  if( config.time.hour >= 24 || config.time.minute >= 60 ) return false;
+
+  bool byWeekDay = config.rate & 0x08;
+  bool dayMatched = !( config.rate & 0x04 );
+  uint8_t dayDate;
+
+  if( !encodeAlarmDayDate( config.dayDate, byWeekDay, dayMatched, &dayDate ) ) return false;
+
+  uint8_t buf[3];
+  buf[0] = ( ( config.rate & 0x01 ) << 7 ) | decToBcd( config.time.minute );
+  buf[1] = ( ( ( config.rate >> 1 ) & 0x01 ) << 7 ) | decToBcd( config.time.hour );
+  buf[2] = ( ( ( config.rate >> 2 ) & 0x01 ) << 7 ) | ( byWeekDay << 6 ) | dayDate;
+
+  return writeRegisters( PT7C4339_REG_A2_MINUTES, buf, 3 );
+}
+
+/**
+ * @brief Decodes the value of an alarm day/date register.
+ *
+ * @param value The register value.
+ * @return PT7C4339_Date The day of the week in 'weekDay' if the DY/DT bit is set, the day of the month in 'day' otherwise.
+ *         Year and month are 0.
+ */
+template<class Bus>
+PT7C4339_Date PT7C4339T<Bus>::decodeAlarmDayDate( uint8_t value )
+{
+  PT7C4339_Date date = {};
+
+  if( value & 0x40 ) date.weekDay = static_cast<PT7C4339_daysOfWeek>( value & 0x07 );
+  else date.day = bcdToDec( value & 0x3F );
+
+  return date;
+}
+
+/**
+ * @brief Encodes the day or weekday of an alarm into the value bits of an alarm day/date register.
+ *
+ * @param dayDate The day of the month in 'day', or the day of the week in 'weekDay'.
+ * @param byWeekDay True to encode the day of the week, false to encode the day of the month.
+ * @param matched True if the alarm matches on the day/date, so it must be valid (1-31 or 1-7).
+ * @param value Receives the encoded value, without the mask and DY/DT bits.
+ * @return bool True if the day/date could be encoded, false if it is out of range.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::encodeAlarmDayDate( PT7C4339_Date dayDate, bool byWeekDay, bool matched, uint8_t *value )
+{
+  if( dayDate.day > 31 || dayDate.weekDay > 7 ) return false;
+
+  if( byWeekDay )
+  {
+    if( matched && dayDate.weekDay == PT7C4339_WEEKDAY_UNKNOWN ) return false;
+    *value = dayDate.weekDay;
+  }
+  else
+  {
+    if( matched && dayDate.day == 0 ) return false;
+    *value = decToBcd( dayDate.day );
+  }
+
+  return true;
+}
+
+/**
+ * @brief Checks if a match with alarm 2 can trigger the INT/SQW output on the PT7C4339 RTC.
+ *
+ * This function reads bit 1 of the control register and returns it.
+ *
+ * @return bool True if enabled, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::isA2IntEnabled()
+{
+  PT7C4339_TRACE( PT7C4339_API_IS_A2_INT_ENABLED );
+  return readBit( PT7C4339_REG_CONTROL, 1 );
+}
+
+/**
+ * @brief Enables or disables triggering the INT/SQW output by alarm 2 on the PT7C4339 RTC.
+ *
+ * This function writes to bit 1 of the control register.
+ *
+ * @param enable true to enable, false to disable.
+ * @return bool True if the operation was successful, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::enableA2Int( bool enable )
+{
+  PT7C4339_TRACE( PT7C4339_API_ENABLE_A2_INT );
+  return writeBit( PT7C4339_REG_CONTROL, 1, enable );
+}
+
+/**
+ * @brief Checks if there was a match with alarm 2 on the PT7C4339 RTC.
+ *
+ * This function reads bit 1 of the status register and returns it.
+ *
+ * @return bool True if a match has happened, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::getA2Flag()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_A2_FLAG );
+  return readBit( PT7C4339_REG_STATUS, 1 );
+}
+
+/**
+ * @brief Clears the alarm 2 matched flag on the PT7C4339 RTC.
+ *
+ * This function clears bit 1 of the status register with clearStatusFlags(), without touching the other flags.
+ *
+ * @return bool True if the operation was successful, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::clearA2Flag()
+{
+  PT7C4339_TRACE( PT7C4339_API_CLEAR_A2_FLAG );
+  return clearStatusFlags( PT7C4339_ALARM2_EVENT );
+}
+
+/**
+ * @brief Retrieves the match rate of alarm 2 from the PT7C4339 RTC.
+ *
+ * This function reads the alarm 2 registers with one burst read and returns the mask bits and the day/date bit as a match rate.
+ *
+ * @return PT7C4339_A2_rate The current match rate of alarm 2.
+ */
+template<class Bus>
+PT7C4339_A2_rate PT7C4339T<Bus>::getA2Rate()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_A2_RATE );
+  return getAlarm2().rate;
+}
+
+/**
+ * @brief Sets the match rate of alarm 2 on the PT7C4339 RTC.
+ *
+ * This function sets the alarm 2 mask bits and day/date bit based on the provided match rate,
+ * reading and writing registers 0x0B-0x0D in one burst each, and leaves the match time and day/date values unchanged.
+ *
+ * @param rate PT7C4339_A2_rate The chosen match rate.
+ * @return bool True if the write was successful, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setA2Rate( PT7C4339_A2_rate rate )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_A2_RATE );
+  uint8_t buf[3];
+
+  if( !readRegisters( PT7C4339_REG_A2_MINUTES, buf, 3 ) ) return false;
+
+  buf[0] = ( buf[0] & 0x7F ) | ( ( rate & 0x01 ) << 7 );
+  buf[1] = ( buf[1] & 0x7F ) | ( ( ( rate >> 1 ) & 0x01 ) << 7 );
+  buf[2] = ( buf[2] & 0x3F ) | ( ( ( rate >> 2 ) & 0x01 ) << 7 ) | ( ( ( rate >> 3 ) & 0x01 ) << 6 );
+
+  return writeRegisters( PT7C4339_REG_A2_MINUTES, buf, 3 );
+}
+
+/**
+ * @brief Retrieves the alarm 2 match time from the PT7C4339 RTC.
+ *
+ * This function reads the alarm 2 registers with one burst read
+ * and returns the match time encapsulated in a PT7C4339_Time structure.
+ *
+ * @return PT7C4339_Time Structure containing the alarm 2 match time (hours, minutes, seconds = 0).
+ */
+template<class Bus>
+PT7C4339_Time PT7C4339T<Bus>::getA2Time()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_A2_TIME );
+  return getAlarm2().time;
+}
+
+/**
+ * @brief Sets the alarm 2 match time of the PT7C4339 RTC.
+ *
+ * This function sets the alarm 2 match minutes and hour of the RTC,
+ * reading and writing registers 0x0B-0x0C in one burst each to keep the mask bits.
+ *
+ * @param time A PT7C4339_Time struct containing the hour and minute to set. Seconds are ignored.
+ * @return bool True if the write was successful, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setA2Time( PT7C4339_Time time )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_A2_TIME );
+  if( time.hour >= 24 || time.minute >= 60 ) return false;
+
+  uint8_t buf[2];
+  if( !readRegisters( PT7C4339_REG_A2_MINUTES, buf, 2 ) ) return false;
+
+  buf[0] = ( buf[0] & 0x80 ) | decToBcd( time.minute );
+  buf[1] = ( buf[1] & 0x80 ) | decToBcd( time.hour );
+
+  return writeRegisters( PT7C4339_REG_A2_MINUTES, buf, 2 );
+}
+
+/**
+ * @brief Retrieves the alarm 2 date information from the PT7C4339 RTC.
+ *
+ * This function reads the alarm 2 date register and determines whether the alarm is set
+ * by day of the month or by day of the week. It then populates a PT7C4339_Date structure
+ * with the corresponding values. The year and month fields are set to 0, as the alarm
+ * register does not store this information.
+ *
+ * @return PT7C4339_Date Structure containing the alarm 2 date or weekday information.
+ *         - If the alarm is set by weekday, 'weekDay' is set and 'day' is 0.
+ *         - If the alarm is set by day, 'day' is set and 'weekDay' is PT7C4339_WEEKDAY_UNKNOWN.
+ */
+template<class Bus>
+PT7C4339_Date PT7C4339T<Bus>::getA2DayDate()
+{
+  PT7C4339_TRACE( PT7C4339_API_GET_A2_DAY_DATE );
+  return decodeAlarmDayDate( readRegister( PT7C4339_REG_A2_DAY_DATE ) );
+}
+
+/**
+ * @brief Sets the alarm 2 day/date register for the PT7C4339 RTC.
+ *
+ * This function configures the alarm 2 day/date register based on the provided date.
+ * It supports setting either a specific day of the month or a specific weekday.
+ * - If `date.day` is 0 and `date.weekDay` is valid, the alarm is set for the specified weekday.
+ * - If `date.day` is valid and `date.weekDay` is PT7C4339_WEEKDAY_UNKNOWN, the alarm is set for the specified day of the month.
+ *
+ * @param date The PT7C4339_Date structure containing the day and/or weekday to set for the alarm.
+ * @return true if the register was successfully written, false otherwise.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setA2DayDate( PT7C4339_Date date )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_A2_DAY_DATE );
+  uint8_t value;
+
+  bool byWeekDay = ( date.day == 0 );
+  if( byWeekDay == ( date.weekDay == PT7C4339_WEEKDAY_UNKNOWN ) ) return false;
+  if( !encodeAlarmDayDate( date, byWeekDay, true, &value ) ) return false;
+
+  uint8_t current;
+  if( !readRegisters( PT7C4339_REG_A2_DAY_DATE, &current, 1 ) ) return false;
+
+  uint8_t maskBit = current & 0x80;
+
+  return writeRegister( PT7C4339_REG_A2_DAY_DATE, maskBit | ( byWeekDay << 6 ) | value );
+}
+
+/**
+ * @brief Writes raw values to consecutive alarm registers (0x07-0x0D) with one burst, then verifies them according to the verification policy.
+ *
+ * For register values prepared elsewhere, e.g. by PT7C4339_cronCompile(), so that a re-arm writes only the registers that changed.
+ * The values are written as they are, mask and DY/DT bits included.
+ *
+ * @param REG The address of the first alarm register to write.
+ * @param DATA The register values.
+ * @param length The number of registers to write, all within 0x07-0x0D.
+ * @return bool True if the registers were written (and verified, if applicable), false if the range is outside the alarm registers or the write failed.
+ */
+template<class Bus>
+bool PT7C4339T<Bus>::setAlarmRegisters( uint8_t REG, const uint8_t *DATA, uint8_t length )
+{
+  PT7C4339_TRACE( PT7C4339_API_SET_ALARM_REGISTERS );
+  if( length == 0 || REG < PT7C4339_REG_A1_SECONDS || REG + length - 1 > PT7C4339_REG_A2_DAY_DATE ) return false;
+
+  return writeRegisters( REG, DATA, length );
+}
+
+/**
+ * @brief Registers the function called by service() when alarm 1 matched.
+ *
+ * @param callback The function to call, or nullptr to leave the alarm 1 flag to getA1Flag() and clearA1Flag().
+ */
+template<class Bus>
+void PT7C4339T<Bus>::onAlarm1( PT7C4339_alarmCallback callback )
+{
+  _onAlarm1 = callback;
+}
+
+/**
+ * @brief Registers the function called by service() when alarm 2 matched.
+ *
+ * @param callback The function to call, or nullptr to leave the alarm 2 flag to getA2Flag() and clearA2Flag().
+ */
+template<class Bus>
+void PT7C4339T<Bus>::onAlarm2( PT7C4339_alarmCallback callback )
+{
+  _onAlarm2 = callback;
+}
+
+/**
+ * @brief Marks an interrupt as pending for service(). Call it from the falling edge interrupt of the INT/SQW pin.
+ *
+ * It only sets a flag, so it is safe to call from an interrupt and takes no I2C traffic.
+ */
+template<class Bus>
+void PT7C4339T<Bus>::notifyInterrupt()
+{
+  _interruptPending = true;
+}
+
+/**
+ * @brief Handles the alarms that matched since the last interrupt. Call it from the main loop.
+ *
+ * If notifyInterrupt() was called since the last call, the status register is read once, every alarm flag that is set
+ * and has a callback is cleared with a single write, then the callbacks are called, alarm 1 first.
+ * Flags are cleared before the callbacks run, so an alarm matching again during a callback raises a new interrupt.
+ * The write keeps OSF and the flags that were not handled at 1, which leaves them unchanged on the device,
+ * so an OSF or an alarm flag set between the read and the write is never lost.
+ * Without a pending interrupt, there is no I2C traffic.
+ *
+ * @return uint8_t The alarms handled, a combination of PT7C4339_ALARM1_EVENT and PT7C4339_ALARM2_EVENT, 0 if none.
+ *         If the bus fails, the interrupt stays pending and 0 is returned.
+ *
+ * @note An alarm flag without a callback keeps INT/SQW low, so no further falling edge arrives until it is cleared.
+ */
+template<class Bus>
+uint8_t PT7C4339T<Bus>::service()
+{
+  if( !_interruptPending ) return 0;
+
+  PT7C4339_TRACE( PT7C4339_API_SERVICE );
+  _interruptPending = false;
+
+  uint8_t status;
+  if( !readBus( PT7C4339_REG_STATUS, &status, 1 ) )
+  {
+    _interruptPending = true;
+    return 0;
+  }
+
+  uint8_t handled = status & ( PT7C4339_ALARM1_EVENT | PT7C4339_ALARM2_EVENT );
+  if( _onAlarm1 == nullptr ) handled &= ~PT7C4339_ALARM1_EVENT;
+  if( _onAlarm2 == nullptr ) handled &= ~PT7C4339_ALARM2_EVENT;
+
+  if( handled == 0 ) return 0;
+
+  uint8_t clear = 0x83 & ~handled; // OSF, A2F and A1F can only be cleared, writing 1 leaves them unchanged
+  if( !writeBus( PT7C4339_REG_STATUS, &clear, 1 ) )
+  {
+    _interruptPending = true;
+    return 0;
+  }
+
+  if( handled & PT7C4339_ALARM1_EVENT ) _onAlarm1();
+  if( handled & PT7C4339_ALARM2_EVENT ) _onAlarm2();
+
+  return handled;
+}
+
+#endif
@@ -19,7 +19,14 @@
 #ifndef _PT7C4339_RTC_H_
 #define _PT7C4339_RTC_H_
 
-#include <Wire.h>
+#ifndef PT7C4339_NO_WIRE
+  #include <Arduino.h>
+#else
+  #include <stddef.h>
+  #include <stdint.h>
+  #include <string.h>
+#endif
+#include "PT7C4339-Calendar.h"
 
 #define PT7C4339_I2C_ADDRESS          0x68 ///< 7bit I2C address of the PT7C4339 RTC
 
@@ -41,17 +48,47 @@
 #define PT7C4339_REG_STATUS           0x0F ///< Register address for status bits
 #define PT7C4339_REG_TRICKLE_CHARGER  0x10 ///< Register address for the trickle charger
 
-enum PT7C4339_daysOfWeek ///< Enum for the days of the week of the PT7C4339 RTC
-{
-  PT7C4339_WEEKDAY_UNKNOWN = 0, ///< Used for calling setDate()
-  PT7C4339_MONDAY = 1, ///< Monday
-  PT7C4339_TUESDAY = 2, ///< Tuesday
-  PT7C4339_WEDNESDAY = 3, ///< Wednesday
-  PT7C4339_THURSDAY = 4, ///< Thursday
-  PT7C4339_FRIDAY = 5, ///< Friday
-  PT7C4339_SATURDAY = 6, ///< Saturday
-  PT7C4339_SUNDAY = 7 ///< Sunday
-};
+#define PT7C4339_REGISTER_COUNT       0x11 ///< Number of registers of the PT7C4339 RTC (0x00-0x10)
+
+#define PT7C4339_REG_NONE             0xFF ///< Used in place of a register address when no register applies
+
+#define PT7C4339_CACHE_FIRST_REG      PT7C4339_REG_A1_SECONDS ///< First register held in the register cache
+#define PT7C4339_CACHE_LAST_REG       PT7C4339_REG_TRICKLE_CHARGER ///< Last register held in the register cache
+#define PT7C4339_CACHE_SIZE           ( PT7C4339_CACHE_LAST_REG - PT7C4339_CACHE_FIRST_REG + 1 ) ///< Number of registers held in the register cache
+
+#define PT7C4339_CONFIG_FIRST_REG     PT7C4339_REG_A1_SECONDS ///< First register of a configuration saved by saveConfig()
+#define PT7C4339_CONFIG_SIZE          ( PT7C4339_REG_TRICKLE_CHARGER - PT7C4339_CONFIG_FIRST_REG + 1 ) ///< Number of registers of a configuration saved by saveConfig() (0x07-0x10)
+#define PT7C4339_CONFIG_CHECKSUM_SEED 0x5A ///< Start value of the checksum of a saved configuration, so that an all 0x00 or all 0xFF blob is rejected
+
+#define PT7C4339_RESUME_MAGIC         0xA0 ///< Upper nibble of the flags of a state saved by getResumeState(), anything else makes resume() fall back to begin()
+#define PT7C4339_RESUME_CACHE_VALID   0x01 ///< Flag of a saved state: the register cache was enabled and valid
+
+/*
+ * Per-method bus statistics (getApiStats(), resetStats(), trackApiStats(), getUntrackedCalls()) are compiled in only if PT7C4339_ENABLE_STATS is defined.
+ * It changes the layout of the PT7C4339 class, so it must be defined for the whole build (e.g. with -DPT7C4339_ENABLE_STATS
+ * in build_flags), not in a sketch before the #include, and so must PT7C4339_STATS_SLOTS if overridden.
+ * Each instance then takes 33 bytes of RAM per slot plus 8 bytes: about 270 bytes with the default 8 slots,
+ * about 2.5 kB with PT7C4339_API_COUNT slots.
+ */
+#ifndef PT7C4339_STATS_SLOTS
+  #define PT7C4339_STATS_SLOTS        8 ///< Number of methods counted at the same time, define it as PT7C4339_API_COUNT to count every method
+#endif
+#define PT7C4339_STATS_BUCKETS        8 ///< Number of latency histogram buckets, bucket n counts calls shorter than 64us << n, the last one every longer call
+
+#define PT7C4339_SOFT_CLOCK_DEFAULT_RESYNC  3600 ///< Default number of SQW edges (seconds) between two resynchronizations of the software clock
+#define PT7C4339_SOFT_CLOCK_GUARD_US        10000 ///< The software clock only reads the RTC at least this long after and before an SQW edge
+#define PT7C4339_SOFT_CLOCK_TIMEOUT_US      2000000 ///< The software clock loses sync if no SQW edge arrives for this long
+
+#ifndef PT7C4339_ASYNC_STEP_BYTES
+  #define PT7C4339_ASYNC_STEP_BYTES   8 ///< Largest number of data bytes moved by one poll() step, a step takes about 1ms on the wire at 100kHz
+#endif
+#define PT7C4339_RESET_STOP_US        1000 ///< Time the oscillator is kept stopped by startReset() before the registers are written
+
+#define PT7C4339_BUS_TIMEOUT_US       25000 ///< Default time limit of one I2C transaction of the bus policies, after which it is aborted as timed out
+#define PT7C4339_BUS_CLEAR_CLOCKS     9 ///< Largest number of SCL pulses sent by a bus recovery to make a slave release SDA
+
+#define PT7C4339_ALARM1_EVENT        0x01 ///< Bit of alarm 1 in the value returned by service(), same as A1F in the status register
+#define PT7C4339_ALARM2_EVENT        0x02 ///< Bit of alarm 2 in the value returned by service(), same as A2F in the status register
 
 enum PT7C4339_sqwFrequency ///< Enum for the frequency of the square wave output of the PT7C4339 RTC
 {
@@ -102,39 +139,280 @@ enum PT7C4339_A2_rate ///< Enum for the trigger rate of alarm 2 of the PT7C43339
   PT7C4339_A2_DISABLE = 0x01 ///< Disable alarm
 };
 
+enum PT7C4339_verifyPolicy ///< Enum for the write verification policy of the PT7C4339 library
+{
+  PT7C4339_VERIFY_ALWAYS = 0, ///< Every write is read back and compared immediately
+  PT7C4339_VERIFY_NEVER = 1, ///< Writes are not read back
+  PT7C4339_VERIFY_DEFERRED = 2 ///< Writes are recorded and read back together by verifyPendingWrites()
+};
+
+enum PT7C4339_asyncOperation ///< Enum of the non-blocking operations of the PT7C4339 library
+{
+  PT7C4339_ASYNC_NONE = 0, ///< No operation was started
+  PT7C4339_ASYNC_READ_DATE_TIME = 1, ///< startReadDateTime()
+  PT7C4339_ASYNC_SET_ALARM1 = 2, ///< startSetAlarm1()
+  PT7C4339_ASYNC_RESET = 3 ///< startReset()
+};
+
+enum PT7C4339_asyncStatus ///< Enum of the states of a non-blocking operation, returned by poll()
+{
+  PT7C4339_ASYNC_IDLE = 0, ///< No operation was started
+  PT7C4339_ASYNC_BUSY = 1, ///< The operation is in progress, call poll() again
+  PT7C4339_ASYNC_DONE = 2, ///< The operation finished successfully
+  PT7C4339_ASYNC_ERROR_BUS = 3, ///< A transaction was not acknowledged or returned fewer bytes than requested, the operation was aborted
+  PT7C4339_ASYNC_ERROR_VERIFY = 4, ///< The registers read back differ from the ones written
+  PT7C4339_ASYNC_ERROR_RANGE = 5 ///< The timekeeping registers read hold a BCD value out of range
+};
+
+enum PT7C4339_status ///< Enum of the outcomes of a bus transfer, returned by the bus policies and by getLastStatus()
+{
+  PT7C4339_STATUS_OK = 0, ///< The transfer succeeded
+  PT7C4339_STATUS_NACK = 1, ///< The address or a data byte was not acknowledged
+  PT7C4339_STATUS_TIMEOUT = 2, ///< The transaction did not finish within the bus timeout, e.g. a slave held SDA or SCL low
+  PT7C4339_STATUS_SHORT_READ = 3, ///< A read returned fewer bytes than requested
+  PT7C4339_STATUS_VERIFY_MISMATCH = 4, ///< The registers read back differ from the ones written
+  PT7C4339_STATUS_BCD_RANGE = 5, ///< A timekeeping register read holds an invalid BCD digit or a value out of range
+  PT7C4339_STATUS_BUS_ERROR = 6 ///< The bus is not initialized, the transfer did not fit in its buffer or the driver failed otherwise
+};
+
+enum PT7C4339_apiMethod ///< Enum of the instrumented public methods of the PT7C4339 library, used to index bus statistics
+{
+  PT7C4339_API_BEGIN = 0, ///< begin()
+  PT7C4339_API_RESUME, ///< resume()
+  PT7C4339_API_RESET, ///< reset()
+  PT7C4339_API_ENABLE_REGISTER_CACHE, ///< enableRegisterCache()
+  PT7C4339_API_REFRESH_REGISTER_CACHE, ///< refreshRegisterCache()
+  PT7C4339_API_VERIFY_PENDING_WRITES, ///< verifyPendingWrites()
+  PT7C4339_API_COMMIT, ///< commit()
+  PT7C4339_API_SAVE_CONFIG, ///< saveConfig()
+  PT7C4339_API_APPLY_CONFIG, ///< applyConfig()
+  PT7C4339_API_GET_DATE_TIME, ///< getDateTime()
+  PT7C4339_API_SET_DATE_TIME, ///< setDateTime()
+  PT7C4339_API_GET_EPOCH, ///< getEpoch()
+  PT7C4339_API_SET_EPOCH, ///< setEpoch()
+  PT7C4339_API_GET_TIME, ///< getTime()
+  PT7C4339_API_SET_TIME, ///< setTime()
+  PT7C4339_API_GET_DATE, ///< getDate()
+  PT7C4339_API_SET_DATE, ///< setDate()
+  PT7C4339_API_GET_SECOND, ///< getSecond()
+  PT7C4339_API_SET_SECOND, ///< setSecond()
+  PT7C4339_API_GET_MINUTE, ///< getMinute()
+  PT7C4339_API_SET_MINUTE, ///< setMinute()
+  PT7C4339_API_GET_HOUR, ///< getHour()
+  PT7C4339_API_SET_HOUR, ///< setHour()
+  PT7C4339_API_GET_YEAR, ///< getYear()
+  PT7C4339_API_SET_YEAR, ///< setYear()
+  PT7C4339_API_GET_MONTH, ///< getMonth()
+  PT7C4339_API_SET_MONTH, ///< setMonth()
+  PT7C4339_API_GET_DAY, ///< getDay()
+  PT7C4339_API_SET_DAY, ///< setDay()
+  PT7C4339_API_GET_WEEK_DAY, ///< getWeekDay()
+  PT7C4339_API_SET_CORRECT_WEEK_DAY, ///< setCorrectWeekDay()
+  PT7C4339_API_BEGIN_SOFT_CLOCK, ///< beginSoftClock()
+  PT7C4339_API_SERVICE_SOFT_CLOCK, ///< serviceSoftClock()
+  PT7C4339_API_POLL, ///< poll()
+  PT7C4339_API_IS_OSCILLATOR_ENABLED, ///< isOscillatorEnabled()
+  PT7C4339_API_ENABLE_OSCILLATOR, ///< enableOscillator()
+  PT7C4339_API_GET_RTC_STOP_FLAG, ///< getRtcStopFlag()
+  PT7C4339_API_CLEAR_RTC_STOP_FLAG, ///< clearRtcStopFlag()
+  PT7C4339_API_IS_INT_FROM_BATTERY_ENABLED, ///< isIntFromBatteryEnabled()
+  PT7C4339_API_ENABLE_INT_FROM_BATTERY, ///< enableIntFromBattery()
+  PT7C4339_API_GET_INT_OR_SQW_FLAG, ///< getIntOrSqwFlag()
+  PT7C4339_API_SET_INT_OR_SQW_FLAG, ///< setIntOrSqwFlag()
+  PT7C4339_API_GET_SQW_FREQUENCY, ///< getSqwFrequency()
+  PT7C4339_API_SET_SQW_FREQUENCY, ///< setSqwFrequency()
+  PT7C4339_API_GET_TRICKLE_CHARGER_ENABLED, ///< getTrickleChargerEnabled()
+  PT7C4339_API_GET_TRICKLE_CHARGER_DIODE, ///< getTrickleChargerDiode()
+  PT7C4339_API_GET_TRICKLE_CHARGER_RESISTOR, ///< getTrickleChargerResistor()
+  PT7C4339_API_SET_TRICKLE_CHARGER_CONFIG, ///< setTrickleChargerConfig()
+  PT7C4339_API_GET_ALARM1, ///< getAlarm1()
+  PT7C4339_API_SET_ALARM1, ///< setAlarm1()
+  PT7C4339_API_IS_A1_INT_ENABLED, ///< isA1IntEnabled()
+  PT7C4339_API_ENABLE_A1_INT, ///< enableA1Int()
+  PT7C4339_API_GET_A1_FLAG, ///< getA1Flag()
+  PT7C4339_API_CLEAR_A1_FLAG, ///< clearA1Flag()
+  PT7C4339_API_GET_A1_RATE, ///< getA1Rate()
+  PT7C4339_API_SET_A1_RATE, ///< setA1Rate()
+  PT7C4339_API_GET_A1_TIME, ///< getA1Time()
+  PT7C4339_API_SET_A1_TIME, ///< setA1Time()
+  PT7C4339_API_GET_A1_DAY_DATE, ///< getA1DayDate()
+  PT7C4339_API_SET_A1_DAY_DATE, ///< setA1DayDate()
+  PT7C4339_API_GET_ALARM2, ///< getAlarm2()
+  PT7C4339_API_SET_ALARM2, ///< setAlarm2()
+  PT7C4339_API_IS_A2_INT_ENABLED, ///< isA2IntEnabled()
+  PT7C4339_API_ENABLE_A2_INT, ///< enableA2Int()
+  PT7C4339_API_GET_A2_FLAG, ///< getA2Flag()
+  PT7C4339_API_CLEAR_A2_FLAG, ///< clearA2Flag()
+  PT7C4339_API_GET_A2_RATE, ///< getA2Rate()
+  PT7C4339_API_SET_A2_RATE, ///< setA2Rate()
+  PT7C4339_API_GET_A2_TIME, ///< getA2Time()
+  PT7C4339_API_SET_A2_TIME, ///< setA2Time()
+  PT7C4339_API_GET_A2_DAY_DATE, ///< getA2DayDate()
+  PT7C4339_API_SET_A2_DAY_DATE, ///< setA2DayDate()
+  PT7C4339_API_SET_ALARM_REGISTERS, ///< setAlarmRegisters()
+  PT7C4339_API_SERVICE, ///< service()
+  PT7C4339_API_COUNT ///< Number of instrumented methods
+};
+
+typedef void ( *PT7C4339_alarmCallback )(); ///< Function called by service() when an alarm matched
+
+/**
+ * @struct PT7C4339_Timestamp
+ * Date and time with sub-second resolution, returned by the software clock
+ */
+typedef struct
+{
+  PT7C4339_DateTime dateTime; ///< Date and time of the current second
+  uint32_t microsecond; ///< Microseconds elapsed in the current second (0-999999)
+} PT7C4339_Timestamp; ///< Date and time with sub-second resolution, returned by the software clock
+
+/**
+ * @struct PT7C4339_ApiStats
+ * Bus statistics of one public method of the PT7C4339 library, collected if PT7C4339_ENABLE_STATS is defined
+ */
+typedef struct
+{
+  uint32_t calls; ///< Number of calls
+  uint32_t transactions; ///< Number of I2C transactions (register pointer writes, data writes and reads)
+  uint32_t bytes; ///< Number of bytes on the wire, including the address bytes
+  uint16_t nacks; ///< Number of transactions that were not acknowledged or returned fewer bytes than requested
+  uint16_t verifyMismatches; ///< Number of write verifications that read back different data
+  uint16_t latencyHistogram[PT7C4339_STATS_BUCKETS]; ///< Call durations, bucket n counts calls shorter than 64us << n
+} PT7C4339_ApiStats; ///< Bus statistics of one public method of the PT7C4339 library
+
+/**
+ * @struct PT7C4339_Alarm1Config
+ * Complete configuration of alarm 1, held in registers 0x07-0x0A
+ */
+typedef struct
+{
+  PT7C4339_A1_rate rate; ///< Match rate, also selects matching by day of the month or day of the week
+  PT7C4339_Time time; ///< Match time (hour, minute, second)
+  PT7C4339_Date dayDate; ///< Match day of the month in 'day', or day of the week in 'weekDay', as selected by the rate. Year and month are not used
+} PT7C4339_Alarm1Config; ///< Complete configuration of alarm 1
+
 /**
- * @struct PT7C4339_Time
- * Time structure for the PT7C4339 RTC
+ * @struct PT7C4339_Alarm2Config
+ * Complete configuration of alarm 2, held in registers 0x0B-0x0D
  */
 typedef struct
 {
-  uint8_t hour; ///< Hours (0-23)
-  uint8_t minute; ///< Minutes (0-59)
-  uint8_t second; ///< Seconds (0-59)
-} PT7C4339_Time; ///< Time structure for the PT7C4339 RTC
+  PT7C4339_A2_rate rate; ///< Match rate, also selects matching by day of the month or day of the week
+  PT7C4339_Time time; ///< Match time (hour, minute), seconds are not used
+  PT7C4339_Date dayDate; ///< Match day of the month in 'day', or day of the week in 'weekDay', as selected by the rate. Year and month are not used
+} PT7C4339_Alarm2Config; ///< Complete configuration of alarm 2
 
 /**
- * @struct PT7C4339_Date
- * Date structure for the PT7C4339 RTC
+ * @struct PT7C4339_Config
+ * Image of the configuration registers 0x07-0x10 (alarms, control, trickle charger), saved by saveConfig()
  */
 typedef struct
 {
-  uint16_t year; ///< Year (1900-2099)
-  uint8_t month; ///< Month (1-12)
-  uint8_t day; ///< Day (1-31)
-  PT7C4339_daysOfWeek weekDay; ///< Day of the week (1-7, where 1 = Monday and 7 = Sunday)
-} PT7C4339_Date; ///< Date structure for the PT7C4339 RTC
+  uint8_t registers[PT7C4339_CONFIG_SIZE]; ///< Raw values of registers 0x07-0x10, the status register (0x0F) is stored as 0
+  uint8_t checksum; ///< PT7C4339_CONFIG_CHECKSUM_SEED XOR every register byte, checked by applyConfig()
+} PT7C4339_Config; ///< Image of the configuration registers, 11 bytes of plain data that can be stored in EEPROM or flash as is
 
-class PT7C4339 ///< Class for the PT7C4339 RTC
+/**
+ * @struct PT7C4339_ResumeState
+ * State of a PT7C4339 object saved by getResumeState(), kept in RAM retained across deep sleep and restored by resume()
+ */
+typedef struct
+{
+  PT7C4339_Config cache; ///< Register cache (0x07-0x10) at the time the state was saved, with its checksum
+  uint8_t flags; ///< PT7C4339_RESUME_MAGIC, ORed with PT7C4339_RESUME_CACHE_VALID if the cache was valid
+} PT7C4339_ResumeState; ///< State of a PT7C4339 object, 12 bytes of plain data kept across deep sleep
+
+class PT7C4339_Mux;
+
+/*
+ * The PT7C4339T class template reaches the RTC through a bus policy class, called with static dispatch so
+ * the transport can be inlined into every method. A bus policy provides:
+ * - void begin(): initializes the bus, called by begin() if the RTC did not answer,
+ * - bool probe(): true if the RTC acknowledges its address,
+ * - PT7C4339_status read( uint8_t REG, uint8_t *DATA, uint8_t length ): sets the register pointer to REG and reads length registers,
+ * - PT7C4339_status write( uint8_t REG, const uint8_t *DATA, uint8_t length ): writes length registers from REG, with auto-increment,
+ * - bool recover(): frees a stuck bus and initializes it again, true if the bus is idle afterwards,
+ * - uint32_t timeMicros(), void sleepMillis( uint32_t ms ): the time base of the software clock, the statistics
+ *   and the non-blocking reset, and the blocking delay of reset(),
+ * - void enterCritical(), void exitCritical(): around the reads of the state shared with handleSqwEdge(),
+ * - setMux(), getMux(), getMuxChannel(): only if the multiplexer methods of the RTC are used.
+ * read() and write() return PT7C4339_STATUS_OK if every byte was acknowledged, and split the transfer if their transport needs it.
+ * Every transaction must give up after a bounded time (PT7C4339_BUS_TIMEOUT_US by default) and return PT7C4339_STATUS_TIMEOUT.
+ * PT7C4339_ArduinoTiming (micros(), delay(), noInterrupts()) and PT7C4339_PosixTiming can be inherited for the timing part.
+ * PT7C4339 is the class for the Arduino TwoWire interface (PT7C4339_WireBus). To use another bus policy,
+ * include PT7C4339-RTC-impl.h and construct a PT7C4339T<Policy> with the arguments of the constructor of the policy.
+ * Builds without the Arduino core (e.g. PT7C4339-LinuxBus.h) define PT7C4339_NO_WIRE, which leaves out PT7C4339 and the Wire bus policy.
+ */
+template<class Bus>
+class PT7C4339T ///< Class template for the PT7C4339 RTC, accessed through the bus policy Bus
 {
   public:
     /* Setup */
-    PT7C4339( TwoWire *i2cWire = &Wire, uint8_t SDA = 0, uint8_t SCL = 0, uint32_t frequency = 400000 );
-    
+    /**
+     * @brief Constructs a PT7C4339 RTC object, passing the arguments to the constructor of the bus policy.
+     *
+     * With the Wire bus policy (PT7C4339), the arguments are the ones of PT7C4339_WireBus:
+     * the TwoWire instance (default is Wire), the SDA and SCL pins (default is 0, the default pins of your board)
+     * and the I2C clock frequency (default is 400000 Hz).
+     *
+     * @param args The arguments of the constructor of the bus policy.
+     */
+    template<typename... Args>
+    explicit PT7C4339T( Args... args ) : _bus( args... )
+    {
+      init();
+    }
+
+    Bus &getBus();
+
     uint8_t begin();
     bool reset();
 
+    PT7C4339_ResumeState getResumeState();
+    uint8_t resume( PT7C4339_ResumeState state );
+
+    bool isRegisterCacheEnabled();
+    bool enableRegisterCache( bool enable );
+    bool refreshRegisterCache();
+
+    PT7C4339_verifyPolicy getVerifyPolicy();
+    void setVerifyPolicy( PT7C4339_verifyPolicy policy );
+    bool verifyPendingWrites( uint8_t *mismatchRegister = nullptr );
+
+    void beginUpdate();
+    bool commit();
+    void cancelUpdate();
+
+    PT7C4339_Config saveConfig();
+    bool applyConfig( PT7C4339_Config config );
+
+    /* Fault handling */
+    PT7C4339_status getLastStatus();
+    uint8_t getRetryBudget();
+    void setRetryBudget( uint8_t retries );
+    bool recoverBus();
+
+#ifdef PT7C4339_ENABLE_STATS
+    /* Statistics */
+    PT7C4339_ApiStats getApiStats( PT7C4339_apiMethod method );
+    void resetStats();
+    bool trackApiStats( PT7C4339_apiMethod method );
+    uint32_t getUntrackedCalls();
+#endif
+
+    /* Multiplexer */
+    bool setMux( PT7C4339_Mux *mux, uint8_t channel );
+    PT7C4339_Mux *getMux();
+    uint8_t getMuxChannel();
+    static uint8_t readDateTimes( PT7C4339T *const *devices, uint8_t count, PT7C4339_DateTime *dateTimes );
+
     /* Date, time */
+    PT7C4339_DateTime getDateTime();
+    bool setDateTime( PT7C4339_DateTime dateTime );
+
+    uint32_t getEpoch();
+    bool setEpoch( uint32_t epoch );
+
     PT7C4339_Time getTime();
     bool setTime( PT7C4339_Time time );
     
@@ -163,6 +441,22 @@ class PT7C4339 ///< Class for the PT7C4339 RTC
     bool setCorrectWeekDay(); // Should not be needed as it gets called by every date setter, but leaving it public just in case
     PT7C4339_daysOfWeek calculateWeekDay( uint16_t year, uint8_t month, uint8_t day );
 
+    /* Software clock */
+    bool beginSoftClock( uint16_t resyncInterval = PT7C4339_SOFT_CLOCK_DEFAULT_RESYNC );
+    void endSoftClock();
+    void handleSqwEdge();
+    bool serviceSoftClock();
+    bool isSoftClockSynced();
+    PT7C4339_Timestamp now();
+
+    /* Non-blocking operations */
+    bool startReadDateTime();
+    bool startSetAlarm1( PT7C4339_Alarm1Config config );
+    bool startReset();
+    PT7C4339_asyncStatus poll();
+    PT7C4339_asyncOperation getAsyncOperation();
+    PT7C4339_DateTime getAsyncDateTime();
+
     /* Control */
     bool isOscillatorEnabled();
     bool enableOscillator( bool enable );
@@ -185,6 +479,9 @@ class PT7C4339 ///< Class for the PT7C4339 RTC
     bool setTrickleChargerConfig( PT7C4339_trickleChargerEnabled enable, PT7C4339_trickleChargerDiode diode, PT7C4339_trickleChargerResistor resistor );
 
     /* Alarms */
+    PT7C4339_Alarm1Config getAlarm1();
+    bool setAlarm1( PT7C4339_Alarm1Config config );
+
     bool isA1IntEnabled();
     bool enableA1Int( bool enable );
 
@@ -200,6 +497,9 @@ class PT7C4339 ///< Class for the PT7C4339 RTC
     PT7C4339_Date getA1DayDate();
     bool setA1DayDate( PT7C4339_Date date );
 
+    PT7C4339_Alarm2Config getAlarm2();
+    bool setAlarm2( PT7C4339_Alarm2Config config );
+
     bool isA2IntEnabled();
     bool enableA2Int( bool enable );
 
@@ -215,22 +515,123 @@ class PT7C4339 ///< Class for the PT7C4339 RTC
     PT7C4339_Date getA2DayDate();
     bool setA2DayDate( PT7C4339_Date date );
 
-  private:
+    bool setAlarmRegisters( uint8_t REG, const uint8_t *DATA, uint8_t length );
+
+    /* Alarm events */
+    void onAlarm1( PT7C4339_alarmCallback callback );
+    void onAlarm2( PT7C4339_alarmCallback callback );
+    void notifyInterrupt();
+    uint8_t service();
 
-    uint8_t _i2cAddress;
-    uint8_t _SDA;
-    uint8_t _SCL;
-    TwoWire *_i2cWire;
-    uint32_t _frequency;
+  private:
+    static const uint8_t resetImage[PT7C4339_REGISTER_COUNT];
+
+    Bus _bus;
+
+    PT7C4339_status _lastStatus;
+    uint8_t _retryBudget;
+
+    uint8_t _cache[PT7C4339_CACHE_SIZE];
+    bool _cacheEnabled;
+    bool _cacheValid;
+
+    uint8_t _image[PT7C4339_REGISTER_COUNT]; ///< Staged values, values pending verification and data of the non-blocking operation, by register
+
+    PT7C4339_verifyPolicy _verifyPolicy;
+    uint32_t _pendingVerifyMask;
+
+    bool _updateActive;
+    uint32_t _stagedMask;
+
+    bool _softClockEnabled;
+    bool _softClockSynced;
+    uint16_t _softResyncInterval;
+    volatile uint32_t _sqwEdges;
+    volatile uint32_t _sqwLatch;
+    PT7C4339_DateTime _softNow;
+    uint32_t _softNowEdges;
+    uint32_t _softSyncEdges;
+
+    PT7C4339_asyncOperation _asyncOperation;
+    PT7C4339_asyncStatus _asyncStatus;
+    uint8_t _asyncStep;
+    uint8_t _asyncOffset;
+    uint32_t _asyncWaitStart;
+    PT7C4339_DateTime _asyncDateTime;
+
+    PT7C4339_alarmCallback _onAlarm1;
+    PT7C4339_alarmCallback _onAlarm2;
+    volatile bool _interruptPending;
+
+#ifdef PT7C4339_ENABLE_STATS
+    class StatsScope ///< Attributes the bus traffic of a public method call to it for its lifetime
+    {
+      public:
+        StatsScope( PT7C4339T *rtc, PT7C4339_apiMethod method );
+        ~StatsScope();
+
+      private:
+        PT7C4339T *_rtc;
+        bool _owner;
+        uint32_t _start;
+    };
+
+    PT7C4339_ApiStats _stats[PT7C4339_STATS_SLOTS];
+    uint8_t _statsSlotMethods[PT7C4339_STATS_SLOTS];
+    PT7C4339_apiMethod _statsMethod;
+    PT7C4339_ApiStats *_statsActive;
+    uint32_t _statsUntrackedCalls;
+
+    PT7C4339_ApiStats *statsSlot( PT7C4339_apiMethod method, bool claim );
+    void countTransaction( uint8_t bytes, bool nack );
+    void countVerifyMismatch();
+#endif
+
+    void init();
 
     uint8_t bcdToDec( uint8_t bcd );
     uint8_t decToBcd( uint8_t dec );
+    bool checkBcd( uint8_t bcd, uint8_t min, uint8_t max );
     
     uint8_t readRegister( uint8_t REG );
+    bool readRegisters( uint8_t REG, uint8_t *DATA, uint8_t length );
     bool writeRegister( uint8_t REG, uint8_t DATA );
+    bool writeRegisters( uint8_t REG, const uint8_t *DATA, uint8_t length );
+
+    bool readBus( uint8_t REG, uint8_t *DATA, uint8_t length );
+    bool writeBus( uint8_t REG, const uint8_t *DATA, uint8_t length );
+
+    bool isCached( uint8_t REG );
+    bool isStaged( uint8_t REG );
+    void updateCache( uint8_t REG, const uint8_t *DATA, uint8_t length );
+    bool deferVerify( uint8_t REG, const uint8_t *DATA, uint8_t length );
+
+    bool readConfigImage( uint8_t *image );
+    static uint8_t configChecksum( const uint8_t *registers );
+
+    bool startAsync( PT7C4339_asyncOperation operation );
+    PT7C4339_asyncStatus asyncTransfer( bool read, uint8_t REG, uint8_t length, bool verify );
+    PT7C4339_asyncStatus asyncWriteVerified( uint8_t REG, uint8_t length, uint8_t writeStep );
+
+    bool writeDate( uint16_t year, uint8_t month, uint8_t day );
+    PT7C4339_DateTime decodeDateTime( const uint8_t *buf );
+    bool decodeTime( const uint8_t *buf, PT7C4339_Time *time );
+    bool decodeDate( const uint8_t *buf, PT7C4339_Date *date );
+    bool encodeAlarm1( PT7C4339_Alarm1Config config, uint8_t *buf );
+    PT7C4339_Date decodeAlarmDayDate( uint8_t value );
+    bool encodeAlarmDayDate( PT7C4339_Date dayDate, bool byWeekDay, bool matched, uint8_t *value );
 
     bool readBit( uint8_t REG, uint8_t BIT );
     bool writeBit( uint8_t REG, uint8_t BIT, bool value );
+    bool clearStatusFlags( uint8_t flags );
 };
 
+#ifndef PT7C4339_NO_WIRE
+#include "PT7C4339-WireBus.h"
+
+typedef PT7C4339T<PT7C4339_WireBus> PT7C4339; ///< Class for the PT7C4339 RTC on the Arduino TwoWire interface
+
+extern template class PT7C4339T<PT7C4339_WireBus>;
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,462 @@
+/**
+ * @file PT7C4339-WireBus.cpp
+ * @brief Implementation of the TwoWire bus policy and the I2C multiplexer of the PT7C4339-RTC library.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#include "PT7C4339-RTC.h"
+
+#ifndef PT7C4339_NO_WIRE
+
+PT7C4339_Mux *PT7C4339_Mux::_first = nullptr;
+
+/**
+ * @brief Constructs a TCA9548A-compatible I2C multiplexer object.
+ *
+ * The channel selected on the device is unknown until the first select(), which always writes the control register.
+ * Every multiplexer object is kept in a list, so selecting a channel on one of them can first disconnect
+ * the channels of the others on the same bus: the PT7C4339 RTCs behind them all answer at the same address.
+ *
+ * @param i2cWire Pointer to the TwoWire instance the multiplexer is connected to.
+ * @param address The 7bit I2C address of the multiplexer (default is 0x70).
+ */
+PT7C4339_Mux::PT7C4339_Mux( TwoWire *i2cWire, uint8_t address )
+{
+  _i2cWire = i2cWire;
+  _address = address;
+  _channel = PT7C4339_MUX_NO_CHANNEL;
+  _known = false;
+  _writeCount = 0;
+
+  _next = _first;
+  _first = this;
+}
+
+/**
+ * @brief Removes the multiplexer from the list of multiplexers.
+ */
+PT7C4339_Mux::~PT7C4339_Mux()
+{
+  PT7C4339_Mux **link = &_first;
+
+  while( *link != nullptr )
+  {
+    if( *link == this )
+    {
+      *link = _next;
+      return;
+    }
+    link = &( *link )->_next;
+  }
+}
+
+/**
+ * @brief Connects one downstream channel of the multiplexer to the bus.
+ *
+ * Nothing is written if the channel is already selected. Otherwise the channels of every other multiplexer
+ * on the same bus that may still be connected are disconnected first, then the control register is written.
+ *
+ * @param channel The channel to connect (0-7), or PT7C4339_MUX_NO_CHANNEL to disconnect every channel.
+ * @return bool True if the channel is selected, false if the channel is invalid or a write was not acknowledged.
+ */
+bool PT7C4339_Mux::select( uint8_t channel )
+{
+  if( channel >= PT7C4339_MUX_CHANNELS && channel != PT7C4339_MUX_NO_CHANNEL ) return false;
+  if( _known && _channel == channel ) return true;
+
+  if( channel != PT7C4339_MUX_NO_CHANNEL )
+  {
+    for( PT7C4339_Mux *mux = _first; mux != nullptr; mux = mux->_next )
+    {
+      if( mux == this || mux->_i2cWire != _i2cWire ) continue;
+      if( mux->_known && mux->_channel == PT7C4339_MUX_NO_CHANNEL ) continue;
+
+      _writeCount++;
+      if( !mux->writeChannel( PT7C4339_MUX_NO_CHANNEL ) ) return false;
+    }
+  }
+
+  _writeCount++;
+  return writeChannel( channel );
+}
+
+/**
+ * @brief Gets the channel last selected with select().
+ *
+ * @return uint8_t The selected channel (0-7), or PT7C4339_MUX_NO_CHANNEL if none is connected or the state of the device is unknown.
+ */
+uint8_t PT7C4339_Mux::getChannel()
+{
+  return _known ? _channel : PT7C4339_MUX_NO_CHANNEL;
+}
+
+/**
+ * @brief Forgets the selected channel, so the next select() writes the control register.
+ *
+ * Call it after talking to the multiplexer without this object, or after it may have been reset.
+ */
+void PT7C4339_Mux::invalidate()
+{
+  _known = false;
+}
+
+/**
+ * @brief Gets the number of control register writes sent by select().
+ *
+ * @return uint32_t The number of writes, including the ones that disconnected the channels of other multiplexers.
+ */
+uint32_t PT7C4339_Mux::getWriteCount()
+{
+  return _writeCount;
+}
+
+/**
+ * @brief Writes the control register of the multiplexer.
+ *
+ * @param channel The channel to connect (0-7), or PT7C4339_MUX_NO_CHANNEL to disconnect every channel.
+ * @return bool True if the write was acknowledged, false otherwise, which leaves the state of the device unknown.
+ */
+bool PT7C4339_Mux::writeChannel( uint8_t channel )
+{
+  _i2cWire->beginTransmission( _address );
+  _i2cWire->write( channel == PT7C4339_MUX_NO_CHANNEL ? 0x00 : ( 1 << channel ) );
+  _known = _i2cWire->endTransmission() == 0;
+  _channel = channel;
+
+  return _known;
+}
+
+/**
+ * @brief Constructs the bus policy with specified I2C parameters.
+ *
+ * @param i2cWire Pointer to the TwoWire instance to use for I2C communication.
+ * @param SDA The pin number used for the I2C SDA line. Default is 0, where begin() will use the default SDA pin of your board.
+ * @param SCL The pin number used for the I2C SCL line. Default is 0, where begin() will use the default SCL pin of your board.
+ * @param frequency The I2C clock frequency (default is 400000 Hz).
+ */
+PT7C4339_WireBus::PT7C4339_WireBus( TwoWire *i2cWire, uint8_t SDA, uint8_t SCL, uint32_t frequency )
+{
+  _i2cAddress = PT7C4339_I2C_ADDRESS;
+  _i2cWire = i2cWire;
+  _SDA = SDA;
+  _SCL = SCL;
+  _frequency = frequency;
+  _timeoutUs = PT7C4339_BUS_TIMEOUT_US;
+
+  _mux = nullptr;
+  _muxChannel = PT7C4339_MUX_NO_CHANNEL;
+}
+
+/**
+ * @brief Initializes the I2C bus with the default or the custom SDA/SCL pins, the specified frequency and the transaction timeout.
+ *
+ * The channel selected on the multiplexer is forgotten, as it may have been reset with the bus.
+ */
+void PT7C4339_WireBus::begin()
+{
+  if( _SDA == 0 && _SCL == 0 )
+  {
+    _i2cWire->begin();
+    _i2cWire->setClock( _frequency );
+  }
+  else
+  {
+    _i2cWire->begin( _SDA, _SCL );
+    _i2cWire->setClock( _frequency );
+  }
+
+#if defined( WIRE_HAS_TIMEOUT )
+  _i2cWire->setWireTimeout( _timeoutUs, true );
+#endif
+
+  invalidateMux();
+}
+
+/**
+ * @brief Checks if the RTC acknowledges its address, with an empty write transaction.
+ *
+ * @return bool True if the address was acknowledged, false otherwise.
+ */
+bool PT7C4339_WireBus::probe()
+{
+  if( !selectMuxChannel() ) return false;
+
+  _i2cWire->beginTransmission( _i2cAddress );
+  return _i2cWire->endTransmission() == 0;
+}
+
+/**
+ * @brief Reads consecutive registers of the PT7C4339 RTC with auto-increment.
+ *
+ * This function sets the register pointer to REG, then requests length bytes in one go.
+ * Reads longer than the TwoWire buffer are split into PT7C4339_I2C_BUFFER_SIZE byte chunks.
+ *
+ * @param REG The address of the first register to read.
+ * @param DATA Buffer of at least length bytes that receives the register values.
+ * @param length The number of registers to read.
+ * @return PT7C4339_status PT7C4339_STATUS_OK if every requested byte was received, otherwise the reason of the failure.
+ */
+PT7C4339_status PT7C4339_WireBus::read( uint8_t REG, uint8_t *DATA, uint8_t length )
+{
+  clearTimeoutFlag();
+  if( !selectMuxChannel() ) return failureStatus( 2 );
+
+  _i2cWire->beginTransmission( _i2cAddress );
+  _i2cWire->write( REG );
+  uint8_t error = _i2cWire->endTransmission();
+  if( error != 0 )
+  {
+    invalidateMux();
+    return failureStatus( error );
+  }
+
+  uint8_t offset = 0;
+  while( offset < length )
+  {
+    uint8_t chunk = length - offset;
+    if( chunk > PT7C4339_I2C_BUFFER_SIZE ) chunk = PT7C4339_I2C_BUFFER_SIZE;
+
+    uint8_t received = _i2cWire->requestFrom( _i2cAddress, chunk );
+    if( received != chunk )
+    {
+      invalidateMux();
+      if( timedOut() ) return PT7C4339_STATUS_TIMEOUT;
+      return ( received == 0 ) ? PT7C4339_STATUS_NACK : PT7C4339_STATUS_SHORT_READ;
+    }
+
+    for( uint8_t i = 0; i < chunk; i++ )
+    {
+      DATA[offset + i] = _i2cWire->read();
+    }
+
+    offset += chunk;
+  }
+
+  return PT7C4339_STATUS_OK;
+}
+
+/**
+ * @brief Writes consecutive registers of the PT7C4339 RTC with auto-increment.
+ *
+ * This function sends the register address followed by the data bytes. Writes that do not fit in the TwoWire
+ * buffer are split into chunks of PT7C4339_I2C_BUFFER_SIZE - 1 data bytes.
+ *
+ * @param REG The address of the first register to write.
+ * @param DATA The data bytes to write.
+ * @param length The number of registers to write.
+ * @return PT7C4339_status PT7C4339_STATUS_OK if every chunk was acknowledged, otherwise the reason of the failure.
+ */
+PT7C4339_status PT7C4339_WireBus::write( uint8_t REG, const uint8_t *DATA, uint8_t length )
+{
+  clearTimeoutFlag();
+  if( !selectMuxChannel() ) return failureStatus( 2 );
+
+  uint8_t offset = 0;
+  while( offset < length )
+  {
+    uint8_t chunk = length - offset;
+    if( chunk > PT7C4339_I2C_BUFFER_SIZE - 1 ) chunk = PT7C4339_I2C_BUFFER_SIZE - 1;
+
+    _i2cWire->beginTransmission( _i2cAddress );
+    _i2cWire->write( REG + offset );
+    for( uint8_t i = 0; i < chunk; i++ )
+    {
+      _i2cWire->write( DATA[offset + i] );
+    }
+    uint8_t error = _i2cWire->endTransmission();
+    if( error != 0 )
+    {
+      invalidateMux();
+      return failureStatus( error );
+    }
+
+    offset += chunk;
+  }
+
+  return PT7C4339_STATUS_OK;
+}
+
+/**
+ * @brief Frees a bus held by a slave and initializes it again.
+ *
+ * A slave reset or interrupted in the middle of a read can hold SDA low, waiting for the clocks of the byte it was sending.
+ * The TwoWire interface is ended, then SCL is pulsed as an open-drain line, up to PT7C4339_BUS_CLEAR_CLOCKS times
+ * until the slave releases SDA. A STOP condition resets the state machine of every slave, and the bus is initialized
+ * again like by begin(). The custom pins are used if they were given, otherwise the SDA and SCL pins of the board,
+ * but only for the default Wire instance: the board pins belong to it, so clocking them for another TwoWire
+ * (e.g. Wire1) would disturb an unrelated bus. Without custom pins, any other TwoWire is only ended and initialized
+ * again, and a slave holding SDA low can only be freed by giving the pins to the constructor.
+ * It takes about 100us plus the initialization of the bus.
+ *
+ * @return bool True if both lines are high after the recovery, false if a slave still holds one of them low.
+ *         Always true if the lines were not driven, as their state is not known.
+ */
+bool PT7C4339_WireBus::recover()
+{
+  uint8_t sda = _SDA;
+  uint8_t scl = _SCL;
+
+  _i2cWire->end();
+
+  if( sda == 0 && scl == 0 )
+  {
+    if( _i2cWire != &Wire )
+    {
+      begin();
+      return true;
+    }
+
+    sda = SDA;
+    scl = SCL;
+  }
+
+  pinMode( sda, INPUT_PULLUP );
+  pinMode( scl, INPUT_PULLUP );
+  delayMicroseconds( PT7C4339_BUS_CLEAR_HALF_PERIOD_US );
+
+  for( uint8_t i = 0; i < PT7C4339_BUS_CLEAR_CLOCKS && digitalRead( sda ) == LOW; i++ )
+  {
+    digitalWrite( scl, LOW );
+    pinMode( scl, OUTPUT );
+    delayMicroseconds( PT7C4339_BUS_CLEAR_HALF_PERIOD_US );
+    pinMode( scl, INPUT_PULLUP );
+    delayMicroseconds( PT7C4339_BUS_CLEAR_HALF_PERIOD_US );
+  }
+
+  digitalWrite( sda, LOW ); // STOP: SDA rises while SCL is high
+  pinMode( sda, OUTPUT );
+  delayMicroseconds( PT7C4339_BUS_CLEAR_HALF_PERIOD_US );
+  pinMode( sda, INPUT_PULLUP );
+  delayMicroseconds( PT7C4339_BUS_CLEAR_HALF_PERIOD_US );
+
+  bool idle = digitalRead( sda ) == HIGH && digitalRead( scl ) == HIGH;
+
+  begin();
+
+  return idle;
+}
+
+/**
+ * @brief Gets the time limit of one I2C transaction.
+ *
+ * @return uint32_t The timeout in microseconds, PT7C4339_BUS_TIMEOUT_US by default.
+ */
+uint32_t PT7C4339_WireBus::getTimeout()
+{
+  return _timeoutUs;
+}
+
+/**
+ * @brief Sets the time limit of one I2C transaction, after which it is aborted and reported as PT7C4339_STATUS_TIMEOUT.
+ *
+ * Applied with setWireTimeout() on the cores that have it (WIRE_HAS_TIMEOUT, e.g. AVR and megaAVR), which also
+ * resets the TWI hardware on a timeout. Other cores keep the timeout built into their Wire library.
+ *
+ * @param timeoutUs The timeout in microseconds, 0 waits forever on a stuck bus.
+ */
+void PT7C4339_WireBus::setTimeout( uint32_t timeoutUs )
+{
+  _timeoutUs = timeoutUs;
+
+#if defined( WIRE_HAS_TIMEOUT )
+  _i2cWire->setWireTimeout( _timeoutUs, true );
+#endif
+}
+
+/**
+ * @brief Places the RTC behind a channel of an I2C multiplexer.
+ *
+ * @param mux The multiplexer the RTC is connected to, or nullptr if it is connected to the bus directly.
+ * @param channel The channel of the multiplexer (0-7), ignored if mux is nullptr.
+ * @return bool True if the setting was accepted, false if the channel is invalid.
+ */
+bool PT7C4339_WireBus::setMux( PT7C4339_Mux *mux, uint8_t channel )
+{
+  if( mux != nullptr && channel >= PT7C4339_MUX_CHANNELS ) return false;
+
+  _mux = mux;
+  _muxChannel = ( mux != nullptr ) ? channel : PT7C4339_MUX_NO_CHANNEL;
+
+  return true;
+}
+
+/**
+ * @brief Gets the multiplexer the RTC is connected to.
+ *
+ * @return PT7C4339_Mux* The multiplexer set with setMux(), or nullptr if the RTC is connected to the bus directly.
+ */
+PT7C4339_Mux *PT7C4339_WireBus::getMux()
+{
+  return _mux;
+}
+
+/**
+ * @brief Gets the multiplexer channel the RTC is connected to.
+ *
+ * @return uint8_t The channel set with setMux() (0-7), or PT7C4339_MUX_NO_CHANNEL if the RTC is connected to the bus directly.
+ */
+uint8_t PT7C4339_WireBus::getMuxChannel()
+{
+  return _muxChannel;
+}
+
+/**
+ * @brief Selects the multiplexer channel of the RTC, if it is behind a multiplexer.
+ *
+ * @return bool True if the RTC is connected to the bus directly or its channel is selected, false otherwise.
+ */
+bool PT7C4339_WireBus::selectMuxChannel()
+{
+  return _mux == nullptr || _mux->select( _muxChannel );
+}
+
+/**
+ * @brief Makes the next access select the multiplexer channel again, after a transaction that was not acknowledged.
+ */
+void PT7C4339_WireBus::invalidateMux()
+{
+  if( _mux != nullptr ) _mux->invalidate();
+}
+
+/**
+ * @brief Clears the timeout flag of the TwoWire interface, before a transfer.
+ */
+void PT7C4339_WireBus::clearTimeoutFlag()
+{
+#if defined( WIRE_HAS_TIMEOUT )
+  _i2cWire->clearWireTimeoutFlag();
+#endif
+}
+
+/**
+ * @brief Checks if a transaction of the current transfer timed out.
+ *
+ * @return bool True if the TwoWire interface reported a timeout, always false on cores without WIRE_HAS_TIMEOUT.
+ */
+bool PT7C4339_WireBus::timedOut()
+{
+#if defined( WIRE_HAS_TIMEOUT )
+  return _i2cWire->getWireTimeoutFlag();
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Converts a failed endTransmission() result to a status.
+ *
+ * @param error The result of endTransmission(): 1 buffer overflow, 2 address NACK, 3 data NACK, 4 other error, 5 timeout.
+ * @return PT7C4339_status The status of the failed transfer.
+ */
+PT7C4339_status PT7C4339_WireBus::failureStatus( uint8_t error )
+{
+  if( error == 5 || timedOut() ) return PT7C4339_STATUS_TIMEOUT;
+  if( error == 2 || error == 3 ) return PT7C4339_STATUS_NACK;
+
+  return PT7C4339_STATUS_BUS_ERROR;
+}
+
+#endif
@@ -0,0 +1,132 @@
+/**
+ * @file PT7C4339-WireBus.h
+ * @brief Bus policy of the PT7C4339-RTC library for the Arduino TwoWire interface, with I2C multiplexer support.
+ *
+ * Included by PT7C4339-RTC.h, PT7C4339 is the PT7C4339T class template instantiated with PT7C4339_WireBus.
+ *
+ * @author      Bence Murin
+ * @copyright   MIT License
+ *
+**/
+
+#ifndef _PT7C4339_WIRE_BUS_H_
+#define _PT7C4339_WIRE_BUS_H_
+
+#include <Wire.h>
+
+#define PT7C4339_MUX_ADDRESS          0x70 ///< Default 7bit I2C address of a TCA9548A multiplexer (A2-A0 low), 0x70-0x77 are possible
+#define PT7C4339_MUX_CHANNELS         8 ///< Number of downstream channels of a TCA9548A multiplexer
+#define PT7C4339_MUX_NO_CHANNEL       0xFF ///< Channel number that disconnects every downstream channel, also used when an RTC is not behind a multiplexer
+
+#define PT7C4339_BUS_CLEAR_HALF_PERIOD_US  5 ///< Half period of the SCL pulses sent by recover(), 100kHz like a standard mode bus
+
+#ifndef PT7C4339_I2C_BUFFER_SIZE
+  #if defined( BUFFER_LENGTH )
+    #define PT7C4339_I2C_BUFFER_SIZE  BUFFER_LENGTH ///< Size of the TwoWire buffers, bursts are split to fit in it
+  #elif defined( I2C_BUFFER_LENGTH )
+    #define PT7C4339_I2C_BUFFER_SIZE  I2C_BUFFER_LENGTH ///< Size of the TwoWire buffers, bursts are split to fit in it
+  #else
+    #define PT7C4339_I2C_BUFFER_SIZE  32 ///< Size of the TwoWire buffers, bursts are split to fit in it
+  #endif
+#endif
+
+class PT7C4339_ArduinoTiming ///< Timing and critical sections of a bus policy from the Arduino core
+{
+  public:
+    /**
+     * @brief Returns the microseconds elapsed since the start of the program, with micros().
+     */
+    uint32_t timeMicros()
+    {
+      return micros();
+    }
+
+    /**
+     * @brief Waits for the given number of milliseconds, with delay().
+     */
+    void sleepMillis( uint32_t ms )
+    {
+      delay( ms );
+    }
+
+    /**
+     * @brief Disables interrupts, so the state shared with handleSqwEdge() can be read consistently.
+     */
+    void enterCritical()
+    {
+      noInterrupts();
+    }
+
+    /**
+     * @brief Enables interrupts again.
+     */
+    void exitCritical()
+    {
+      interrupts();
+    }
+};
+
+class PT7C4339_Mux ///< TCA9548A-compatible I2C multiplexer, shared by every PT7C4339 object behind it
+{
+  public:
+    PT7C4339_Mux( TwoWire *i2cWire = &Wire, uint8_t address = PT7C4339_MUX_ADDRESS );
+    PT7C4339_Mux( const PT7C4339_Mux & ) = delete;
+    PT7C4339_Mux &operator=( const PT7C4339_Mux & ) = delete;
+    ~PT7C4339_Mux();
+
+    bool select( uint8_t channel );
+    uint8_t getChannel();
+    void invalidate();
+    uint32_t getWriteCount();
+
+  private:
+    TwoWire *_i2cWire;
+    uint8_t _address;
+    uint8_t _channel;
+    bool _known;
+    uint32_t _writeCount;
+    PT7C4339_Mux *_next;
+
+    static PT7C4339_Mux *_first;
+
+    bool writeChannel( uint8_t channel );
+};
+
+class PT7C4339_WireBus : public PT7C4339_ArduinoTiming ///< Bus policy for the Arduino TwoWire interface, optionally behind a channel of an I2C multiplexer
+{
+  public:
+    PT7C4339_WireBus( TwoWire *i2cWire = &Wire, uint8_t SDA = 0, uint8_t SCL = 0, uint32_t frequency = 400000 );
+
+    void begin();
+    bool probe();
+    PT7C4339_status read( uint8_t REG, uint8_t *DATA, uint8_t length );
+    PT7C4339_status write( uint8_t REG, const uint8_t *DATA, uint8_t length );
+    bool recover();
+
+    uint32_t getTimeout();
+    void setTimeout( uint32_t timeoutUs );
+
+    bool setMux( PT7C4339_Mux *mux, uint8_t channel );
+    PT7C4339_Mux *getMux();
+    uint8_t getMuxChannel();
+
+  private:
+    uint8_t _i2cAddress;
+    uint8_t _SDA;
+    uint8_t _SCL;
+    TwoWire *_i2cWire;
+    uint32_t _frequency;
+    uint32_t _timeoutUs;
+
+    PT7C4339_Mux *_mux;
+    uint8_t _muxChannel;
+
+    bool selectMuxChannel();
+    void invalidateMux();
+
+    void clearTimeoutFlag();
+    bool timedOut();
+    PT7C4339_status failureStatus( uint8_t error );
+};
+
+#endif